@@ -10,6 +10,7 @@
 #include <optional>  // for opti...
 #include <regex>     // for regex
 #include <utility>   // for move
+#include <vector>    // for vector
 
 #include "control/AudioController.h"                             // for Audi...
 #include "control/ClipboardHandler.h"                            // for Clip...
@@ -38,6 +39,7 @@
 #include "control/tools/EditSelection.h"                         // for Edit...
 #include "control/tools/TextEditor.h"                            // for Text...
 #include "control/xojfile/LoadHandler.h"                         // for Load...
+#include "control/xojfile/SaveCache.h"                           // for Save...
 #include "control/zoom/ZoomControl.h"                            // for Zoom...
 #include "gui/MainWindow.h"                                      // for Main...
 #include "gui/PageView.h"                                        // for XojP...
@@ -129,6 +131,7 @@ Control::Control(GApplication* gtkApp, GladeSearchpath* gladeSearchPath, bool di
     auto name = Util::getConfigFile(SETTINGS_XML_FILE);
     this->settings = new Settings(std::move(name));
     this->settings->load();
+    this->undoRedo->setMemoryBudget(static_cast<size_t>(this->settings->getUndoMemoryBudget()) * 1024U * 1024U);
 
     this->applyPreferredLanguage();
 
@@ -141,6 +144,7 @@ Control::Control(GApplication* gtkApp, GladeSearchpath* gladeSearchPath, bool di
     this->scrollHandler = new ScrollHandler(this);
 
     this->scheduler = new XournalScheduler();
+    this->saveCache = std::make_unique<SaveCache>();
 
     this->doc = new Document(this);
 
@@ -247,7 +251,7 @@ void Control::deleteLastAutosaveFile() {
 }
 
 auto Control::checkChangedDocument(Control* control) -> bool {
-    if (!control->doc->tryLock()) {
+    if (!control->doc->try_lock_shared()) {
         // call again later
         return true;
     }
@@ -260,7 +264,7 @@ auto Control::checkChangedDocument(Control* control) -> bool {
         }
     }
     control->changedPages.clear();
-    control->doc->unlock();
+    control->doc->unlock_shared();
 
     // Call again
     return true;
@@ -1481,6 +1485,8 @@ void Control::appendNewPdfPages() {
         string msg = FS(_F("No pdf pages available to append. You may need to reopen the document first."));
         XojMsgBox::showErrorToUser(getGtkWindow(), msg);
     }
+    std::vector<PageRef> newPages;
+    newPages.reserve(insertCount);
     for (size_t i = 0; i != insertCount; ++i) {
 
         doc->lock();
@@ -1490,12 +1496,28 @@ void Control::appendNewPdfPages() {
         if (pdf) {
             auto newPage = std::make_shared<XojPage>(pdf->getWidth(), pdf->getHeight());
             newPage->setBackgroundPdfPageNr(currentPdfPageCount + i);
-            insertPage(newPage, pageCount + i);
+            newPages.emplace_back(std::move(newPage));
         } else {
             string msg = FS(_F("Unable to retrieve pdf page."));  // should not happen
             XojMsgBox::showErrorToUser(getGtkWindow(), msg);
         }
     }
+    if (newPages.empty()) {
+        return;
+    }
+
+    // Insert the pages at once: the document only updates its page numbers once
+    this->doc->lock();
+    this->doc->insertPages(newPages.begin(), newPages.end(), pageCount);
+    this->doc->unlock();
+
+    for (size_t i = 0; i != newPages.size(); ++i) {
+        firePageInserted(pageCount + i);
+        undoRedo->addUndoAction(std::make_unique<InsertDeletePageUndoAction>(newPages[i], pageCount + i, true));
+    }
+
+    getCursor()->updateCursor();
+    updateDeletePageButton();
 }
 
 void Control::insertPage(const PageRef& page, size_t position, bool shouldScrollToPage) {
@@ -2298,6 +2320,9 @@ auto Control::openFile(fs::path filepath, int scrollToPage, bool forceOpen) -> b
     }
 
     LoadHandler loadHandler;
+    loadHandler.setLazyLoading(true, [this](const std::string& message) {
+        Util::execInUiThread([this, message]() { XojMsgBox::showErrorToUser(getGtkWindow(), message); });
+    });
     Document* loadedDocument = loadHandler.loadDocument(filepath);
 
     if (!loadedDocument) {
@@ -2625,7 +2650,7 @@ void Control::setCurrentState(int state) {
     Util::execInUiThread([=]() { gtk_progress_bar_set_fraction(this->pgState, gdouble(state) / this->maxState); });
 }
 
-auto Control::save(bool synchron) -> bool {
+auto Control::save(bool synchron, bool compact) -> bool {
     // clear selection before saving
     clearSelectionEndText();
 
@@ -2639,7 +2664,7 @@ auto Control::save(bool synchron) -> bool {
         }
     }
 
-    auto* job = new SaveJob(this);
+    auto* job = new SaveJob(this, compact);
     bool result = true;
     if (synchron) {
         result = job->save();
@@ -2778,7 +2803,8 @@ auto Control::saveAs() -> bool {
 
     // no lock needed, this is an uncritical operation
     this->doc->setCreateBackupOnSave(false);
-    return save();
+    // A new file is written in full, readable as a single stream
+    return save(false, true);
 }
 
 void Control::resetSavedStatus() {
@@ -3224,6 +3250,8 @@ void Control::runLatex() {
 
 auto Control::getUndoRedoHandler() const -> UndoRedoHandler* { return this->undoRedo; }
 
+auto Control::getSaveCache() const -> SaveCache* { return this->saveCache.get(); }
+
 auto Control::getZoomControl() const -> ZoomControl* { return this->zoom; }
 
 auto Control::getCursor() const -> XournalppCursor* { return this->cursor; }
@@ -54,6 +54,7 @@ class PageTypeMenu;
 class BaseExportJob;
 class LayerController;
 class PluginController;
+class SaveCache;
 class Document;
 class EditSelection;
 class Element;
@@ -100,8 +101,10 @@ public:
      * Save the current document.
      *
      * @param synchron Whether the save should be run synchronously or asynchronously.
+     * @param compact Whether the whole file should be rewritten as a single gzip stream, instead of only compressing
+     * the pages changed since the last save.
      */
-    bool save(bool synchron = false);
+    bool save(bool synchron = false, bool compact = false);
     bool saveAs();
 
     /**
@@ -253,6 +256,11 @@ public:
 
     XournalScheduler* getScheduler() const;
 
+    /**
+     * The pages compressed by the previous saves, shared by the saves and the autosaves
+     */
+    SaveCache* getSaveCache() const;
+
     void block(const std::string& name);
     void unblock();
 
@@ -469,6 +477,8 @@ private:
 
     LayerController* layerController;
 
+    std::unique_ptr<SaveCache> saveCache;
+
     std::unique_ptr<GeometryTool> geometryTool;
     std::unique_ptr<GeometryToolController> geometryToolController;
 
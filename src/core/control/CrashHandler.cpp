@@ -33,7 +33,8 @@ void emergencySave() {
     auto const& filepath = Util::getConfigFile("emergencysave.xopp");
 
     SaveHandler handler;
-    handler.prepareSave(document);
+    // The crashed thread may hold the document lock
+    handler.prepareSave(document, false);
     handler.saveTo(filepath);
 
     if (!handler.getErrorMessage().empty()) {
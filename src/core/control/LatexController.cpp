@@ -13,6 +13,7 @@
 #include "control/Tool.h"                    // for Tool
 #include "control/ToolEnums.h"               // for TOOL_TEXT
 #include "control/ToolHandler.h"             // for ToolHandler
+#include "control/latex/LatexCache.h"        // for LatexCache
 #include "control/latex/LatexGenerator.h"    // for LatexGenerator::GenError
 #include "control/settings/LatexSettings.h"  // for LatexSettings
 #include "control/settings/Settings.h"       // for Settings
@@ -185,6 +186,22 @@ void LatexController::triggerImageUpdate(const string& texString) {
 
     this->lastPreviewedTex = texString;
     const std::string texContents = LatexGenerator::templateSub(texString, this->latexTemplate, textColor);
+
+    this->lastPreviewedKey = LatexCache::computeKey(this->settings.genCmd, texContents);
+    if (auto cached = LatexCache::getShared().get(this->lastPreviewedKey)) {
+        // This formula has already been compiled: no need to run the LaTeX command again
+        this->texProcessOutput = std::move(cached->output);
+        this->isValidTex = true;
+        this->temporaryRender = this->loadRendered(texString, std::move(cached->pdf));
+        if (this->temporaryRender != nullptr) {
+            this->dlg.setTempRender(this->temporaryRender->getPdf());
+        } else {
+            this->isValidTex = false;
+        }
+        updateStatus();
+        return;
+    }
+
     auto result = generator.asyncRun(this->texTmpDir, texContents);
     if (auto* err = std::get_if<LatexGenerator::GenError>(&result)) {
         XojMsgBox::showErrorToUser(this->control->getGtkWindow(), err->message);
@@ -265,9 +282,18 @@ void LatexController::onPdfRenderComplete(GObject* procObj, GAsyncResult* res, L
     const string currentTex = self->dlg.getBufferContents();
     bool shouldUpdate = self->lastPreviewedTex != currentTex;
     if (self->isValidTex) {
-        self->temporaryRender = self->loadRendered(currentTex);
+        fs::path pdfPath = self->texTmpDir / "tex.pdf";
+        if (auto contents = Util::readString(pdfPath, true, std::ios::binary)) {
+            LatexCache::getShared().put(self->lastPreviewedKey, {*contents, self->texProcessOutput});
+            self->temporaryRender = self->loadRendered(currentTex, std::move(*contents));
+        } else {
+            // Do not keep the render of the previous formula
+            self->temporaryRender.reset();
+        }
         if (self->temporaryRender != nullptr) {
             self->dlg.setTempRender(self->temporaryRender->getPdf());
+        } else {
+            self->isValidTex = false;
         }
     }
 
@@ -316,20 +342,14 @@ void LatexController::deleteOldImage() {
     }
 }
 
-auto LatexController::loadRendered(string renderedTex) -> std::unique_ptr<TexImage> {
+auto LatexController::loadRendered(string renderedTex, string pdf) -> std::unique_ptr<TexImage> {
     if (!this->isValidTex) {
         return nullptr;
     }
 
-    fs::path pdfPath = texTmpDir / "tex.pdf";
-    auto contents = Util::readString(pdfPath, true, std::ios::binary);
-    if (!contents) {
-        return nullptr;
-    }
-
     auto img = std::make_unique<TexImage>();
     GError* err{};
-    bool loaded = img->loadData(std::move(*contents), &err);
+    bool loaded = img->loadData(std::move(pdf), &err);
 
     if (err != nullptr) {
         string message = FS(_F("Could not load LaTeX PDF file: {1}") % err->message);
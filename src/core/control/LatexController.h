@@ -109,9 +109,9 @@ private:
     bool isUpdating();
 
     /**
-     * Load the preview PDF from disk and create a TexImage object.
+     * Create a TexImage object from the generated PDF.
      */
-    std::unique_ptr<TexImage> loadRendered(std::string renderedTex);
+    std::unique_ptr<TexImage> loadRendered(std::string renderedTex, std::string pdf);
 
     /**
      * Insert the generated preview TexImage into the current page.
@@ -148,6 +148,11 @@ private:
      */
     std::string lastPreviewedTex;
 
+    /**
+     * The key in the LatexCache of the last TeX file compiled.
+     */
+    std::string lastPreviewedKey;
+
     /**
      * Whether a preview is currently being generated.
      */
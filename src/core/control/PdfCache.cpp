@@ -1,116 +1,368 @@
 #include "PdfCache.h"
 
-#include <algorithm>  // for max
-#include <cmath>      // for ceil, abs
-#include <cstdio>     // for size_t
-#include <memory>     // for shared_ptr, __shared_ptr_access
-#include <string>     // for string
-#include <utility>    // for move
+#include <algorithm>   // for max, min
+#include <cmath>       // for ceil, exp, floor, log, log1p
+#include <cstdio>      // for size_t
+#include <functional>  // for hash
+#include <memory>      // for shared_ptr, __shared_ptr_access
+#include <string>      // for string
+#include <utility>     // for move
 
 #include <glib.h>  // for g_warning
 
 #include "control/settings/Settings.h"  // for Settings
 #include "pdf/base/XojPdfDocument.h"    // for XojPdfDocument
+#include "pdf/base/XojPdfPage.h"        // for XojPdfRectangle
 #include "util/Range.h"                 // for Range
 #include "util/i18n.h"                  // for _
+#include "util/raii/CairoWrappers.h"    // for CairoSaveGuard
 #include "view/Mask.h"                  // for Mask
 
+namespace {
+/**
+ * The smallest zoom difference (in percent) for which pages are rendered again
+ */
+constexpr double MIN_REFRESH_THRESHOLD = 0.1;
+
+/**
+ * Pages which would be rasterized to larger surfaces (in pixels) are split into square regions of REGION_SIZE pixels,
+ * so that zooming in on a large page does not require a huge surface.
+ */
+constexpr double MAX_WHOLE_PAGE_PIXELS = 2048.0 * 2048.0;
+constexpr double REGION_SIZE = 1024.0;
+
+/**
+ * Pixels rasterized around each region, so that neighbouring regions join seamlessly when painted with another zoom
+ */
+constexpr double REGION_PADDING = 2.0;
+
+/**
+ * @return The memory used by the image surface of the mask, in bytes
+ */
+auto getByteSize(xoj::view::Mask& mask) -> size_t {
+    cairo_surface_t* surface = cairo_get_target(mask.get());
+    return static_cast<size_t>(cairo_image_surface_get_stride(surface)) *
+           static_cast<size_t>(cairo_image_surface_get_height(surface));
+}
+}  // namespace
+
 class PdfCacheEntry {
 public:
     /**
-     *   Cache [img], the result of rendering [popplerPage] with
+     *   Cache [buffer], the result of rendering a PDF page with
      * the given [zoom].
      *  A change in the document's zoom causes a change in the
      * quality of the PDF backgrounds (zoomed in => need a higher
      * quality rendering).
      *
-     * @param popplerPage
-     * @param buffer is the result of rendering popplerPage
+     * @param key The PDF page number, zoom bucket and region
+     * @param extent The part of the page the entry covers, in page coordinates
+     * @param buffer is the result of rendering the page. It is not initialized if the region is out of the PDF page.
      */
-    PdfCacheEntry(XojPdfPageSPtr popplerPage, xoj::view::Mask&& buffer):
-            popplerPage(std::move(popplerPage)), buffer(std::forward<xoj::view::Mask>(buffer)) {}
+    PdfCacheEntry(PdfCache::Key key, const Range& extent, xoj::view::Mask&& buffer):
+            key(key), extent(extent), buffer(std::forward<xoj::view::Mask>(buffer)) {
+        this->bytes = this->buffer.isInitialized() ? getByteSize(this->buffer) : 0;
+    }
 
     ~PdfCacheEntry() = default;
 
-    XojPdfPageSPtr popplerPage;
+    void paintTo(cairo_t* cr) const {
+        if (!this->buffer.isInitialized()) {
+            return;
+        }
+        if (this->key.isWholePage()) {
+            this->buffer.paintTo(cr);
+            return;
+        }
+
+        // Leave out the padding, which may be less accurate than the neighbouring regions
+        xoj::util::CairoSaveGuard guard(cr);
+        cairo_rectangle(cr, extent.minX, extent.minY, extent.getWidth(), extent.getHeight());
+        cairo_clip(cr);
+        this->buffer.paintTo(cr);
+    }
+
+    PdfCache::Key key;
+    Range extent;
     xoj::view::Mask buffer;
+    size_t bytes = 0;
 };
 
 PdfCache::PdfCache(const XojPdfDocument& doc, Settings* settings): pdfDocument(doc) { updateSettings(settings); }
 
 PdfCache::~PdfCache() = default;
 
-void PdfCache::setRefreshThreshold(double threshold) { this->zoomRefreshThreshold = threshold; }
+auto PdfCache::Key::operator==(const Key& other) const -> bool {
+    return pdfPageNo == other.pdfPageNo && zoomBucket == other.zoomBucket && regionX == other.regionX &&
+           regionY == other.regionY;
+}
+
+auto PdfCache::KeyHash::operator()(const Key& key) const -> size_t {
+    size_t h = std::hash<size_t>()(key.pdfPageNo);
+    for (int v: {key.zoomBucket, key.regionX, key.regionY}) { h = h * 31 + std::hash<int>()(v); }
+    return h;
+}
 
-void PdfCache::setMaxSize(size_t newSize) {
-    this->maxSize = newSize;
-    if (this->data.size() > this->maxSize) {
-        this->data.resize(this->maxSize);
+void PdfCache::setRefreshThreshold(double threshold) {
+    std::lock_guard<std::mutex> lock(this->renderMutex);
+    if (this->zoomRefreshThreshold == threshold) {
+        return;
     }
+    this->zoomRefreshThreshold = threshold;
+
+    // The zoom buckets changed. The entries being painted are kept alive by their shared_ptr.
+    this->data.clear();
+    this->index.clear();
+    this->memoryUsed = 0;
+}
+
+void PdfCache::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(this->renderMutex);
+    this->memoryBudget = bytes;
+    evict();
+}
+
+void PdfCache::setPageReadyCallback(std::function<void(size_t pdfPageNo)> callback) {
+    std::lock_guard<std::mutex> lock(this->renderMutex);
+    this->pageReadyCallback = std::move(callback);
 }
 
 void PdfCache::updateSettings(Settings* settings) {
     if (settings) {
-        setMaxSize(settings->getPdfPageCacheSize());
+        setMemoryBudget(static_cast<size_t>(settings->getPdfPageCacheMemoryBudget()) * 1024U * 1024U);
         setRefreshThreshold(settings->getPDFPageRerenderThreshold());
     }
 }
 
-auto PdfCache::lookup(size_t pdfPageNo) const -> const PdfCacheEntry* {
-    for (auto& e: this->data) {
-        if (static_cast<size_t>(e->popplerPage->getPageId()) == pdfPageNo) {
-            return e.get();
+auto PdfCache::getStatistics() const -> Statistics {
+    std::lock_guard<std::mutex> lock(this->renderMutex);
+    Statistics stats = this->statistics;
+    stats.entries = this->data.size();
+    stats.bytes = this->memoryUsed;
+    return stats;
+}
+
+auto PdfCache::getZoomBucket(double zoom) const -> int {
+    const double step = std::log1p(std::max(this->zoomRefreshThreshold, MIN_REFRESH_THRESHOLD) / 100.0);
+    return static_cast<int>(std::floor(std::log(zoom) / step));
+}
+
+auto PdfCache::getBucketZoom(int zoomBucket) const -> double {
+    const double step = std::log1p(std::max(this->zoomRefreshThreshold, MIN_REFRESH_THRESHOLD) / 100.0);
+    return std::exp(zoomBucket * step);
+}
+
+auto PdfCache::getRegions(size_t pdfPageNo, double zoom, double pageWidth, double pageHeight, const Range& area) const
+        -> std::vector<Region> {
+    // Below 100%, the page is rendered at 100% anyway
+    const double renderZoom = std::max(zoom, 1.0);
+    const Range pageExtent(0, 0, pageWidth, pageHeight);
+
+    std::lock_guard<std::mutex> lock(this->renderMutex);
+    const int bucket = getZoomBucket(renderZoom);
+    // The layout of the regions only depends on the bucket, so that all the zooms of a bucket share the entries
+    const double bucketZoom = getBucketZoom(bucket);
+
+    if (pageWidth * pageHeight * bucketZoom * bucketZoom <= MAX_WHOLE_PAGE_PIXELS) {
+        return {Region{Key{pdfPageNo, bucket, -1, -1}, pageExtent, renderZoom}};
+    }
+
+    const Range visible = area.intersect(pageExtent);
+    if (visible.getWidth() <= 0 || visible.getHeight() <= 0) {
+        return {};
+    }
+
+    const double regionSize = REGION_SIZE / bucketZoom;
+    const int minX = static_cast<int>(std::floor(visible.minX / regionSize));
+    const int minY = static_cast<int>(std::floor(visible.minY / regionSize));
+    const int maxX = std::max(minX + 1, static_cast<int>(std::ceil(visible.maxX / regionSize)));
+    const int maxY = std::max(minY + 1, static_cast<int>(std::ceil(visible.maxY / regionSize)));
+
+    std::vector<Region> regions;
+    regions.reserve(static_cast<size_t>((maxX - minX) * (maxY - minY)));
+    for (int y = minY; y < maxY; y++) {
+        for (int x = minX; x < maxX; x++) {
+            Range extent(x * regionSize, y * regionSize, std::min((x + 1) * regionSize, pageWidth),
+                         std::min((y + 1) * regionSize, pageHeight));
+            regions.push_back({Key{pdfPageNo, bucket, x, y}, extent, renderZoom});
+        }
+    }
+    return regions;
+}
+
+auto PdfCache::lookup(const Key& key) -> EntryPtr {
+    auto it = this->index.find(key);
+    if (it == this->index.end()) {
+        return nullptr;
+    }
+
+    // Move the entry to the front
+    this->data.splice(this->data.begin(), this->data, it->second);
+    return this->data.front();
+}
+
+auto PdfCache::lookupAnyZoom(const Region& region) const -> EntryPtr {
+    auto covers = [&extent = region.extent](const Range& r) {
+        return r.minX <= extent.minX && r.minY <= extent.minY && r.maxX >= extent.maxX && r.maxY >= extent.maxY;
+    };
+
+    EntryPtr best;
+    for (const EntryPtr& e: this->data) {
+        if (e->key.pdfPageNo == region.key.pdfPageNo && covers(e->extent) &&
+            (!best || e->key.zoomBucket > best->key.zoomBucket)) {
+            best = e;
         }
     }
+    return best;
+}
+
+void PdfCache::cache(EntryPtr entry) {
+    if (auto it = this->index.find(entry->key); it != this->index.end()) {
+        // Rendered again after a change of the refresh threshold
+        this->memoryUsed -= (*it->second)->bytes;
+        this->data.erase(it->second);
+        this->index.erase(it);
+    }
+
+    this->memoryUsed += entry->bytes;
+    this->data.emplace_front(std::move(entry));
+    this->index[this->data.front()->key] = this->data.begin();
 
-    return nullptr;
+    evict();
 }
 
-auto PdfCache::cache(XojPdfPageSPtr popplerPage, xoj::view::Mask&& buffer) -> const PdfCacheEntry* {
-    if (this->data.size() > this->maxSize) {
-        this->data.resize(this->maxSize);
+void PdfCache::evict() {
+    // Always keep the most recently used entry, even if it is larger than the budget
+    while (this->memoryUsed > this->memoryBudget && this->data.size() > 1) {
+        const EntryPtr& last = this->data.back();
+        this->memoryUsed -= last->bytes;
+        this->index.erase(last->key);
+        this->data.pop_back();
+        this->statistics.evictions++;
     }
+}
 
-    this->data.emplace_front(
-            std::make_unique<PdfCacheEntry>(std::move(popplerPage), std::forward<xoj::view::Mask>(buffer)));
+auto PdfCache::acquireDocument() -> std::unique_ptr<XojPdfDocument> {
+    {
+        std::lock_guard<std::mutex> lock(this->renderMutex);
+        if (!this->idleDocuments.empty()) {
+            auto doc = std::move(this->idleDocuments.back());
+            this->idleDocuments.pop_back();
+            return doc;
+        }
+    }
 
-    return this->data.front().get();
+    auto doc = std::make_unique<XojPdfDocument>();
+    GError* error = nullptr;
+    if (!doc->loadIndependentCopy(this->pdfDocument, &error)) {
+        g_warning("PdfCache: could not open the PDF document again: %s", error ? error->message : "");
+        if (error) {
+            g_error_free(error);
+        }
+        return nullptr;
+    }
+    return doc;
 }
 
-void PdfCache::render(cairo_t* cr, size_t pdfPageNo, double zoom, double pageWidth, double pageHeight) {
+void PdfCache::releaseDocument(std::unique_ptr<XojPdfDocument> doc) {
     std::lock_guard<std::mutex> lock(this->renderMutex);
+    this->idleDocuments.emplace_back(std::move(doc));
+}
 
-    const PdfCacheEntry* cacheResult = lookup(pdfPageNo);
+auto PdfCache::getEntry(const Region& region, bool allowFallback) -> EntryPtr {
+    const Key& key = region.key;
 
-    bool needsRefresh = cacheResult == nullptr;
+    std::unique_lock<std::mutex> lock(this->renderMutex);
 
-    if (!needsRefresh) {
-        double averagedZoom = (zoom + cacheResult->buffer.getZoom()) / 2.0;
-        double percentZoomChange = std::abs(cacheResult->buffer.getZoom() - zoom) * 100.0 / averagedZoom;
+    while (true) {
+        if (EntryPtr entry = lookup(key)) {
+            this->statistics.hits++;
+            return entry;
+        }
+
+        auto it = this->rendering.find(key);
+        if (it == this->rendering.end()) {
+            break;
+        }
 
-        // If we do have a cached result, is its rendering quality
-        // acceptable for our current zoom?
-        needsRefresh = (zoom > 1.0 && percentZoomChange > this->zoomRefreshThreshold);
+        // Another thread is rendering this region
+        if (allowFallback && this->pageReadyCallback) {
+            if (EntryPtr fallback = lookupAnyZoom(region)) {
+                it->second = true;
+                return fallback;
+            }
+        }
+        this->pageRendered.wait(lock);
     }
 
-    if (needsRefresh) {
-        double renderZoom = std::max(zoom, 1.0);
+    this->statistics.misses++;
+    this->rendering.emplace(key, false);
+    lock.unlock();
+
+    // Rasterize the region without holding the lock, on a document used by no other thread
+    EntryPtr entry;
+    if (auto doc = acquireDocument()) {
+        if (auto popplerPage = doc->getPage(key.pdfPageNo)) {
+            const Range pdfPageExtent(0, 0, popplerPage->getWidth(), popplerPage->getHeight());
+            const Range extent = key.isWholePage() ? pdfPageExtent : region.extent;
 
-        auto popplerPage = cacheResult ? cacheResult->popplerPage : pdfDocument.getPage(pdfPageNo);
+            Range rendered = extent;
+            if (!key.isWholePage()) {
+                rendered.addPadding(REGION_PADDING / region.zoom);
+                rendered = rendered.intersect(pdfPageExtent);
+            }
+
+            xoj::view::Mask buffer;
+            if (rendered.getWidth() > 0 && rendered.getHeight() > 0) {
+                buffer = xoj::view::Mask(1, rendered, region.zoom, CAIRO_CONTENT_COLOR_ALPHA);
+                if (key.isWholePage()) {
+                    popplerPage->render(buffer.get());
+                } else {
+                    XojPdfRectangle clip(rendered.minX, rendered.minY, rendered.maxX, rendered.maxY);
+                    popplerPage->renderRegion(buffer.get(), clip);
+                }
+            }
+            entry = std::make_shared<PdfCacheEntry>(key, extent, std::move(buffer));
+        }
+        releaseDocument(std::move(doc));
+    }
+
+    lock.lock();
+    bool fallbackPainted = this->rendering[key];
+    this->rendering.erase(key);
+    if (entry) {
+        cache(entry);
+    }
+    auto callback = fallbackPainted && entry ? this->pageReadyCallback : nullptr;
+    lock.unlock();
+    this->pageRendered.notify_all();
 
-        if (!popplerPage) {
+    if (callback) {
+        callback(key.pdfPageNo);
+    }
+    return entry;
+}
+
+void PdfCache::prerender(size_t pdfPageNo, double zoom, double pageWidth, double pageHeight, const Range& area) {
+    for (auto&& region: getRegions(pdfPageNo, zoom, pageWidth, pageHeight, area)) { getEntry(region, false); }
+}
+
+void PdfCache::render(cairo_t* cr, size_t pdfPageNo, double zoom, double pageWidth, double pageHeight) {
+    double x1 = 0;
+    double y1 = 0;
+    double x2 = 0;
+    double y2 = 0;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+
+    for (auto&& region: getRegions(pdfPageNo, zoom, pageWidth, pageHeight, Range(x1, y1, x2, y2))) {
+        EntryPtr entry = getEntry(region, true);
+        if (!entry) {
             g_warning("PdfCache::render Could not get the pdf page %zu from the document", pdfPageNo);
             renderMissingPdfPage(cr, pageWidth, pageHeight);
             return;
         }
-
-        xoj::view::Mask buffer(cairo_get_target(cr), Range(0, 0, popplerPage->getWidth(), popplerPage->getHeight()),
-                               renderZoom, CAIRO_CONTENT_COLOR_ALPHA);
-        popplerPage->render(buffer.get());
-        cacheResult = cache(popplerPage, std::move(buffer));
+        entry->paintTo(cr);
     }
-
-    cacheResult->buffer.paintTo(cr);
 }
 
 void PdfCache::renderMissingPdfPage(cairo_t* cr, double pageWidth, double pageHeight) {
@@ -11,14 +11,19 @@
 
 #pragma once
 
-#include <cstddef>  // for size_t
-#include <deque>    // for deque
-#include <mutex>    // for mutex
+#include <condition_variable>  // for condition_variable
+#include <cstddef>             // for size_t
+#include <functional>          // for function
+#include <list>                // for list
+#include <memory>              // for shared_ptr, unique_ptr
+#include <mutex>               // for mutex
+#include <unordered_map>       // for unordered_map
+#include <vector>              // for vector
 
 #include <cairo.h>  // for cairo_t, cairo_surface_t
 
 #include "pdf/base/XojPdfDocument.h"  // for XojPdfDocument
-#include "pdf/base/XojPdfPage.h"      // for XojPdfPageSPtr
+#include "util/Range.h"               // for Range
 
 namespace xoj::view {
 class Mask;
@@ -39,6 +44,10 @@ private:
 public:
     /**
      * @brief Render the page with number pdfPageNo of the pdf document to the cairo context
+     *
+     * At high zoom levels, the page is split into regions which are rasterized and cached separately: only the regions
+     * within the clip of the cairo context are then rasterized.
+     *
      * @param cr the cairo context
      * @param pdfPageNo The page number (in the pdf document)
      * @param zoom The current zoom level
@@ -46,6 +55,23 @@ public:
      */
     void render(cairo_t* cr, size_t pdfPageNo, double zoom, double pageWidth, double pageHeight);
 
+    /**
+     * @brief Render the part of the page with number pdfPageNo in the given area in the cache, if it is not already
+     *          there, so that render() does not need to rasterize it. Several pages can be rendered at once by
+     *          different threads.
+     * @param zoom The number of device pixels per page unit with which the page will be painted
+     * @param pageWidth/pageHeight Xournal++ page dimensions
+     * @param area The part of the page which will be painted, in page coordinates
+     */
+    void prerender(size_t pdfPageNo, double zoom, double pageWidth, double pageHeight, const Range& area);
+
+    /**
+     * @brief If set, render() paints a lower resolution version of a page which another thread is currently
+     *          rendering, instead of waiting for it. The callback is then called (from the rendering thread) when the
+     *          page is ready, so that it can be painted again.
+     */
+    void setPageReadyCallback(std::function<void(size_t pdfPageNo)> callback);
+
 public:
     /**
      * @brief Set the maximum tolerable zoom difference, as a percentage.
@@ -56,32 +82,131 @@ public:
      */
     void setRefreshThreshold(double percentDifference);
 
-    void setMaxSize(size_t newSize);
+    /**
+     * @brief Set the memory the cached pages may use, in bytes. The least recently used pages are evicted first.
+     */
+    void setMemoryBudget(size_t bytes);
 
     void updateSettings(Settings* settings);
 
+    struct Statistics {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    /**
+     * @brief The counters of the cache since its creation, and its current content
+     */
+    Statistics getStatistics() const;
+
     /**
      * @brief Renders an error background, for when the pdf page cannot be rendered
      */
     static void renderMissingPdfPage(cairo_t* cr, double pageWidth, double pageHeight);
 
 private:
+    friend class PdfCacheEntry;
+
+    /**
+     * The cache entries are keyed by PDF page number, zoom bucket and region. The zooms of a bucket differ by less
+     * than the refresh threshold.
+     */
+    struct Key {
+        size_t pdfPageNo;
+        int zoomBucket;
+        /// Position of the region in the grid of regions of the page, or -1 if the page is rendered as a whole
+        int regionX;
+        int regionY;
+
+        bool isWholePage() const { return regionX < 0; }
+        bool operator==(const Key& other) const;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    int getZoomBucket(double zoom) const;
+    double getBucketZoom(int zoomBucket) const;
+
+    /**
+     * A part of a page which is rendered into its own cache entry
+     */
+    struct Region {
+        Key key;
+        Range extent;  ///< In page coordinates
+        double zoom;   ///< The zoom at which the region is rasterized
+    };
+
     /**
-     * @brief Look up for a cache entry for the page with number pdfPgeNo in the PDF.
+     * @brief Get the regions of the page needed to paint the given area of it
      */
-    const PdfCacheEntry* lookup(size_t pdfPageNo) const;
+    std::vector<Region> getRegions(size_t pdfPageNo, double zoom, double pageWidth, double pageHeight,
+                                   const Range& area) const;
+
+    using EntryPtr = std::shared_ptr<const PdfCacheEntry>;
+
     /**
-     * @brief Push a cache entry
+     * @brief Get the cache entry for the region, rendering it if needed
+     * @param allowFallback Return a lower resolution entry instead of waiting for another thread rendering the region
+     * @return The entry, or nullptr if the page could not be rendered
      */
-    const PdfCacheEntry* cache(XojPdfPageSPtr popplerPage, xoj::view::Mask&& buffer);
+    EntryPtr getEntry(const Region& region, bool allowFallback);
+
+    /**
+     * @brief Look up for a cache entry and mark it as the most recently used one
+     */
+    EntryPtr lookup(const Key& key);
+    /**
+     * @brief Look up for the entry with the highest resolution covering the region, whichever its zoom
+     */
+    EntryPtr lookupAnyZoom(const Region& region) const;
+    /**
+     * @brief Push a cache entry and evict the least recently used ones beyond the memory budget
+     */
+    void cache(EntryPtr entry);
+    void evict();
+
+    /**
+     * @brief Take a PDF document which is not used by another thread
+     */
+    std::unique_ptr<XojPdfDocument> acquireDocument();
+    void releaseDocument(std::unique_ptr<XojPdfDocument> doc);
 
 private:
     XojPdfDocument pdfDocument;
 
-    std::mutex renderMutex;
+    /**
+     * Independent copies of pdfDocument which are not currently used for rendering. A PDF document cannot be used by
+     * several threads at once, so each rendering thread takes its own copy.
+     */
+    std::vector<std::unique_ptr<XojPdfDocument>> idleDocuments;
+
+    /**
+     * Guards the entries, the counters and idleDocuments. It is not held while rasterizing.
+     */
+    mutable std::mutex renderMutex;
+    std::condition_variable pageRendered;
+
+    /**
+     * The entries, from the most recently used to the least recently used one
+     */
+    std::list<EntryPtr> data;
+    std::unordered_map<Key, std::list<EntryPtr>::iterator, KeyHash> index;
+
+    /**
+     * The entries being rendered, and whether a lower resolution version has been painted meanwhile
+     */
+    std::unordered_map<Key, bool, KeyHash> rendering;
+
+    std::function<void(size_t pdfPageNo)> pageReadyCallback;
+
+    size_t memoryBudget = 0;
+    size_t memoryUsed = 0;
 
-    std::deque<std::unique_ptr<PdfCacheEntry>> data;
-    decltype(data)::size_type maxSize = 0;
+    Statistics statistics;
 
-    double zoomRefreshThreshold;
+    double zoomRefreshThreshold = 0.0;
 };
@@ -505,7 +505,7 @@ void on_startup(GApplication* application, XMPtr app_data) {
         }
     }
 
-    app_data->control->getScheduler()->start();
+    app_data->control->getScheduler()->start(app_data->control->getSettings()->getRenderWorkerCount());
 
     if (!opened) {
         app_data->control->newFile();
@@ -25,6 +25,7 @@ void AutosaveJob::afterRun() {
 
 void AutosaveJob::run() {
     SaveHandler handler;
+    handler.setCache(control->getSaveCache());
 
     control->getUndoRedoHandler()->documentAutosaved();
 
@@ -47,6 +48,7 @@ void AutosaveJob::run() {
 
     fs::path tempfile = filepath;
     tempfile += u8"~";
+    // Without lock: the handler only locks the document (shared) while it reads the pages, not while writing the file
     handler.saveTo(tempfile);
 
     this->error = handler.getErrorMessage();
@@ -118,9 +118,10 @@ void CustomExportJob::run() {
         XojExportHandler h;
         doc->lock();
         h.prepareSave(doc);
-        h.saveTo(filepath, this->control);
         doc->unlock();
 
+        h.saveTo(filepath, this->control);
+
         if (!h.getErrorMessage().empty()) {
             this->lastError = FS(_F("Save file error: {1}") % h.getErrorMessage());
 
@@ -157,9 +157,9 @@ auto ImageExport::getFilenameWithNumber(size_t no) const -> fs::path {
  */
 void ImageExport::exportImagePage(size_t pageId, size_t id, double zoomRatio, ExportGraphicsFormat format,
                                   DocumentView& view) {
-    doc->lock();
+    doc->lock_shared();
     PageRef page = doc->getPage(pageId);
-    doc->unlock();
+    doc->unlock_shared();
 
     zoomRatio = createSurface(page->getWidth(), page->getHeight(), id, zoomRatio);
 
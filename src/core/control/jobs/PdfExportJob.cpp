@@ -34,9 +34,9 @@ auto PdfExportJob::testAndSetFilepath(const fs::path& file) -> bool {
 void PdfExportJob::run() {
     Document* doc = control->getDocument();
 
-    doc->lock();
+    doc->lock_shared();
     std::unique_ptr<XojPdfExport> pdfe = XojPdfExportFactory::createExport(doc, control);
-    doc->unlock();
+    doc->unlock_shared();
 
     if (!pdfe->createPdf(this->filepath, false)) {
         this->errorMsg = pdfe->getLastError();
@@ -53,6 +53,7 @@ void PreviewJob::finishPaint() {
         cairo_surface_destroy(this->sidebarPreview->crBuffer);
     }
     this->sidebarPreview->crBuffer = crBuffer;
+    this->sidebarPreview->bufferZoom = zoom;
 
     // The preview widget can be referenced after this is deleted.
     // Only it should be referenced in the callback.
@@ -75,7 +76,7 @@ void PreviewJob::drawPage() {
     PreviewRenderType type = this->sidebarPreview->getRenderType();
     Layer::Index layer = 0;
 
-    doc->lock();
+    doc->lock_shared();
 
     // getLayer is not defined for page preview
     if (type != RENDER_TYPE_PAGE_PREVIEW) {
@@ -121,7 +122,7 @@ void PreviewJob::drawPage() {
     }
 
     cairo_destroy(cr2);
-    doc->unlock();
+    doc->unlock_shared();
 }
 
 void PreviewJob::clipToPage() {
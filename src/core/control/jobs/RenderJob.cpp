@@ -1,40 +1,61 @@
 #include "RenderJob.h"
 
-#include <cmath>    // for ceil, floor
-#include <mutex>    // for mutex
-#include <utility>  // for move
-#include <vector>   // for vector
+#include <algorithm>     // for min
+#include <cmath>         // for ceil, floor
+#include <mutex>         // for mutex
+#include <shared_mutex>  // for shared_lock
+#include <utility>       // for move, pair
+#include <vector>        // for vector
 
 #include <cairo.h>  // for cairo_create, cairo_destroy, cairo_...
 
 #include "control/Control.h"            // for Control
+#include "control/PdfCache.h"           // for PdfCache
 #include "control/ToolEnums.h"          // for TOOL_PLAY_OBJECT
 #include "control/ToolHandler.h"        // for ToolHandler
 #include "control/jobs/Job.h"           // for JOB_TYPE_RENDER, JobType
+#include "control/settings/Settings.h"  // for Settings
 #include "gui/PageView.h"               // for XojPageView
 #include "gui/XournalView.h"            // for XournalView
 #include "gui/widgets/XournalWidget.h"  // for gtk_xournal_repaint_area
 #include "model/Document.h"             // for Document
+#include "model/PageType.h"             // for PageType
 #include "model/XojPage.h"              // for Page
+#include "util/Range.h"                 // for Range
 #include "util/Rectangle.h"             // for Rectangle
 #include "util/Util.h"                  // for execInUiThread
 #include "util/raii/CairoWrappers.h"    // for CairoSurfaceSPtr, CairoSPtr
 #include "view/DocumentView.h"          // for DocumentView
 #include "view/Mask.h"                  // for Mask
-
-#if defined(__has_cpp_attribute) && __has_cpp_attribute(likely)
-#define XOJ_CPP20_UNLIKELY [[unlikely]]
-#else
-#define XOJ_CPP20_UNLIKELY
-#endif
+#include "view/TiledBuffer.h"           // for TiledBuffer
 
 using xoj::util::Rectangle;
+using xoj::view::TiledBuffer;
+
+/**
+ * Pages which are not visible (e.g. preloaded pages) are rendered from the top, up to this number of device pixels.
+ */
+constexpr double MAX_PRELOAD_PIXELS = 16.0 * TiledBuffer::TILE_SIZE * TiledBuffer::TILE_SIZE;
 
 RenderJob::RenderJob(XojPageView* view): view(view) {}
 
 auto RenderJob::getSource() -> void* { return this->view; }
 
-void RenderJob::rerenderRectangle(Rectangle<double> const& rect) {
+auto RenderJob::getAreaToRender(Range visibleArea, double zoom) const -> Range {
+    const double width = view->page->getWidth();
+    const double height = view->page->getHeight();
+
+    if (visibleArea.empty()) {
+        double maxHeight = MAX_PRELOAD_PIXELS / (width * zoom * zoom);
+        return Range(0, 0, width, std::min(height, maxHeight));
+    }
+
+    // Prefetch one tile in every direction, so that scrolling does not immediately show missing tiles
+    visibleArea.addPadding(TiledBuffer::TILE_SIZE / zoom);
+    return visibleArea.intersect(Range(0, 0, width, height));
+}
+
+auto RenderJob::rerenderRectangle(Rectangle<double> const& rect) -> Range {
     /**
      * Padding seems to be necessary to prevent artefacts of most strokes.
      * These artefacts are most pronounced when using the stroke deletion
@@ -45,18 +66,20 @@ void RenderJob::rerenderRectangle(Rectangle<double> const& rect) {
 
     Range maskRange(rect);
     maskRange.addPadding(RENDER_PADDING);
+
+    // Only the tiles which are currently allocated need updating: the other ones will be rendered from scratch
+    maskRange = maskRange.intersect(view->buffer.getAllocatedExtent());
+    if (maskRange.empty()) {
+        return maskRange;
+    }
+
     xoj::view::Mask newMask(view->xournal->getDpiScaleFactor(), maskRange, view->xournal->getZoom(),
                             CAIRO_CONTENT_COLOR_ALPHA);
 
     renderToBuffer(newMask.get());
 
-    std::lock_guard lock(this->view->drawingMutex);
-    if (!view->buffer.isInitialized()) {
-        // Todo: the buffer must not be uninitializable here, either by moving it into the job or by locking it at job
-        // creation a shared prt may also be suffice.
-        XOJ_CPP20_UNLIKELY return;
-    }
-    newMask.paintTo(view->buffer.get());
+    view->buffer.paintOnTiles(newMask, maskRange);
+    return maskRange;
 }
 
 void RenderJob::run() {
@@ -65,19 +88,32 @@ void RenderJob::run() {
     bool rerenderComplete = std::exchange(this->view->rerenderComplete, false);
     bool sizeChanged = std::exchange(this->view->sizeChanged, false);
     auto rerenderRects = std::move(this->view->rerenderRects);
+    Range visibleArea = this->view->visibleArea;
+    this->view->rendering = true;
 
     this->view->repaintRectMutex.unlock();
 
-    if (rerenderComplete) {
-        xoj::view::Mask newMask(view->xournal->getDpiScaleFactor(),
-                                Range(0, 0, view->page->getWidth(), view->page->getHeight()), view->xournal->getZoom(),
-                                CAIRO_CONTENT_COLOR_ALPHA);
+    const double zoom = view->xournal->getZoom();
+    const int dpiScaling = view->xournal->getDpiScaleFactor();
+    TiledBuffer& buffer = this->view->buffer;
+    buffer.setPageSize(view->page->getWidth(), view->page->getHeight());
+
+    auto tiles = buffer.getTilesIn(getAreaToRender(visibleArea, zoom), zoom);
+
+    Range tilesExtent;
+    for (auto&& index: tiles) { tilesExtent = tilesExtent.unite(buffer.getTileExtent(index, zoom)); }
+    prerenderPdfBackground(zoom, dpiScaling, tilesExtent);
 
-        renderToBuffer(newMask.get());
-        {
-            std::lock_guard lock(this->view->drawingMutex);
-            std::swap(this->view->buffer, newMask);
+    if (rerenderComplete || buffer.getZoom() != zoom) {
+        std::vector<std::pair<TiledBuffer::TileIndex, xoj::view::Mask>> newTiles;
+        newTiles.reserve(tiles.size());
+        for (auto&& index: tiles) {
+            auto& tile = newTiles.emplace_back(index, buffer.createTileMask(index, dpiScaling, zoom)).second;
+            renderToBuffer(tile.get());
         }
+        buffer.replaceAll(zoom, std::move(newTiles));
+        finishRendering(Range(0, 0, view->page->getWidth(), view->page->getHeight()));
+
         if (sizeChanged) {
             // We do not have any control on what portion of the widget needs to be redrawn. Redraw it all.
             Util::execInUiThread([w = view->xournal->getWidget()]() { gtk_widget_queue_draw(w); });
@@ -85,10 +121,49 @@ void RenderJob::run() {
             repaintPage();
         }
     } else {
+        Range updated;
         for (Rectangle<double> const& rect: rerenderRects) {
-            rerenderRectangle(rect);
+            updated = updated.unite(rerenderRectangle(rect));
             repaintPageArea(rect.x, rect.y, rect.x + rect.width, rect.y + rect.height);
         }
+
+        // Render the tiles which came into view (or were evicted)
+        for (auto&& index: buffer.getMissingTiles(tiles, zoom)) {
+            xoj::view::Mask tile = buffer.createTileMask(index, dpiScaling, zoom);
+            renderToBuffer(tile.get());
+            buffer.addTile(zoom, index, std::move(tile));
+
+            Range extent = buffer.getTileExtent(index, zoom);
+            updated = updated.unite(extent);
+            repaintPageArea(extent.minX, extent.minY, extent.maxX, extent.maxY);
+        }
+        finishRendering(updated);
+    }
+
+    auto budget = static_cast<size_t>(view->getXournal()->getControl()->getSettings()->getPageBufferMemoryBudget());
+    if (TiledBuffer::getTotalMemoryUsage() > budget * 1024 * 1024) {
+        view->evictInvisibleTiles();
+    }
+}
+
+void RenderJob::finishRendering(const Range& updated) const {
+    bool previewPending = false;
+    {
+        std::lock_guard lock(this->view->repaintRectMutex);
+        this->view->rendering = false;
+        this->view->updatedForPreview = this->view->updatedForPreview.unite(updated);
+        // Wait for the pending renderings, if any: they will notify the previews
+        if (this->view->rerenderComplete || !this->view->rerenderRects.empty()) {
+            return;
+        }
+        previewPending = std::exchange(this->view->previewPending, false);
+    }
+
+    if (previewPending) {
+        // The preview of the page can now be taken from the buffer
+        Util::execInUiThread([control = view->xournal->getControl(), page = view->page]() {
+            control->undoRedoPageChanged(page);
+        });
     }
 }
 
@@ -107,13 +182,36 @@ void RenderJob::repaintPageArea(double x1, double y1, double x2, double y2) cons
     repaintWidgetArea(view->xournal->getWidget(), x + std::floor(zoom * x1), y + std::floor(zoom * y1), x + std::ceil(zoom * x2), y + std::ceil(zoom * y2));
 }
 
+void RenderJob::prerenderPdfBackground(double zoom, int dpiScaling, const Range& area) const {
+    PdfCache* cache = this->view->xournal->getCache();
+    if (cache == nullptr) {
+        return;
+    }
+
+    size_t pdfPageNo = npos;
+    double width = 0;
+    double height = 0;
+    {
+        std::shared_lock<Document> lock(*this->view->xournal->getDocument());
+        if (this->view->page->getBackgroundType().isPdfPage()) {
+            pdfPageNo = this->view->page->getPdfPageNr();
+            width = this->view->page->getWidth();
+            height = this->view->page->getHeight();
+        }
+    }
+
+    if (pdfPageNo != npos && !area.empty()) {
+        cache->prerender(pdfPageNo, zoom * dpiScaling, width, height, area);
+    }
+}
+
 void RenderJob::renderToBuffer(cairo_t* cr) const {
     DocumentView localView;
     localView.setMarkAudioStroke(this->view->getXournal()->getControl()->getToolHandler()->getToolType() ==
                                  TOOL_PLAY_OBJECT);
     localView.setPdfCache(this->view->xournal->getCache());
 
-    std::lock_guard<Document> lock(*this->view->xournal->getDocument());
+    std::shared_lock<Document> lock(*this->view->xournal->getDocument());
     localView.drawPage(this->view->page, cr, false);
 }
 
@@ -16,6 +16,7 @@
 
 #include "Job.h"  // for Job, JobType
 
+class Range;
 class XojPageView;
 namespace xoj::util {
 template <class T>
@@ -41,7 +42,26 @@ private:
 
     void repaintPageArea(double x1, double y1, double x2, double y2) const;
 
-    void rerenderRectangle(xoj::util::Rectangle<double> const& rect);
+    /**
+     * @return The part of the buffer which has been updated
+     */
+    Range rerenderRectangle(xoj::util::Rectangle<double> const& rect);
+
+    /**
+     * Publish the parts of the buffer updated by this job, for the sidebar preview
+     */
+    void finishRendering(const Range& updated) const;
+
+    /**
+     * The part of the page whose tiles should be rendered, given the part visible on screen
+     */
+    Range getAreaToRender(Range visibleArea, double zoom) const;
+
+    /**
+     * Rasterize the part of the PDF background of the page (if any) within the given area into the PdfCache, without
+     * holding the document lock, so that several pages can be rasterized concurrently
+     */
+    void prerenderPdfBackground(double zoom, int dpiScaling, const Range& area) const;
 
     void renderToBuffer(cairo_t* cr) const;
 
@@ -22,7 +22,7 @@
 #include "filesystem.h"  // for path, filesystem_error, remove
 
 
-SaveJob::SaveJob(Control* control): BlockingJob(control, _("Save")) {}
+SaveJob::SaveJob(Control* control, bool compact): BlockingJob(control, _("Save")), compact(compact) {}
 
 SaveJob::~SaveJob() = default;
 
@@ -47,7 +47,8 @@ void SaveJob::updatePreview(Control* control) {
 
     Document* doc = control->getDocument();
 
-    doc->lock();
+    cairo_surface_t* crBuffer = nullptr;
+    doc->lock_shared();
 
     if (doc->getPageCount() > 0) {
         PageRef page = doc->getPage(0);
@@ -65,8 +66,8 @@ void SaveJob::updatePreview(Control* control) {
         width *= zoom;
         height *= zoom;
 
-        cairo_surface_t* crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, static_cast<int>(std::ceil(width)),
-                                                               static_cast<int>(std::ceil(height)));
+        crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, static_cast<int>(std::ceil(width)),
+                                              static_cast<int>(std::ceil(height)));
 
         cairo_t* cr = cairo_create(crBuffer);
         cairo_scale(cr, zoom, zoom);
@@ -84,19 +85,25 @@ void SaveJob::updatePreview(Control* control) {
         DocumentView view;
         view.drawPage(page, cr, true /* don't render erasable */, true /* Don't rerender the pdf background */);
         cairo_destroy(cr);
-        doc->setPreview(crBuffer);
-        cairo_surface_destroy(crBuffer);
-    } else {
-        doc->setPreview(nullptr);
     }
 
+    doc->unlock_shared();
+
+    doc->lock();
+    doc->setPreview(crBuffer);
     doc->unlock();
+    if (crBuffer) {
+        cairo_surface_destroy(crBuffer);
+    }
 }
 
 auto SaveJob::save() -> bool {
     updatePreview(control);
     Document* doc = this->control->getDocument();
     SaveHandler h;
+    if (!this->compact) {
+        h.setCache(this->control->getSaveCache());
+    }
 
     doc->lock();
     h.prepareSave(doc);
@@ -122,8 +129,11 @@ auto SaveJob::save() -> bool {
         }
     }
 
-    doc->lock();
+    // The handler works from the snapshot taken by prepareSave() and only locks the document (shared) while it
+    // serializes and compresses the pages
     h.saveTo(target, this->control);
+
+    doc->lock();
     doc->setFilepath(target);
     doc->unlock();
 
@@ -20,7 +20,11 @@ class Control;
 
 class SaveJob: public BlockingJob {
 public:
-    SaveJob(Control* control);
+    /**
+     * @param compact If true, the file is written as a single gzip stream, without reusing the pages compressed by
+     * the previous saves
+     */
+    SaveJob(Control* control, bool compact = false);
 
 protected:
     ~SaveJob() override;
@@ -37,4 +41,5 @@ protected:
 
 private:
     std::string lastError;
+    bool compact;
 };
@@ -1,5 +1,6 @@
 #include "Scheduler.h"
 
+#include <algorithm>  // for min
 #include <cassert>    // for assert
 #include <cinttypes>  // for PRId64
 #include <cstdint>    // for uint64_t
@@ -28,9 +29,12 @@ Scheduler::Scheduler() {
 Scheduler::~Scheduler() {
     SDEBUG("Destroy scheduler");
 
-    if (this->jobRenderThreadTimerId) {
-        g_source_remove(this->jobRenderThreadTimerId);
-        this->jobRenderThreadTimerId = 0;
+    {
+        std::lock_guard lock{this->blockRenderMutex};
+        if (this->jobRenderThreadTimerId) {
+            g_source_remove(this->jobRenderThreadTimerId);
+            this->jobRenderThreadTimerId = 0;
+        }
     }
 
     stop();
@@ -43,24 +47,49 @@ Scheduler::~Scheduler() {
     }
 }
 
-void Scheduler::start() {
+/**
+ * Upper bound for the automatically chosen number of render workers. Rendering is mostly limited by memory bandwidth
+ * and by the document lock, so more threads than this do not pay off.
+ */
+constexpr unsigned int MAX_AUTO_RENDER_WORKERS = 7;
+
+void Scheduler::start(unsigned int renderWorkers) {
     SDEBUG("Starting scheduler");
-    g_return_if_fail(this->thread == nullptr);
+    g_return_if_fail(this->workers.empty());
+
+    if (renderWorkers == 0) {
+        // Keep one core for the UI thread and one for the main worker
+        auto processors = g_get_num_processors();
+        renderWorkers = std::min(processors > 2 ? processors - 2 : 0U, MAX_AUTO_RENDER_WORKERS);
+    }
 
-    this->thread = g_thread_new(name.c_str(), reinterpret_cast<GThreadFunc>(jobThreadCallback), this);
+    this->workers.reserve(renderWorkers + 1);
+    for (unsigned int i = 0; i <= renderWorkers; i++) {
+        auto& worker = this->workers.emplace_back(std::make_unique<Worker>(Worker{this, i != 0}));
+        std::string threadName = i == 0 ? name : name + "-render-" + std::to_string(i);
+        worker->thread =
+                g_thread_new(threadName.c_str(), reinterpret_cast<GThreadFunc>(jobThreadCallback), worker.get());
+    }
+    SDEBUG("Started %u render workers", renderWorkers);
 }
 
 void Scheduler::stop() {
     SDEBUG("Stopping scheduler");
 
-    if (!this->threadRunning) {
-        return;
+    {
+        std::lock_guard lock{this->jobQueueMutex};
+        if (!this->threadRunning) {
+            return;
+        }
+        this->threadRunning = false;
     }
-    this->threadRunning = false;
     this->jobQueueCond.notify_all();
 
-    if (this->thread) {
-        g_thread_join(this->thread);
+    for (auto& worker: this->workers) {
+        if (worker->thread) {
+            g_thread_join(worker->thread);
+            worker->thread = nullptr;
+        }
     }
 }
 
@@ -78,30 +107,36 @@ void Scheduler::addJob(Job* job, JobPriority priority) {
     this->jobQueueCond.notify_all();
 }
 
-auto Scheduler::getNextJobUnlocked(bool onlyNotRender, bool* hasRenderJobs) -> Job* {
-    Job* job = nullptr;
-
+auto Scheduler::getNextJobUnlocked(bool renderOnly, bool onlyNotRender, bool* hasRenderJobs) -> Job* {
+    /*
+     * All workers share the priority queues: a worker always takes the most urgent job it is allowed to run, and
+     * only falls back to the lower priority queues if the higher ones contain nothing it can take.
+     */
     for (int i = JOB_PRIORITY_URGENT; i < JOB_N_PRIORITIES; i++) {
         std::deque<Job*>& queue = *this->jobQueue[i];
 
-        if (onlyNotRender) {
-            for (auto it = queue.begin(); it != queue.end(); ++it) {
-                job = *it;
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            Job* job = *it;
+            assert(job != nullptr);
 
-                if (job->getType() != JOB_TYPE_RENDER) {
-                    queue.erase(it);
-                    return job;
-                }
+            JobType type = job->getType();
+            if (renderOnly && type != JOB_TYPE_RENDER && type != JOB_TYPE_PREVIEW) {
+                continue;
+            }
 
+            if (onlyNotRender && type == JOB_TYPE_RENDER) {
                 if (hasRenderJobs != nullptr) {
                     *hasRenderJobs = true;
                 }
+                continue;
+            }
+
+            if (void* source = job->getSource(); source && this->runningSources.count(source)) {
+                // Another worker is busy with this source
+                continue;
             }
-        } else if (!queue.empty()) {
-            job = queue.front();
-            queue.pop_front();
-            assert(job != nullptr);
 
+            queue.erase(it);
             return job;
         }
     }
@@ -109,15 +144,37 @@ auto Scheduler::getNextJobUnlocked(bool onlyNotRender, bool* hasRenderJobs) -> J
     return nullptr;
 }
 
+void Scheduler::awaitSourceUnlocked(std::unique_lock<std::mutex>& lock, void* source) {
+    this->jobFinishedCond.wait(lock, [&]() { return this->runningSources.count(source) == 0; });
+}
+
+void Scheduler::awaitAllJobsUnlocked(std::unique_lock<std::mutex>& lock) {
+    this->jobFinishedCond.wait(lock, [&]() { return this->runningJobs == 0; });
+}
+
 /**
  * Locks the complete scheduler
  */
-void Scheduler::lock() { this->schedulerMutex.lock(); }
+void Scheduler::lock() {
+    this->schedulerMutex.lock();
+
+    std::unique_lock lock{this->jobQueueMutex};
+    this->schedulerLocked = true;
+    awaitAllJobsUnlocked(lock);
+}
 
 /**
  * Unlocks the complete scheduler
  */
-void Scheduler::unlock() { this->schedulerMutex.unlock(); }
+void Scheduler::unlock() {
+    {
+        std::lock_guard lock{this->jobQueueMutex};
+        this->schedulerLocked = false;
+    }
+    this->jobQueueCond.notify_all();
+
+    this->schedulerMutex.unlock();
+}
 
 #define ZOOM_WAIT_US_TIMEOUT 300000  // 0.3s
 
@@ -170,10 +227,9 @@ auto g_time_val_diff(GTimeVal* t1, GTimeVal* t2) -> glong {
  * we need to wakeup it later
  */
 auto Scheduler::jobRenderThreadTimer(Scheduler* scheduler) -> bool {
-    scheduler->jobRenderThreadTimerId = 0;
-
     {
         std::lock_guard lock{scheduler->blockRenderMutex};
+        scheduler->jobRenderThreadTimerId = 0;
         g_free(scheduler->blockRenderZoomTime);
         scheduler->blockRenderZoomTime = nullptr;
     }
@@ -183,70 +239,89 @@ auto Scheduler::jobRenderThreadTimer(Scheduler* scheduler) -> bool {
     return false;
 }
 
-auto Scheduler::jobThreadCallback(Scheduler* scheduler) -> gpointer {
-    while (scheduler->threadRunning) {
-        // lock the whole scheduler
-        std::unique_lock schedulerLock{scheduler->schedulerMutex};
-        SDEBUG("Job Thread: Blocked scheduler.");
+auto Scheduler::jobThreadCallback(Worker* worker) -> gpointer {
+    Scheduler* scheduler = worker->scheduler;
 
+    while (true) {
         bool onlyNonRenderJobs = false;
         glong diff = 1000;
-        if (scheduler->blockRenderZoomTime) {
+        {
             std::lock_guard lock{scheduler->blockRenderMutex};
-            SDEBUG("Zoom re-render blocking.");
-
-            GTimeVal time;
-            g_get_current_time(&time);
-
-            diff = g_time_val_diff(scheduler->blockRenderZoomTime, &time);
-            if (diff <= 0) {
-                g_free(scheduler->blockRenderZoomTime);
-                scheduler->blockRenderZoomTime = nullptr;
-                SDEBUG("Ended zoom re-render blocking.");
-            } else {
-                onlyNonRenderJobs = true;
-                SDEBUG("Rendering blocked: Only running non-rendering jobs.");
+            if (scheduler->blockRenderZoomTime) {
+                SDEBUG("Zoom re-render blocking.");
+
+                GTimeVal time;
+                g_get_current_time(&time);
+
+                diff = g_time_val_diff(scheduler->blockRenderZoomTime, &time);
+                if (diff <= 0) {
+                    g_free(scheduler->blockRenderZoomTime);
+                    scheduler->blockRenderZoomTime = nullptr;
+                    SDEBUG("Ended zoom re-render blocking.");
+                } else {
+                    onlyNonRenderJobs = true;
+                    SDEBUG("Rendering blocked: Only running non-rendering jobs.");
+                }
             }
         }
 
-        Job* job;
+        Job* job = nullptr;
+        void* source = nullptr;
 
         {
             std::unique_lock jobLock{scheduler->jobQueueMutex};
             SDEBUG("Job Thread: Locked job queue.");
 
-            bool hasOnlyRenderJobs = false;
-            job = scheduler->getNextJobUnlocked(onlyNonRenderJobs, &hasOnlyRenderJobs);
-            if (job != nullptr) {
-                hasOnlyRenderJobs = false;
+            if (!scheduler->threadRunning) {
+                break;
             }
 
+            if (scheduler->schedulerLocked) {
+                SDEBUG("Job Thread: Scheduler is locked.");
+                scheduler->jobQueueCond.wait(jobLock);
+                continue;
+            }
+
+            bool hasOnlyRenderJobs = false;
+            job = scheduler->getNextJobUnlocked(worker->renderOnly, onlyNonRenderJobs, &hasOnlyRenderJobs);
+
             SDEBUG("get job: %" PRId64, (uint64_t)job);
 
             if (job == nullptr) {
-                // unlock the whole scheduler
-                schedulerLock.unlock();
-
                 if (hasOnlyRenderJobs) {
-                    if (scheduler->jobRenderThreadTimerId) {
-                        g_source_remove(scheduler->jobRenderThreadTimerId);
+                    std::lock_guard lock{scheduler->blockRenderMutex};
+                    if (scheduler->jobRenderThreadTimerId == 0) {
+                        scheduler->jobRenderThreadTimerId = g_timeout_add(
+                                static_cast<guint>(diff), xoj::util::wrap_for_once_v<jobRenderThreadTimer>, scheduler);
                     }
-                    scheduler->jobRenderThreadTimerId = g_timeout_add(
-                            static_cast<guint>(diff), xoj::util::wrap_for_once_v<jobRenderThreadTimer>, scheduler);
                 }
 
                 scheduler->jobQueueCond.wait(jobLock);
                 continue;
             }
+
+            source = job->getSource();
+            if (source) {
+                scheduler->runningSources.insert(source);
+            }
+            scheduler->runningJobs++;
         }
 
         // Run the job.
+        SDEBUG("do job: %" PRId64, (uint64_t)job);
+        job->execute();
+        job->unref();
+
         {
-            std::lock_guard lock{scheduler->jobRunningMutex};
-            SDEBUG("do job: %" PRId64, (uint64_t)job);
-            job->execute();
-            job->unref();
+            std::lock_guard jobLock{scheduler->jobQueueMutex};
+            if (source) {
+                scheduler->runningSources.erase(source);
+            }
+            scheduler->runningJobs--;
         }
+        scheduler->jobFinishedCond.notify_all();
+        // Jobs that were skipped because their source was busy may be run now
+        scheduler->jobQueueCond.notify_all();
 
         SDEBUG("next");
     }
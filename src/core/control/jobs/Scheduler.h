@@ -16,8 +16,11 @@
 #include <array>               // for array
 #include <condition_variable>  // for condition_variable
 #include <deque>               // for deque
+#include <memory>              // for unique_ptr
 #include <mutex>               // for mutex
 #include <string>              // for string
+#include <unordered_set>       // for unordered_set
+#include <vector>              // for vector
 
 #include <glib.h>  // for GThread, GTimeVal, gpointer
 
@@ -79,11 +82,20 @@ public:
      */
     void addJob(Job* job, JobPriority priority);
 
-    void start();
+    /**
+     * Starts the worker threads.
+     *
+     * The first thread processes every kind of job. Blocking jobs (saving, exporting...) are only ever run by this
+     * thread, so they stay serialized. The additional render workers only pick up render and preview jobs.
+     *
+     * @param renderWorkers the number of additional render workers. 0 means: choose depending on the number of cores
+     */
+    void start(unsigned int renderWorkers = 0);
     void stop();
 
     /**
-     * Locks the complete scheduler
+     * Locks the complete scheduler: blocks until no job is running and prevents any new job from starting until
+     * unlock() is called.
      */
     void lock();
 
@@ -103,27 +115,69 @@ public:
     void unblockRerenderZoom();
 
 private:
-    static auto jobThreadCallback(Scheduler* scheduler) -> gpointer;
-    auto getNextJobUnlocked(bool onlyNotRender = false, bool* hasRenderJobs = nullptr) -> Job*;
+    struct Worker {
+        Scheduler* scheduler;
+
+        /**
+         * Render workers only run render and preview jobs
+         */
+        bool renderOnly;
+
+        GThread* thread = nullptr;
+    };
+
+    static auto jobThreadCallback(Worker* worker) -> gpointer;
+
+    /**
+     * Picks the job of highest priority this worker may run. Jobs whose source is currently used by another worker
+     * are skipped and left to the next free worker.
+     */
+    auto getNextJobUnlocked(bool renderOnly = false, bool onlyNotRender = false, bool* hasRenderJobs = nullptr)
+            -> Job*;
 
     static auto jobRenderThreadTimer(Scheduler* scheduler) -> bool;
 
+protected:
+    /**
+     * Blocks until no job is running on `source`. The caller must hold jobQueueMutex.
+     */
+    void awaitSourceUnlocked(std::unique_lock<std::mutex>& lock, void* source);
+
+    /**
+     * Blocks until no job is running at all. The caller must hold jobQueueMutex.
+     */
+    void awaitAllJobsUnlocked(std::unique_lock<std::mutex>& lock);
+
 protected:
     bool threadRunning = true;
 
     guint jobRenderThreadTimerId = 0;
 
-    GThread* thread = nullptr;
+    std::vector<std::unique_ptr<Worker>> workers{};
 
     std::condition_variable jobQueueCond{};
     std::mutex jobQueueMutex{};
+
+    /**
+     * Serializes calls to lock() / unlock()
+     */
     std::mutex schedulerMutex{};
 
+    /**
+     * True while the scheduler is locked, see lock(). Protected by jobQueueMutex.
+     */
+    bool schedulerLocked = false;
+
     /**
      * This is need to be sure there is no job running if we delete a page.
      * If a job is, we may access deleted memory.
+     *
+     * Contains the sources of all currently running jobs; a source is never used by two jobs at the same time.
+     * Protected by jobQueueMutex, jobFinishedCond is signaled whenever a job finished.
      */
-    std::mutex jobRunningMutex{};
+    std::unordered_set<void*> runningSources{};
+    size_t runningJobs = 0;
+    std::condition_variable jobFinishedCond{};
 
     /**
      * Jobs of each priority. New jobs
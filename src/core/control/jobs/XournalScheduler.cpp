@@ -53,34 +53,35 @@ void XournalScheduler::removeAllJobs() {
     }
 }
 
-void XournalScheduler::finishTask() { std::lock_guard lock{this->jobRunningMutex}; }
+void XournalScheduler::finishTask() {
+    std::unique_lock lock{this->jobQueueMutex};
+    awaitAllJobsUnlocked(lock);
+}
 
 void XournalScheduler::removeSource(void* source, JobType type, JobPriority priority, bool awaitFinishTask) {
-    {
-        std::lock_guard lock{this->jobQueueMutex};
-        std::deque<Job*>& queue = *this->jobQueue[priority];
+    std::unique_lock lock{this->jobQueueMutex};
+    std::deque<Job*>& queue = *this->jobQueue[priority];
 
-        auto it = queue.begin();
+    auto it = queue.begin();
 
-        while (it != queue.end()) {
-            Job* job = *it;
+    while (it != queue.end()) {
+        Job* job = *it;
 
-            if (job->getType() == type && job->getSource() == source) {
-                it = queue.erase(it);
+        if (job->getType() == type && job->getSource() == source) {
+            it = queue.erase(it);
 
-                job->deleteJob();
-                job->unref();
-                job = nullptr;
-            } else {
-                ++it;
-            }
+            job->deleteJob();
+            job->unref();
+            job = nullptr;
+        } else {
+            ++it;
         }
     }
 
-    // wait until the last job is done
+    // wait until the last job using "source" is done
     // we can be sure we don't access "source"
     if (awaitFinishTask) {
-        finishTask();
+        awaitSourceUnlocked(lock, source);
     }
 }
 
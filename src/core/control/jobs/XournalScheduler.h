@@ -28,7 +28,8 @@ public:
 public:
     /**
      * Remove source, e.g. if a page is removed they don't need to repaint.
-     * Blocks until all jobs that could be using the source have finished.
+     * Blocks until the job currently using the source (if any) has finished.
+     * Jobs running on other sources are not waited for.
      */
     void removeSidebar(SidebarPreviewBaseEntry* preview);
     void removePage(XojPageView* view);
@@ -0,0 +1,59 @@
+#include "LatexCache.h"
+
+#include <utility>  // for move
+
+#include <glib.h>  // for g_checksum_new, g_checksum_update, g_checksum_get_string
+
+namespace {
+auto sizeOf(const LatexCache::Result& result) -> size_t { return result.pdf.size() + result.output.size(); }
+}  // namespace
+
+LatexCache::LatexCache(size_t memoryBudget): memoryBudget(memoryBudget) {}
+
+auto LatexCache::computeKey(const std::string& command, const std::string& texFileContents) -> std::string {
+    GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(command.c_str()), static_cast<gssize>(command.size()));
+    // Separate the command from the file contents, which could otherwise be shifted between both
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(""), 1);
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(texFileContents.c_str()),
+                      static_cast<gssize>(texFileContents.size()));
+    std::string key = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return key;
+}
+
+auto LatexCache::get(const std::string& key) -> std::optional<Result> {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->index.find(key);
+    if (it == this->index.end()) {
+        return std::nullopt;
+    }
+    this->entries.splice(this->entries.begin(), this->entries, it->second);
+    return it->second->result;
+}
+
+void LatexCache::put(const std::string& key, Result result) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (auto it = this->index.find(key); it != this->index.end()) {
+        this->memoryUsed -= sizeOf(it->second->result);
+        this->entries.erase(it->second);
+        this->index.erase(it);
+    }
+
+    this->memoryUsed += sizeOf(result);
+    this->entries.push_front({key, std::move(result)});
+    this->index[key] = this->entries.begin();
+
+    // Keep at least the most recent result
+    while (this->memoryUsed > this->memoryBudget && this->entries.size() > 1) {
+        const Entry& last = this->entries.back();
+        this->memoryUsed -= sizeOf(last.result);
+        this->index.erase(last.key);
+        this->entries.pop_back();
+    }
+}
+
+auto LatexCache::getShared() -> LatexCache& {
+    static LatexCache cache(16U * 1024U * 1024U);
+    return cache;
+}
@@ -0,0 +1,64 @@
+/*
+ * Xournal++
+ *
+ * Cache of the PDFs generated by the LaTeX command
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <list>      // for list
+#include <map>       // for map
+#include <mutex>     // for mutex
+#include <optional>  // for optional
+#include <string>    // for string
+
+/**
+ * The PDFs generated by the LaTeX command, keyed by a hash of the command and of the TeX file it compiled. The cache is
+ * shared by all the documents, so that a formula is compiled only once per session.
+ */
+class LatexCache {
+public:
+    explicit LatexCache(size_t memoryBudget);
+
+    struct Result {
+        /// The generated PDF
+        std::string pdf;
+        /// The output of the LaTeX command
+        std::string output;
+    };
+
+    /**
+     * @return The key of the result of running the command on the TeX file contents
+     */
+    static std::string computeKey(const std::string& command, const std::string& texFileContents);
+
+    std::optional<Result> get(const std::string& key);
+
+    /**
+     * Store a result, dropping the least recently used ones if the memory budget is exceeded
+     */
+    void put(const std::string& key, Result result);
+
+    /**
+     * @return The cache shared by all the documents
+     */
+    static LatexCache& getShared();
+
+private:
+    struct Entry {
+        std::string key;
+        Result result;
+    };
+
+    std::mutex mutex;
+    std::list<Entry> entries;  ///< From the most to the least recently used
+    std::map<std::string, std::list<Entry>::iterator> index;
+    size_t memoryUsed = 0;
+    size_t memoryBudget;
+};
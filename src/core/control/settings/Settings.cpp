@@ -177,10 +177,16 @@ void Settings::loadDefault() {
     this->touchZoomStartThreshold = 0.0;
 
     this->pageRerenderThreshold = 5.0;
-    this->pdfPageCacheSize = 10;
+    this->pdfPageCacheMemoryBudget = 128U;
+    this->imageCacheMemoryBudget = 256U;
+    this->texImageCacheMemoryBudget = 64U;
+    this->strokePathCacheMemoryBudget = 64U;
     this->preloadPagesBefore = 3U;
     this->preloadPagesAfter = 5U;
     this->eagerPageCleanup = true;
+    this->renderWorkerCount = 0U;
+    this->pageBufferMemoryBudget = 512U;
+    this->undoMemoryBudget = 256U;
 
     this->selectionBorderColor = Colors::red;
     this->selectionMarkerColor = Colors::xopp_cornflowerblue;
@@ -495,14 +501,26 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->touchZoomStartThreshold = g_ascii_strtod(reinterpret_cast<const char*>(value), nullptr);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pageRerenderThreshold")) == 0) {
         this->pageRerenderThreshold = g_ascii_strtod(reinterpret_cast<const char*>(value), nullptr);
-    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pdfPageCacheSize")) == 0) {
-        this->pdfPageCacheSize = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pdfPageCacheMemoryBudget")) == 0) {
+        this->pdfPageCacheMemoryBudget = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("imageCacheMemoryBudget")) == 0) {
+        this->imageCacheMemoryBudget = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("texImageCacheMemoryBudget")) == 0) {
+        this->texImageCacheMemoryBudget = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("strokePathCacheMemoryBudget")) == 0) {
+        this->strokePathCacheMemoryBudget = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("preloadPagesBefore")) == 0) {
         this->preloadPagesBefore = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("preloadPagesAfter")) == 0) {
         this->preloadPagesAfter = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("eagerPageCleanup")) == 0) {
         this->eagerPageCleanup = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("renderWorkerCount")) == 0) {
+        this->renderWorkerCount = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("pageBufferMemoryBudget")) == 0) {
+        this->pageBufferMemoryBudget = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("undoMemoryBudget")) == 0) {
+        this->undoMemoryBudget = g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("selectionBorderColor")) == 0) {
         this->selectionBorderColor = Color(g_ascii_strtoull(reinterpret_cast<const char*>(value), nullptr, 10));
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("selectionMarkerColor")) == 0) {
@@ -1033,11 +1051,23 @@ void Settings::save() {
     SAVE_DOUBLE_PROP(touchZoomStartThreshold);
     SAVE_DOUBLE_PROP(pageRerenderThreshold);
 
-    SAVE_INT_PROP(pdfPageCacheSize);
-    ATTACH_COMMENT("The count of rendered PDF pages which will be cached.");
+    SAVE_UINT_PROP(pdfPageCacheMemoryBudget);
+    ATTACH_COMMENT("The memory (in MiB) used to cache the rendered PDF pages.");
+    SAVE_UINT_PROP(imageCacheMemoryBudget);
+    ATTACH_COMMENT("The memory (in MiB) used to keep the images decoded.");
+    SAVE_UINT_PROP(texImageCacheMemoryBudget);
+    ATTACH_COMMENT("The memory (in MiB) used to cache the rasterized LaTeX formulas.");
+    SAVE_UINT_PROP(strokePathCacheMemoryBudget);
+    ATTACH_COMMENT("The memory (in MiB) used to cache the paths of the strokes.");
     SAVE_UINT_PROP(preloadPagesBefore);
     SAVE_UINT_PROP(preloadPagesAfter);
     SAVE_BOOL_PROP(eagerPageCleanup);
+    SAVE_UINT_PROP(renderWorkerCount);
+    ATTACH_COMMENT("The number of additional threads used to render pages. 0 = depending on the number of CPU cores.");
+    SAVE_UINT_PROP(pageBufferMemoryBudget);
+    ATTACH_COMMENT("The memory (in MiB) used by rendered pages before off-screen parts are freed.");
+    SAVE_UINT_PROP(undoMemoryBudget);
+    ATTACH_COMMENT("The memory (in MiB) used by the undo history before old strokes are moved to disk. 0 = no limit.");
 
     SAVE_STRING_PROP(pageTemplate);
     ATTACH_COMMENT("Config for new pages");
@@ -1954,13 +1984,43 @@ void Settings::setPDFPageRerenderThreshold(double threshold) {
     save();
 }
 
-auto Settings::getPdfPageCacheSize() const -> int { return this->pdfPageCacheSize; }
+auto Settings::getPdfPageCacheMemoryBudget() const -> unsigned int { return this->pdfPageCacheMemoryBudget; }
 
-void Settings::setPdfPageCacheSize(int size) {
-    if (this->pdfPageCacheSize == size) {
+void Settings::setPdfPageCacheMemoryBudget(unsigned int megabytes) {
+    if (this->pdfPageCacheMemoryBudget == megabytes) {
         return;
     }
-    this->pdfPageCacheSize = size;
+    this->pdfPageCacheMemoryBudget = megabytes;
+    save();
+}
+
+auto Settings::getImageCacheMemoryBudget() const -> unsigned int { return this->imageCacheMemoryBudget; }
+
+void Settings::setImageCacheMemoryBudget(unsigned int megabytes) {
+    if (this->imageCacheMemoryBudget == megabytes) {
+        return;
+    }
+    this->imageCacheMemoryBudget = megabytes;
+    save();
+}
+
+auto Settings::getTexImageCacheMemoryBudget() const -> unsigned int { return this->texImageCacheMemoryBudget; }
+
+void Settings::setTexImageCacheMemoryBudget(unsigned int megabytes) {
+    if (this->texImageCacheMemoryBudget == megabytes) {
+        return;
+    }
+    this->texImageCacheMemoryBudget = megabytes;
+    save();
+}
+
+auto Settings::getStrokePathCacheMemoryBudget() const -> unsigned int { return this->strokePathCacheMemoryBudget; }
+
+void Settings::setStrokePathCacheMemoryBudget(unsigned int megabytes) {
+    if (this->strokePathCacheMemoryBudget == megabytes) {
+        return;
+    }
+    this->strokePathCacheMemoryBudget = megabytes;
     save();
 }
 
@@ -1994,6 +2054,36 @@ void Settings::setEagerPageCleanup(bool b) {
     save();
 }
 
+auto Settings::getRenderWorkerCount() const -> unsigned int { return this->renderWorkerCount; }
+
+void Settings::setRenderWorkerCount(unsigned int n) {
+    if (this->renderWorkerCount == n) {
+        return;
+    }
+    this->renderWorkerCount = n;
+    save();
+}
+
+auto Settings::getPageBufferMemoryBudget() const -> unsigned int { return this->pageBufferMemoryBudget; }
+
+void Settings::setPageBufferMemoryBudget(unsigned int megabytes) {
+    if (this->pageBufferMemoryBudget == megabytes) {
+        return;
+    }
+    this->pageBufferMemoryBudget = megabytes;
+    save();
+}
+
+auto Settings::getUndoMemoryBudget() const -> unsigned int { return this->undoMemoryBudget; }
+
+void Settings::setUndoMemoryBudget(unsigned int megabytes) {
+    if (this->undoMemoryBudget == megabytes) {
+        return;
+    }
+    this->undoMemoryBudget = megabytes;
+    save();
+}
+
 auto Settings::getBorderColor() const -> Color { return this->selectionBorderColor; }
 
 void Settings::setBorderColor(Color color) {
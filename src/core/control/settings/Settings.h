@@ -372,8 +372,29 @@ public:
     double getTouchZoomStartThreshold() const;
     void setTouchZoomStartThreshold(double threshold);
 
-    int getPdfPageCacheSize() const;
-    [[maybe_unused]] void setPdfPageCacheSize(int size);
+    /**
+     * The memory (in MiB) the rendered PDF pages of a PdfCache may use before the least recently used ones are evicted.
+     */
+    unsigned int getPdfPageCacheMemoryBudget() const;
+    [[maybe_unused]] void setPdfPageCacheMemoryBudget(unsigned int megabytes);
+
+    /**
+     * The memory (in MiB) the decoded images may use before the least recently used ones are freed.
+     */
+    unsigned int getImageCacheMemoryBudget() const;
+    [[maybe_unused]] void setImageCacheMemoryBudget(unsigned int megabytes);
+
+    /**
+     * The memory (in MiB) the rasterized LaTeX formulas may use before the least recently used ones are freed.
+     */
+    unsigned int getTexImageCacheMemoryBudget() const;
+    [[maybe_unused]] void setTexImageCacheMemoryBudget(unsigned int megabytes);
+
+    /**
+     * The memory (in MiB) the paths of the strokes may use before the least recently used ones are freed.
+     */
+    unsigned int getStrokePathCacheMemoryBudget() const;
+    [[maybe_unused]] void setStrokePathCacheMemoryBudget(unsigned int megabytes);
 
     unsigned int getPreloadPagesBefore() const;
     void setPreloadPagesBefore(unsigned int n);
@@ -384,6 +405,26 @@ public:
     bool isEagerPageCleanup() const;
     void setEagerPageCleanup(bool b);
 
+    /**
+     * The number of additional threads rendering pages and previews in parallel.
+     * 0 means: choose depending on the number of available cores.
+     */
+    unsigned int getRenderWorkerCount() const;
+    void setRenderWorkerCount(unsigned int n);
+
+    /**
+     * The memory (in MiB) the rendered page tiles may use before the tiles far from the visible area are evicted.
+     */
+    unsigned int getPageBufferMemoryBudget() const;
+    void setPageBufferMemoryBudget(unsigned int megabytes);
+
+    /**
+     * The memory (in MiB) the undo history may use before the strokes of the oldest actions are moved to a temporary
+     * file. 0 means no limit.
+     */
+    unsigned int getUndoMemoryBudget() const;
+    void setUndoMemoryBudget(unsigned int megabytes);
+
     std::string const& getPageTemplate() const;
     void setPageTemplate(const std::string& pageTemplate);
 
@@ -909,9 +950,24 @@ private:
     std::vector<ViewMode> viewModes;
 
     /**
-     *  The count of pages which will be cached
+     *  The memory budget of the PDF page caches, in MiB
+     */
+    unsigned int pdfPageCacheMemoryBudget{};
+
+    /**
+     *  The memory budget of the decoded images, in MiB
+     */
+    unsigned int imageCacheMemoryBudget{};
+
+    /**
+     *  The memory budget of the rasterized LaTeX formulas, in MiB
+     */
+    unsigned int texImageCacheMemoryBudget{};
+
+    /**
+     *  The memory budget of the paths of the strokes, in MiB
      */
-    int pdfPageCacheSize{};
+    unsigned int strokePathCacheMemoryBudget{};
 
     /**
      *  Percentage by which the page's zoom must change
@@ -1086,6 +1142,21 @@ private:
      */
     bool eagerPageCleanup{};
 
+    /**
+     * The number of additional render threads of the scheduler (0 = automatic).
+     */
+    unsigned int renderWorkerCount{};
+
+    /**
+     * The memory budget of the page buffers, in MiB
+     */
+    unsigned int pageBufferMemoryBudget{};
+
+    /**
+     * The memory budget of the undo history, in MiB
+     */
+    unsigned int undoMemoryBudget{};
+
     /**
      * Stabilizer related settings
      */
@@ -269,10 +269,13 @@ auto ShapeRecognizer::recognizePatterns(Stroke* stroke, double strokeMinSize) ->
     Inertia ss[4];
     int brk[5] = {0};
 
+    // The fitting works on an array of points
+    const std::vector<Point> pts = stroke->getPointVector().toVector();
+
     // first see if it's a polygon
-    int n = findPolygonal(stroke->getPoints(), 0, stroke->getPointCount() - 1, MAX_POLYGON_SIDES, brk, ss);
+    int n = findPolygonal(pts.data(), 0, stroke->getPointCount() - 1, MAX_POLYGON_SIDES, brk, ss);
     if (n > 0) {
-        optimizePolygonal(stroke->getPoints(), n, brk, ss);
+        optimizePolygonal(pts.data(), n, brk, ss);
 #ifdef DEBUG_RECOGNIZER
         g_message("--");
         g_message("ShapeReco:: Polygon, %d edges:", n);
@@ -300,7 +303,7 @@ auto ShapeRecognizer::recognizePatterns(Stroke* stroke, double strokeMinSize) ->
         for (int i = 0; i < n; i++) {
             rs[i].startpt = brk[i];
             rs[i].endpt = brk[i + 1];
-            rs[i].calcSegmentGeometry(stroke->getPoints(), brk[i], brk[i + 1], ss + i);
+            rs[i].calcSegmentGeometry(pts.data(), brk[i], brk[i + 1], ss + i);
         }
 
         if (Stroke* result = tryRectangle(); result != nullptr) {
@@ -331,7 +334,7 @@ auto ShapeRecognizer::recognizePatterns(Stroke* stroke, double strokeMinSize) ->
                 s->addPoint(Point(rs->x1, rs->y1));
                 s->addPoint(Point(rs->x2, rs->y2));
             } else {
-                auto points = stroke->getPointVector();
+                const auto& points = stroke->getPointVector();
                 s->addPoint(Point(points.front().x, points.front().y));
                 s->addPoint(Point(points.back().x, points.back().y));
             }
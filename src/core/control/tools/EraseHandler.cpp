@@ -52,7 +52,8 @@ void EraseHandler::erase(double x, double y) {
 
     Layer* l = page->getSelectedLayer();
 
-    for (Element* e: l->getElements()) {
+    Range eraserRange(eraserRect.x, eraserRect.y, eraserRect.x + eraserRect.width, eraserRect.y + eraserRect.height);
+    for (Element* e: l->getElementsInRange(eraserRange)) {
         if (e->getType() == ELEMENT_STROKE && e->intersectsArea(&eraserRect)) {
             eraseStroke(l, dynamic_cast<Stroke*>(e), x, y, range);
         }
@@ -26,7 +26,7 @@ auto Selection::finalize(PageRef page) -> size_t {
                 continue;
             }
             bool selectionOnLayer = false;
-            for (Element* e: l->getElements()) {
+            for (Element* e: l->getElementsInRange(this->bbox)) {
                 if (e->isInSelection(this)) {
                     this->selectedElements.push_back(e);
                     selectionOnLayer = true;
@@ -39,7 +39,7 @@ auto Selection::finalize(PageRef page) -> size_t {
         }
     } else {
         Layer* l = page->getSelectedLayer();
-        for (Element* e: l->getElements()) {
+        for (Element* e: l->getElementsInRange(this->bbox)) {
             if (e->isInSelection(this)) {
                 this->selectedElements.push_back(e);
                 layerId = page->getSelectedLayerId();
@@ -0,0 +1,246 @@
+#include "XmlStreamWriter.h"
+
+#include <algorithm>  // for min
+#include <array>      // for array
+
+#include <glib.h>  // for g_base64_encode_step, g_free, g_strdup_printf
+
+#include "model/Point.h"         // for Point
+#include "model/StrokePoints.h"  // for StrokePoints
+#include "util/FloatCodec.h"     // for formatDouble, FORMAT_DOUBLE_BUF_SIZE
+#include "util/OutputStream.h"   // for OutputStream
+
+XmlStreamWriter::XmlStreamWriter(OutputStream* out): out(out) {}
+
+XmlStreamWriter::~XmlStreamWriter() {
+    if (!this->stack.empty()) {
+        g_warning("XmlStreamWriter: element <%s> was not closed", this->stack.back().tag.c_str());
+    }
+}
+
+void XmlStreamWriter::beginChild() {
+    if (!this->stack.empty()) {
+        Frame& parent = this->stack.back();
+        if (parent.state == ElementState::OPEN) {
+            writeRaw(">\n");
+            parent.state = ElementState::CHILDREN;
+        }
+    }
+}
+
+void XmlStreamWriter::startElement(const char* tag) {
+    beginChild();
+
+    writeRaw("<");
+    writeRaw(tag);
+    this->stack.push_back({tag, ElementState::OPEN});
+}
+
+void XmlStreamWriter::endElement() {
+    if (this->stack.empty()) {
+        g_warning("XmlStreamWriter::endElement(): no element to close");
+        return;
+    }
+
+    Frame& frame = this->stack.back();
+    if (frame.state == ElementState::OPEN) {
+        writeRaw("/>\n");
+    } else {
+        writeRaw("</");
+        this->out->write(frame.tag);
+        writeRaw(">\n");
+    }
+    this->stack.pop_back();
+}
+
+void XmlStreamWriter::writeSerializedElement(const std::string& xml) {
+    beginChild();
+    if (!xml.empty()) {
+        this->out->write(xml);
+    }
+}
+
+void XmlStreamWriter::beginAttrib(const char* attrib) {
+    if (this->stack.empty() || this->stack.back().state != ElementState::OPEN) {
+        g_warning("XmlStreamWriter: attribute \"%s\" set after the start tag was closed", attrib);
+    }
+    writeRaw(" ");
+    writeRaw(attrib);
+    writeRaw("=\"");
+}
+
+void XmlStreamWriter::endAttrib() { writeRaw("\""); }
+
+void XmlStreamWriter::setAttrib(const char* attrib, const std::string& value) {
+    beginAttrib(attrib);
+    writeEscaped(value, true);
+    endAttrib();
+}
+
+void XmlStreamWriter::setAttrib(const char* attrib, const char* value) {
+    beginAttrib(attrib);
+    if (value != nullptr) {
+        writeEscaped(value, true);
+    }
+    endAttrib();
+}
+
+void XmlStreamWriter::setAttrib(const char* attrib, double value) {
+    beginAttrib(attrib);
+    writeDouble(value);
+    endAttrib();
+}
+
+void XmlStreamWriter::setAttrib(const char* attrib, int value) {
+    beginAttrib(attrib);
+    char* str = g_strdup_printf("%i", value);
+    writeRaw(str);
+    g_free(str);
+    endAttrib();
+}
+
+void XmlStreamWriter::setAttrib(const char* attrib, size_t value) {
+    beginAttrib(attrib);
+    char* str = g_strdup_printf("%zu", value);
+    writeRaw(str);
+    g_free(str);
+    endAttrib();
+}
+
+void XmlStreamWriter::beginContent() {
+    if (this->stack.empty()) {
+        g_warning("XmlStreamWriter: content written outside of any element");
+        return;
+    }
+
+    Frame& frame = this->stack.back();
+    if (frame.state == ElementState::OPEN) {
+        writeRaw(">");
+        frame.state = ElementState::CONTENT;
+    }
+}
+
+void XmlStreamWriter::writePoints(const std::vector<Point>& points) { writeCoordinates(points); }
+
+void XmlStreamWriter::writePoints(const StrokePoints& points) { writeCoordinates(points.getCoordinates()); }
+
+template <typename Coordinates>
+void XmlStreamWriter::writeCoordinates(const Coordinates& points) {
+    beginContent();
+
+    // Format the coordinates into a local buffer and write it out in large blocks
+    constexpr size_t MAX_POINT_LENGTH = 2 * Util::FORMAT_DOUBLE_BUF_SIZE + 2;
+    std::array<char, 64 * MAX_POINT_LENGTH> buffer{};
+    size_t len = 0;
+    for (auto pointIter = points.begin(); pointIter != points.end(); ++pointIter) {
+        if (len + MAX_POINT_LENGTH > buffer.size()) {
+            this->out->write(buffer.data(), len);
+            len = 0;
+        }
+        if (pointIter != points.begin()) {
+            buffer[len++] = ' ';
+        }
+        len += Util::formatDouble(buffer.data() + len, pointIter->x);
+        buffer[len++] = ' ';
+        len += Util::formatDouble(buffer.data() + len, pointIter->y);
+    }
+    this->out->write(buffer.data(), len);
+}
+
+void XmlStreamWriter::writeText(const std::string& text) {
+    beginContent();
+    writeEscaped(text, false);
+}
+
+/// Input bytes encoded at once by writeBase64Chunk()
+constexpr size_t BASE64_CHUNK_SIZE = 3 * 1024;
+/// Maximal output of g_base64_encode_step() for BASE64_CHUNK_SIZE bytes, without line breaks
+constexpr size_t BASE64_ENCODED_CHUNK_SIZE = (BASE64_CHUNK_SIZE / 3 + 1) * 4 + 4;
+
+void XmlStreamWriter::writeBase64Chunk(const unsigned char* data, size_t length) {
+    std::array<char, BASE64_ENCODED_CHUNK_SIZE> encoded{};
+    for (size_t pos = 0; pos < length; pos += BASE64_CHUNK_SIZE) {
+        size_t chunkLength = std::min(BASE64_CHUNK_SIZE, length - pos);
+        size_t encodedLength = g_base64_encode_step(data + pos, chunkLength, false, encoded.data(),
+                                                    &this->base64State, &this->base64Save);
+        if (encodedLength > 0) {
+            this->out->write(encoded.data(), encodedLength);
+        }
+    }
+}
+
+void XmlStreamWriter::endBase64() {
+    std::array<char, 5> encoded{};
+    size_t encodedLength = g_base64_encode_close(false, encoded.data(), &this->base64State, &this->base64Save);
+    if (encodedLength > 0) {
+        this->out->write(encoded.data(), encodedLength);
+    }
+    this->base64State = 0;
+    this->base64Save = 0;
+}
+
+void XmlStreamWriter::writeBase64(const char* data, size_t length) {
+    beginContent();
+    writeBase64Chunk(reinterpret_cast<const unsigned char*>(data), length);
+    endBase64();
+}
+
+auto XmlStreamWriter::pngWriteFunction(XmlStreamWriter* writer, const unsigned char* data, unsigned int length)
+        -> cairo_status_t {
+    writer->writeBase64Chunk(data, length);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+void XmlStreamWriter::writePng(cairo_surface_t* img) {
+    beginContent();
+
+    if (img == nullptr) {
+        g_warning("XmlStreamWriter::writePng(): img == nullptr");
+        return;
+    }
+
+    cairo_surface_write_to_png_stream(img, reinterpret_cast<cairo_write_func_t>(&pngWriteFunction), this);
+    endBase64();
+}
+
+void XmlStreamWriter::writeRaw(const char* str) { this->out->write(str); }
+
+void XmlStreamWriter::writeDouble(double value) {
+    char str[Util::FORMAT_DOUBLE_BUF_SIZE];
+    // formatDouble always uses the C locale
+    this->out->write(str, Util::formatDouble(str, value));
+}
+
+void XmlStreamWriter::writeEscaped(const std::string& str, bool attribute) {
+    // Write the unescaped runs directly, without copying the string
+    size_t runStart = 0;
+    for (size_t i = 0; i < str.size(); i++) {
+        const char* replacement = nullptr;
+        switch (str[i]) {
+            case '&':
+                replacement = "&amp;";
+                break;
+            case '<':
+                replacement = "&lt;";
+                break;
+            case '>':
+                replacement = "&gt;";
+                break;
+            case '\"':
+                replacement = attribute ? "&quot;" : nullptr;
+                break;
+            case '\n':
+                replacement = attribute ? "&#13;" : nullptr;
+                break;
+            default:
+                break;
+        }
+
+        if (replacement) {
+            this->out->write(str.data() + runStart, i - runStart);
+            writeRaw(replacement);
+            runStart = i + 1;
+        }
+    }
+    this->out->write(str.data() + runStart, str.size() - runStart);
+}
@@ -0,0 +1,134 @@
+/*
+ * Xournal++
+ *
+ * XML Writer writing directly to an output stream
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <string>   // for string
+#include <vector>   // for vector
+
+#include <cairo.h>  // for cairo_surface_t, cairo_status_t
+
+class OutputStream;
+class Point;
+class StrokePoints;
+
+/**
+ * @brief Writes XML directly to an OutputStream, without building a tree first.
+ *
+ * The produced output is the same as the one of the former XmlNode classes (kept by the tests as reference): elements
+ * are written with
+ *      startElement(); setAttrib()...; [child elements | one content call]; endElement();
+ * Attributes must be set before any child element or content is written.
+ */
+class XmlStreamWriter {
+public:
+    explicit XmlStreamWriter(OutputStream* out);
+    XmlStreamWriter(const XmlStreamWriter&) = delete;
+    XmlStreamWriter& operator=(const XmlStreamWriter&) = delete;
+    ~XmlStreamWriter();
+
+public:
+    void startElement(const char* tag);
+    void endElement();
+
+    /**
+     * Write a complete element, already serialized by another XmlStreamWriter, as child of the current element
+     */
+    void writeSerializedElement(const std::string& xml);
+
+    void setAttrib(const char* attrib, const std::string& value);
+    void setAttrib(const char* attrib, const char* value);
+    void setAttrib(const char* attrib, double value);
+    void setAttrib(const char* attrib, int value);
+    void setAttrib(const char* attrib, size_t value);
+
+    /**
+     * Write an attribute holding `count` space separated doubles. The i-th value is given by `valueAt(i)`.
+     * This avoids copying the values into a temporary array.
+     */
+    template <typename Fun>
+    void setDoubleListAttrib(const char* attrib, size_t count, Fun&& valueAt) {
+        beginAttrib(attrib);
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) {
+                writeRaw(" ");
+            }
+            writeDouble(valueAt(i));
+        }
+        endAttrib();
+    }
+
+    /**
+     * Write the coordinates of the points as content of the current element
+     */
+    void writePoints(const std::vector<Point>& points);
+    void writePoints(const StrokePoints& points);
+
+    /**
+     * Write escaped text as content of the current element
+     */
+    void writeText(const std::string& text);
+
+    /**
+     * Write base64 encoded binary data as content of the current element. The data is encoded on the fly, without
+     * building the whole encoded string.
+     */
+    void writeBase64(const char* data, size_t length);
+
+    /**
+     * Write the image, PNG and base64 encoded, as content of the current element
+     */
+    void writePng(cairo_surface_t* img);
+
+private:
+    enum class ElementState {
+        /// The start tag is not closed yet: attributes can still be added
+        OPEN,
+        /// Child elements have been written
+        CHILDREN,
+        /// Text content has been written
+        CONTENT
+    };
+
+    struct Frame {
+        std::string tag;
+        ElementState state;
+    };
+
+    void beginChild();
+    void beginAttrib(const char* attrib);
+    void endAttrib();
+    void beginContent();
+
+    /// Write the x and y members of the elements of a vector as content
+    template <typename Coordinates>
+    void writeCoordinates(const Coordinates& points);
+
+    /// Streaming base64 encoding, see g_base64_encode_step(): the data can be passed in chunks of any size
+    void writeBase64Chunk(const unsigned char* data, size_t length);
+    void endBase64();
+
+    void writeRaw(const char* str);
+    void writeDouble(double value);
+    void writeEscaped(const std::string& str, bool attribute);
+
+    static cairo_status_t pngWriteFunction(XmlStreamWriter* writer, const unsigned char* data, unsigned int length);
+
+private:
+    OutputStream* out;
+
+    std::vector<Frame> stack;
+
+    /// State of the base64 encoder between two chunks
+    int base64State = 0;
+    int base64Save = 0;
+};
@@ -1,12 +1,16 @@
 #include "LoadHandler.h"
 
-#include <algorithm>    // for copy
+#include <algorithm>    // for copy, min, remove_if
+#include <atomic>       // for atomic
 #include <cassert>      // for assert
 #include <cmath>        // for isnan
 #include <cstdlib>      // for atoi, size_t
 #include <cstring>      // for strcmp, strlen
-#include <memory>       // for __shared_ptr_access
+#include <map>          // for map
+#include <memory>       // for __shared_ptr_access, make_shared
 #include <regex>        // for regex_search, smatch
+#include <string_view>  // for string_view
+#include <thread>       // for thread
 #include <type_traits>  // for remove_reference<>::type
 #include <utility>      // for move
 
@@ -25,6 +29,7 @@
 #include "model/TexImage.h"                    // for TexImage
 #include "model/Text.h"                        // for Text
 #include "model/XojPage.h"                     // for XojPage
+#include "util/FloatCodec.h"                   // for parseDouble
 #include "util/GzUtil.h"                       // for GzUtil
 #include "util/LoopUtil.h"
 #include "util/PlaceholderString.h"  // for PlaceholderString
@@ -48,6 +53,169 @@ using std::string;
 namespace {
 constexpr size_t MAX_VERSION_LENGTH = 50;
 constexpr size_t MAX_MIMETYPE_LENGTH = 25;
+
+/**
+ * Position of a <page> element in content.xml
+ */
+struct PageSpan {
+    size_t start;    ///< Position of "<page"
+    size_t headEnd;  ///< Position of the first "<layer" of the page, or bodyEnd if there is none
+    size_t bodyEnd;  ///< Position of "</page>"
+    size_t end;      ///< Position just after "</page>"
+};
+
+auto isBlank(const std::string& content, size_t begin, size_t end) -> bool {
+    for (size_t i = begin; i < end; i++) {
+        if (!g_ascii_isspace(content[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @return The position of the '>' closing the tag in which pos lies, skipping the attribute values, or end
+ */
+auto findTagEnd(const std::string& content, size_t pos, size_t end) -> size_t {
+    char quote = 0;
+    for (; pos < end; pos++) {
+        char c = content[pos];
+        if (quote) {
+            quote = c == quote ? 0 : quote;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '>') {
+            break;
+        }
+    }
+    return pos;
+}
+
+/**
+ * Find the <page> elements of content.xml, without parsing it.
+ *
+ * @return The pages, or nothing if the content does not have the simple structure written by SaveHandler (in which
+ *         case it must be parsed sequentially)
+ */
+auto findPages(const std::string& content) -> std::optional<std::vector<PageSpan>> {
+    constexpr std::string_view PAGE_START = "<page";
+    constexpr std::string_view PAGE_END = "</page>";
+
+    // Comments and CDATA sections may contain anything
+    if (content.find("<!--") != std::string::npos || content.find("<![CDATA[") != std::string::npos) {
+        return std::nullopt;
+    }
+
+    std::vector<PageSpan> pages;
+    size_t pos = content.find(PAGE_START);
+    while (pos != std::string::npos) {
+        PageSpan span{};
+        span.start = pos;
+
+        size_t tagEnd = pos + PAGE_START.size();
+        if (tagEnd >= content.size() || (content[tagEnd] != '>' && !g_ascii_isspace(content[tagEnd]))) {
+            // Another tag starting with "<page"
+            return std::nullopt;
+        }
+
+        tagEnd = findTagEnd(content, tagEnd, content.size());
+        if (tagEnd == content.size() || content[tagEnd - 1] == '/') {
+            return std::nullopt;
+        }
+        tagEnd++;
+
+        span.bodyEnd = content.find(PAGE_END, tagEnd);
+        if (span.bodyEnd == std::string::npos) {
+            return std::nullopt;
+        }
+        span.end = span.bodyEnd + PAGE_END.size();
+
+        // The backgrounds must be parsed before the layers, by the main handler
+        span.headEnd = std::min(content.find("<layer", tagEnd), span.bodyEnd);
+        if (content.find("<background", span.headEnd) < span.bodyEnd) {
+            return std::nullopt;
+        }
+
+        if (content.find(PAGE_START, tagEnd) < span.bodyEnd) {
+            // Unbalanced page tags
+            return std::nullopt;
+        }
+
+        pos = content.find(PAGE_START, span.end);
+        if (pos != std::string::npos && !isBlank(content, span.end, pos)) {
+            // Something else than a page lies between two pages
+            return std::nullopt;
+        }
+
+        pages.push_back(span);
+    }
+
+    return pages;
+}
+
+void readAttachmentPath(GMarkupParseContext*, const gchar*, const gchar** names, const gchar** values, gpointer path,
+                        GError**) {
+    for (; *names; names++, values++) {
+        if (strcmp(*names, "path") == 0) {
+            *static_cast<std::string*>(path) = *values;
+        }
+    }
+}
+
+struct AttachmentSpan {
+    size_t start;  ///< Position of "<attachment"
+    size_t end;    ///< Position just after the element
+    std::string path;
+};
+
+/**
+ * Find the next <attachment> element of content in [begin, end), without parsing the rest of the content. Characters
+ * '<' cannot appear unescaped in the text or in the attribute values, so any "<attachment" is the start of a tag.
+ *
+ * @return The element, or nothing if there is none (or if it is malformed)
+ */
+auto findAttachment(const std::string& content, size_t begin, size_t end) -> std::optional<AttachmentSpan> {
+    constexpr std::string_view ATTACHMENT_START = "<attachment";
+    constexpr std::string_view ATTACHMENT_END = "</attachment>";
+
+    for (size_t pos = content.find(ATTACHMENT_START, begin); pos < end;
+         pos = content.find(ATTACHMENT_START, pos + 1)) {
+        size_t tagEnd = pos + ATTACHMENT_START.size();
+        if (tagEnd < end && content[tagEnd] != '/' && content[tagEnd] != '>' && !g_ascii_isspace(content[tagEnd])) {
+            // Another tag starting with "<attachment"
+            continue;
+        }
+        tagEnd = findTagEnd(content, tagEnd, end);
+        if (tagEnd == end) {
+            return std::nullopt;
+        }
+
+        // Let GMarkup read the path: it may contain entities
+        std::string element = content.substr(pos, tagEnd + 1 - pos);
+        AttachmentSpan span{pos, tagEnd + 1, {}};
+        if (content[tagEnd - 1] != '/') {
+            span.end = content.find(ATTACHMENT_END, span.end);
+            if (span.end >= end) {
+                return std::nullopt;
+            }
+            span.end += ATTACHMENT_END.size();
+            element += ATTACHMENT_END;
+        }
+
+        const GMarkupParser parser = {readAttachmentPath, nullptr, nullptr, nullptr, nullptr};
+        GMarkupParseContext* context =
+                g_markup_parse_context_new(&parser, static_cast<GMarkupParseFlags>(0), &span.path, nullptr);
+        bool valid = g_markup_parse_context_parse(context, element.data(), static_cast<gssize>(element.size()),
+                                                  nullptr) &&
+                     g_markup_parse_context_end_parse(context, nullptr);
+        g_markup_parse_context_free(context);
+        if (!valid || span.path.empty()) {
+            return std::nullopt;
+        }
+        return span;
+    }
+    return std::nullopt;
+}
 }  // namespace
 
 LoadHandler::LoadHandler():
@@ -190,6 +358,7 @@ auto LoadHandler::closeFile() -> bool {
     g_assert(this->zipContentFile != nullptr);
     zip_fclose(this->zipContentFile);
     int zipError = zip_close(this->zipFp);
+    this->zipFp = nullptr;
     return zipError == 0;
 }
 
@@ -223,20 +392,11 @@ auto LoadHandler::parseXml() -> bool {
     GMarkupParseContext* context =
             g_markup_parse_context_new(&parser, static_cast<GMarkupParseFlags>(0), this, nullptr);
 
-    zip_int64_t len = 0;
-    do {
-        char buffer[1024];
-        len = readContentFile(buffer, sizeof(buffer));
-        if (len > 0) {
-            valid = g_markup_parse_context_parse(context, buffer, len, &error);
-        }
-
-        if (error) {
-            g_warning("LoadHandler::parseXml: %s\n", error->message);
-            valid = false;
-            break;
-        }
-    } while (len >= 0 && valid && !error);
+    valid = parseContent(context, std::make_shared<const std::string>(readContent()));
+    if (error) {
+        g_warning("LoadHandler::parseXml: %s\n", error->message);
+        valid = false;
+    }
 
     if (valid) {
         valid = g_markup_parse_context_end_parse(context, &error);
@@ -269,6 +429,346 @@ auto LoadHandler::parseXml() -> bool {
     return valid;
 }
 
+auto LoadHandler::readContent() -> std::string {
+    constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    std::string content;
+    zip_stat_t contentStat;
+    if (!this->isGzFile && zip_stat(this->zipFp, "content.xml", 0, &contentStat) == 0 &&
+        (contentStat.valid & ZIP_STAT_SIZE)) {
+        content.reserve(contentStat.size + CHUNK_SIZE);
+    }
+
+    size_t length = 0;
+    while (true) {
+        content.resize(length + CHUNK_SIZE);
+        zip_int64_t read = readContentFile(content.data() + length, CHUNK_SIZE);
+        if (read <= 0) {
+            break;
+        }
+        length += static_cast<size_t>(read);
+    }
+    content.resize(length);
+
+    return content;
+}
+
+auto LoadHandler::parseContent(GMarkupParseContext* context, std::shared_ptr<const std::string> content) -> bool {
+    auto feed = [&](const char* data, size_t length) -> bool {
+        return length == 0 || g_markup_parse_context_parse(context, data, static_cast<gssize>(length), &error);
+    };
+
+    const size_t threadCount = std::thread::hardware_concurrency();
+    const auto spans = findPages(*content);
+    if (!spans || spans->empty() || (!this->lazyLoading && (spans->size() < 2 || threadCount < 2))) {
+        return feed(content->data(), content->size());
+    }
+
+    const char* data = content->data();
+    if (!feed(data, spans->front().start)) {
+        return false;
+    }
+
+    // Parse the page tags and backgrounds here: the backgrounds may load the PDF and refer to the previous pages
+    std::vector<PageRef> spanPages;
+    spanPages.reserve(spans->size());
+    this->pageLayersDeferred = true;
+    for (const PageSpan& span: *spans) {
+        size_t pageCount = this->pages.size();
+        if (!feed(data + span.start, span.headEnd - span.start) || !feed("</page>", strlen("</page>")) ||
+            this->pos != PARSER_POS_STARTED || this->pages.size() != pageCount + 1) {
+            this->pageLayersDeferred = false;
+            error("%s", _("Could not parse the page headers"));
+            return false;
+        }
+        spanPages.push_back(this->pages.back());
+    }
+    this->pageLayersDeferred = false;
+
+    if (this->lazyLoading) {
+        // Only keep the layers of each page, as they are in the file
+        auto source = std::make_shared<const LazyContent>(*this);
+        std::map<std::string, std::shared_ptr<const std::string>> attachments;
+        for (size_t i = 0; i < spans->size(); i++) {
+            auto page = std::make_shared<LazyPage>(*this, source, *content, (*spans)[i], attachments);
+            spanPages[i]->setLayerLoader([page]() { return loadPageLayers(*page); },
+                                         [page]() { return serializePageLayers(*page); });
+        }
+        return feed(data + spans->back().end, content->size() - spans->back().end);
+    }
+
+    std::vector<std::unique_ptr<LoadHandler>> workers;
+    workers.reserve(spanPages.size());
+    for (PageRef& p: spanPages) {
+        auto& worker = workers.emplace_back(std::make_unique<LoadHandler>());
+        worker->initPageWorker(*this, std::move(p));
+    }
+
+    // Parse the layers of the pages in parallel
+    std::atomic<size_t> nextPage{0};
+    auto work = [&]() {
+        for (size_t i = nextPage++; i < workers.size(); i = nextPage++) {
+            const PageSpan& span = (*spans)[i];
+            workers[i]->parsePageLayers(data + span.headEnd, span.bodyEnd - span.headEnd);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(threadCount, workers.size()); i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& t: threads) {
+        t.join();
+    }
+
+    for (auto& worker: workers) {
+        if (!worker->lastError.empty()) {
+            error("%s", worker->lastError.c_str());
+            return false;
+        }
+        loadDeferredData(*worker);
+        if (error) {
+            return false;
+        }
+    }
+
+    return feed(data + spans->back().end, content->size() - spans->back().end);
+}
+
+struct LoadHandler::LazyContent {
+    explicit LazyContent(const LoadHandler& handler):
+            filepath(handler.filepath),
+            isGzFile(handler.isGzFile),
+            fileVersion(handler.fileVersion),
+            endRootTag(handler.endRootTag),
+            audioFiles(g_hash_table_ref(handler.audioFiles)),
+            onPageError(handler.pageErrorHandler) {}
+
+    ~LazyContent() { g_hash_table_unref(this->audioFiles); }
+
+    LazyContent(const LazyContent&) = delete;
+    LazyContent& operator=(const LazyContent&) = delete;
+
+    fs::path filepath;
+    bool isGzFile;
+    int fileVersion;
+    const char* endRootTag;
+    GHashTable* audioFiles;
+    PageErrorHandler onPageError;
+};
+
+struct LoadHandler::LazyPage {
+    /**
+     * @param attachments The attachments already read for the previous pages, shared with this page if it refers to
+     *                    them too
+     */
+    LazyPage(LoadHandler& handler, std::shared_ptr<const LazyContent> source, const std::string& content,
+             const PageSpan& span, std::map<std::string, std::shared_ptr<const std::string>>& attachments):
+            source(std::move(source)), xml(content, span.headEnd, span.bodyEnd - span.headEnd) {
+        if (this->source->isGzFile) {
+            return;
+        }
+
+        // Read the attachments of the page now: no handle on the archive may stay open once the document is loaded,
+        // since the file is renamed or overwritten when the document is saved
+        for (auto attachment = findAttachment(this->xml, 0, this->xml.size()); attachment;
+             attachment = findAttachment(this->xml, attachment->end, this->xml.size())) {
+            auto& data = attachments[attachment->path];
+            if (!data) {
+                auto read = handler.readZipAttachment(fs::u8path(attachment->path));
+                if (handler.error) {
+                    // The page will report the missing attachment when it is loaded
+                    g_error_free(handler.error);
+                    handler.error = nullptr;
+                }
+                data = read ? std::make_shared<const std::string>(std::move(*read)) : nullptr;
+            }
+            if (data) {
+                this->attachments.emplace(attachment->path, data);
+            }
+        }
+    }
+
+    std::shared_ptr<const LazyContent> source;
+
+    /// The layers of the page, as they are in the file
+    std::string xml;
+
+    /// The data of the attachments the page refers to, by path (the missing ones are left out)
+    std::map<std::string, std::shared_ptr<const std::string>> attachments;
+};
+
+auto LoadHandler::loadPageLayers(LazyPage& lazyPage) -> XojPage::LoadedLayers {
+    const LazyContent& source = *lazyPage.source;
+    auto page = std::make_shared<XojPage>(0, 0, /*suppressLayer*/ true);
+
+    LoadHandler handler;
+    handler.initPageWorker(source, page);
+    std::vector<std::string> errors;
+    if (!handler.parsePageLayers(lazyPage.xml.data(), lazyPage.xml.size())) {
+        errors.push_back(handler.lastError);
+    }
+
+    auto& deferredData = handler.deferredData;
+    auto missing = std::remove_if(deferredData.begin(), deferredData.end(), [&](DeferredData& deferred) {
+        if (deferred.attachment.empty()) {
+            return false;
+        }
+        auto it = lazyPage.attachments.find(deferred.attachment.u8string());
+        if (it == lazyPage.attachments.end()) {
+            errors.push_back(FS(_F("Could not load the attachment \"{1}\"") % deferred.attachment.u8string()));
+            return true;
+        }
+        // The data may be shared with other pages
+        deferred.data = *it->second;
+        deferred.attachment.clear();
+        return false;
+    });
+    deferredData.erase(missing, deferredData.end());
+    handler.loadDeferredData(handler);
+
+    if (page->layer.empty()) {
+        // The page could not be parsed at all
+        page->layer.push_back(new Layer());
+    }
+
+    XojPage::LoadedLayers loaded;
+    std::swap(loaded.layers, page->layer);
+    loaded.complete = errors.empty();
+    if (!loaded.complete) {
+        // The page is kept as it is in the file if it can be: what could be parsed must not overwrite it when saving
+        std::string message = FS(_F("A page of \"{1}\" could not be loaded completely:") % source.filepath.u8string());
+        for (const std::string& e: errors) {
+            message += "\n" + e;
+        }
+        message += "\n\n";
+        message += serializePageLayers(lazyPage) ?
+                           _("The page is kept as it is in the file: the changes made to it will not be saved.") :
+                           _("Saving the document only saves what could be loaded of this page.");
+        g_warning("LoadHandler: %s", message.c_str());
+        if (source.onPageError) {
+            source.onPageError(message);
+        }
+    }
+    return loaded;
+}
+
+auto LoadHandler::serializePageLayers(const LazyPage& lazyPage) -> std::optional<std::string> {
+    const LazyContent& source = *lazyPage.source;
+    const std::string& content = lazyPage.xml;
+    if (source.fileVersion < 4 || isBlank(content, 0, content.size())) {
+        // The timestamps of the older versions are converted when the strokes are parsed, and a page needs a layer
+        return std::nullopt;
+    }
+    if (source.isGzFile) {
+        return content;
+    }
+
+    if (content.find("fn=") != std::string::npos) {
+        // The audio files of an archive are extracted when the strokes are parsed
+        return std::nullopt;
+    }
+
+    // The data of the attachments is written in place of the attachment elements, as for a page saved by SaveHandler
+    std::string xml;
+    xml.reserve(content.size());
+    size_t pos = 0;
+    for (auto attachment = findAttachment(content, 0, content.size()); attachment;
+         attachment = findAttachment(content, attachment->end, content.size())) {
+        xml.append(content, pos, attachment->start - pos);
+        auto it = lazyPage.attachments.find(attachment->path);
+        if (it == lazyPage.attachments.end()) {
+            return std::nullopt;
+        }
+        gchar* base64 = g_base64_encode(reinterpret_cast<const guchar*>(it->second->data()), it->second->size());
+        xml += base64;
+        g_free(base64);
+        pos = attachment->end;
+    }
+    if (content.find("<attachment", pos) != std::string::npos) {
+        // Malformed attachment
+        return std::nullopt;
+    }
+    xml.append(content, pos, std::string::npos);
+    return xml;
+}
+
+void LoadHandler::initPageWorker(const LoadHandler& parent, PageRef p) {
+    this->filepath = parent.filepath;
+    this->isGzFile = parent.isGzFile;
+    this->fileVersion = parent.fileVersion;
+    this->endRootTag = parent.endRootTag;
+
+    // The audio files are only read by the workers
+    g_hash_table_unref(this->audioFiles);
+    this->audioFiles = g_hash_table_ref(parent.audioFiles);
+
+    this->workerPage = std::move(p);
+}
+
+void LoadHandler::initPageWorker(const LazyContent& source, PageRef p) {
+    this->filepath = source.filepath;
+    this->isGzFile = source.isGzFile;
+    this->fileVersion = source.fileVersion;
+    this->endRootTag = source.endRootTag;
+
+    g_hash_table_unref(this->audioFiles);
+    this->audioFiles = g_hash_table_ref(source.audioFiles);
+
+    this->workerPage = std::move(p);
+}
+
+auto LoadHandler::parsePageLayers(const char* data, size_t length) -> bool {
+    const GMarkupParser parser = {LoadHandler::parserStartElement, LoadHandler::parserEndElement,
+                                  LoadHandler::parserText, nullptr, nullptr};
+    this->error = nullptr;
+    this->pos = PARSER_POS_STARTED;
+
+    GMarkupParseContext* context =
+            g_markup_parse_context_new(&parser, static_cast<GMarkupParseFlags>(0), this, nullptr);
+
+    bool valid = g_markup_parse_context_parse(context, "<page>", -1, &error) &&
+                 (length == 0 || g_markup_parse_context_parse(context, data, static_cast<gssize>(length), &error)) &&
+                 g_markup_parse_context_parse(context, "</page>", -1, &error) &&
+                 g_markup_parse_context_end_parse(context, &error);
+
+    g_markup_parse_context_free(context);
+
+    if (error) {
+        this->lastError = error->message;
+        g_error_free(error);
+        this->error = nullptr;
+        valid = false;
+    } else if (!valid) {
+        this->lastError = _("Unknown parser error");
+    }
+    return valid;
+}
+
+void LoadHandler::loadDeferredData(LoadHandler& worker) {
+    for (DeferredData& deferred: worker.deferredData) {
+        std::string bytes = std::move(deferred.data);
+        if (!deferred.attachment.empty()) {
+            auto readResult = readZipAttachment(deferred.attachment);
+            if (!readResult) {
+                return;
+            }
+            bytes = std::move(*readResult);
+        }
+
+        if (auto* img = dynamic_cast<TexImage*>(deferred.element)) {
+            img->loadData(std::move(bytes), nullptr);
+        } else if (auto* img = dynamic_cast<Image*>(deferred.element)) {
+            img->setImage(std::move(bytes));
+        }
+    }
+    worker.deferredData.clear();
+}
+
+auto LoadHandler::isDeferred(const Element* element) const -> bool {
+    return !this->deferredData.empty() && this->deferredData.back().element == element;
+}
+
 void LoadHandler::parseStart() {
     if (strcmp(elementName, "xournal") == 0) {
         endRootTag = "xournal";
@@ -313,6 +813,12 @@ void LoadHandler::parseContents() {
     if (strcmp(elementName, "page") == 0) {
         this->pos = PARSER_POS_IN_PAGE;
 
+        if (this->workerPage) {
+            // The page and its background have already been parsed by the main handler
+            this->page = this->workerPage;
+            return;
+        }
+
         double width = LoadHandlerHelper::getAttribDouble("width", this);
         double height = LoadHandlerHelper::getAttribDouble("height", this);
 
@@ -550,7 +1056,7 @@ void LoadHandler::parseStroke() {
     const char* width = LoadHandlerHelper::getAttrib("width", false, this);
 
     char* endPtr = nullptr;
-    stroke->setWidth(g_ascii_strtod(width, &endPtr));
+    stroke->setWidth(Util::parseDouble(width, &endPtr));
     if (endPtr == width) {
         error("%s", FC(_F("Error reading width of a stroke: {1}") % width));
         return;
@@ -565,7 +1071,7 @@ void LoadHandler::parseStroke() {
 
     while (*pressure != 0) {
         char* tmpptr = nullptr;
-        double val = g_ascii_strtod(pressure, &tmpptr);
+        double val = Util::parseDouble(pressure, &tmpptr);
         if (tmpptr == pressure) {
             break;
         }
@@ -737,6 +1243,13 @@ void LoadHandler::parseAttachment() {
     }
     const char* path = LoadHandlerHelper::getAttrib("path", false, this);
 
+    if (this->workerPage) {
+        // The zip archive cannot be read concurrently: the attachment is read by the main handler
+        Element* element = this->pos == PARSER_POS_IN_IMAGE ? static_cast<Element*>(this->image) : this->teximage;
+        this->deferredData.push_back({element, fs::u8path(path), {}});
+        return;
+    }
+
     auto readResult = readZipAttachment(path);
     if (!readResult) {
         return;
@@ -899,7 +1412,7 @@ void LoadHandler::parserEndElement(GMarkupParseContext* context, const gchar* el
         handler->pos = PASER_POS_FINISHED;
     } else if (handler->pos == PARSER_POS_IN_PAGE && strcmp(elementName, "page") == 0) {
         // handle unnecessary layer insertion in case of existing layers in file
-        if (handler->page->getLayerCount() == 0) {
+        if (!handler->pageLayersDeferred && handler->page->getLayerCount() == 0) {
             handler->page->addLayer(new Layer());
         }
         handler->pos = PARSER_POS_STARTED;
@@ -918,7 +1431,8 @@ void LoadHandler::parserEndElement(GMarkupParseContext* context, const gchar* el
         handler->pos = PARSER_POS_IN_LAYER;
         handler->text = nullptr;
     } else if (handler->pos == PARSER_POS_IN_IMAGE && strcmp(elementName, "image") == 0) {
-        g_assert(handler->image->getImage() != nullptr && "image can't be rendered");
+        // The image is only decoded when it is drawn
+        g_assert((handler->isDeferred(handler->image) || handler->image->hasData()) && "image has no data");
         handler->pos = PARSER_POS_IN_LAYER;
         handler->image = nullptr;
     } else if (handler->pos == PARSER_POS_IN_TEXIMAGE && strcmp(elementName, "teximage") == 0) {
@@ -1011,7 +1525,7 @@ void LoadHandler::parserText(GMarkupParseContext* context, const gchar* text, gs
         double x = 0;
 
         while (textLen > 0) {
-            double tmp = g_ascii_strtod(text, const_cast<char**>(&ptr));
+            double tmp = Util::parseDouble(text, const_cast<char**>(&ptr));
             if (ptr == text) {
                 break;
             }
@@ -1080,7 +1594,8 @@ auto LoadHandler::parseBase64(const gchar* base64, gsize length) -> string {
 
 void LoadHandler::readImage(const gchar* base64string, gsize base64stringLen) {
     g_assert(this->image != nullptr);
-    if (base64stringLen == 0 || (base64stringLen == 1 && base64string[0] == '\n') || this->image->hasData()) {
+    if (base64stringLen == 0 || (base64stringLen == 1 && base64string[0] == '\n') || this->image->hasData() ||
+        isDeferred(this->image)) {
         return;
     }
 
@@ -1092,6 +1607,12 @@ void LoadHandler::readTexImage(const gchar* base64string, gsize base64stringLen)
         return;
     }
 
+    if (this->workerPage) {
+        // The PDF of the image is loaded by the main handler
+        this->deferredData.push_back({this->teximage, {}, parseBase64(base64string, base64stringLen)});
+        return;
+    }
+
     this->teximage->loadData(parseBase64(const_cast<char*>(base64string), base64stringLen));
 }
 
@@ -1185,3 +1706,8 @@ auto LoadHandler::getTempFileForPath(fs::path const& filename) -> fs::path {
 }
 
 auto LoadHandler::getFileVersion() const -> int { return this->fileVersion; }
+
+void LoadHandler::setLazyLoading(bool lazy, PageErrorHandler onPageError) {
+    this->lazyLoading = lazy;
+    this->pageErrorHandler = std::move(onPageError);
+}
@@ -11,10 +11,12 @@
 
 #pragma once
 
-#include <cstddef>   // for size_t
-#include <optional>  // for optional
-#include <string>    // for string
-#include <vector>    // for vector
+#include <cstddef>     // for size_t
+#include <functional>  // for function
+#include <memory>      // for shared_ptr
+#include <optional>    // for optional
+#include <string>      // for string
+#include <vector>      // for vector
 
 #include <glib.h>     // for gchar, GError, gsize, GMarkupPars...
 #include <zip.h>      // for zip_file_t, zip_t
@@ -24,11 +26,13 @@
 #include "model/Document.h"         // for Document
 #include "model/DocumentHandler.h"  // for DocumentHandler
 #include "model/PageRef.h"          // for PageRef
+#include "model/XojPage.h"          // for XojPage
 #include "util/Color.h"             // for Color
 
 #include "LoadHandlerHelper.h"
 #include "filesystem.h"  // for path
 
+class Element;
 class Image;
 class Layer;
 class Stroke;
@@ -64,6 +68,23 @@ public:
     /** @return The version of the loaded file */
     int getFileVersion() const;
 
+    /**
+     * Reports an error found while loading the layers of a page lazily. Called on the thread accessing the page.
+     */
+    using PageErrorHandler = std::function<void(const std::string& message)>;
+
+    /**
+     * If enabled, loadDocument() only parses the sizes and backgrounds of the pages. The layers of a page are parsed
+     * the first time they are accessed (when the page is shown, exported, searched...). Until then, the page keeps
+     * its layers as they are in the (decompressed) file, and the data of the attachments they refer to: a page which
+     * is not loaded costs about its size in the file, which is much less than its parsed layers.
+     *
+     * The document cannot be refused anymore at that point: a page which cannot be loaded completely shows what could
+     * be parsed, but is saved as it is in the file (so the changes made to it are not saved). The error is logged and
+     * reported to onPageError.
+     */
+    void setLazyLoading(bool lazy, PageErrorHandler onPageError = nullptr);
+
 private:
     void parseStart();
     void parseContents();
@@ -85,6 +106,61 @@ private:
     bool openFile(fs::path const& filepath);
     bool parseXml();
 
+    /**
+     * Read the whole (decompressed) content of the file
+     */
+    std::string readContent();
+
+    /**
+     * Parse content.xml. If the document has the structure written by SaveHandler, the layers of the pages are parsed
+     * in parallel by other LoadHandlers. Otherwise, the content is parsed sequentially.
+     */
+    bool parseContent(GMarkupParseContext* context, std::shared_ptr<const std::string> content);
+
+    /**
+     * What the lazily loaded pages of a file share: the properties of the file needed to parse their layers later
+     */
+    struct LazyContent;
+
+    /**
+     * The layers of a lazily loaded page as they are in the file, and the attachments they refer to. It is released
+     * once the page is loaded, unless the page could not be loaded completely (it is then saved from it).
+     */
+    struct LazyPage;
+
+    /**
+     * Parse the layers of a lazily loaded page
+     */
+    static XojPage::LoadedLayers loadPageLayers(LazyPage& page);
+
+    /**
+     * Serialize the layers of a lazily loaded page as SaveHandler would write them, without parsing them
+     *
+     * @return The layers, or nothing if they must be parsed to be saved
+     */
+    static std::optional<std::string> serializePageLayers(const LazyPage& page);
+
+    /**
+     * Prepare this handler for parsing the layers of the (already created) page p, on a worker thread
+     */
+    void initPageWorker(const LoadHandler& parent, PageRef p);
+    void initPageWorker(const LazyContent& source, PageRef p);
+
+    /**
+     * Parse the layers of the page given to initPageWorker(). Errors are reported in lastError.
+     */
+    bool parsePageLayers(const char* data, size_t length);
+
+    /**
+     * Set the data whose loading has been deferred by a page worker
+     */
+    void loadDeferredData(LoadHandler& worker);
+
+    /**
+     * @return true if the data of the element, parsed by this page worker, is loaded later by the main handler
+     */
+    bool isDeferred(const Element* element) const;
+
     void fixNullPressureValues();
     static void parserText(GMarkupParseContext* context, const gchar* text, gsize textLen, gpointer userdata,
                            GError** error);
@@ -138,6 +214,30 @@ private:
 
     std::vector<double> pressureBuffer;
 
+    /**
+     * Only set on handlers parsing the layers of a single page on a worker thread: the page to add the layers to
+     */
+    PageRef workerPage;
+
+    /**
+     * The layers of the pages are parsed by page workers: do not add the default layer to empty pages
+     */
+    bool pageLayersDeferred = false;
+
+    bool lazyLoading = false;
+    PageErrorHandler pageErrorHandler;
+
+    /**
+     * Data of the elements parsed by a page worker, which must be loaded on the main thread: zip attachments (the zip
+     * handle cannot be used concurrently) and LaTeX images (loaded with poppler)
+     */
+    struct DeferredData {
+        Element* element;
+        fs::path attachment;
+        std::string data;
+    };
+    std::vector<DeferredData> deferredData;
+
     std::vector<PageRef> pages;
     PageRef page;
     Layer* layer;
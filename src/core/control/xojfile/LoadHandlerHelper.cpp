@@ -18,6 +18,7 @@
 #include <glib.h>  // for g_error_new, G_MARKUP_ERROR, G_M...
 
 #include "util/Color.h"
+#include "util/FloatCodec.h"         // for parseDouble
 #include "util/PlaceholderString.h"  // for PlaceholderString
 #include "util/i18n.h"               // for FC, _F, _
 
@@ -125,7 +126,7 @@ auto LoadHandlerHelper::getAttribDouble(const char* name, LoadHandler* loadHandl
     }
 
     char* ptr = nullptr;
-    double val = g_ascii_strtod(attrib, &ptr);
+    double val = Util::parseDouble(attrib, &ptr);
     if (ptr == attrib) {
         error("%s", FC(_F("Attribute \"{1}\" could not be parsed as double, the value is \"{2}\"") % name % attrib));
     }
@@ -0,0 +1,69 @@
+#include "SaveCache.h"
+
+#include <utility>  // for move
+
+#include <glib.h>  // for g_checksum_new, g_checksum_update, g_checksum_get_string
+
+#include "model/XojPage.h"  // for XojPage
+#include "util/GzUtil.h"    // for GzUtil
+
+namespace {
+auto digestOf(const std::string& xml) -> std::string {
+    GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, reinterpret_cast<const guchar*>(xml.data()), static_cast<gssize>(xml.size()));
+    std::string digest = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+    return digest;
+}
+}  // namespace
+
+auto SaveCache::getPageMember(const PageRef& page, const std::string& xml) -> std::shared_ptr<const std::string> {
+    std::string digest = digestOf(xml);
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->pages.find(page.get());
+        // The page may have been freed, and its address reused
+        if (it != this->pages.end() && it->second.page.lock() == page && it->second.digest == digest) {
+            return it->second.member;
+        }
+    }
+
+    // Compress without holding the mutex
+    auto member = std::make_shared<const std::string>(GzUtil::compress(xml.data(), xml.size()));
+    if (member->empty()) {
+        return member;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->pages[page.get()] = {page, std::move(digest), member};
+    this->compressedPageCount++;
+    return member;
+}
+
+auto SaveCache::isBackgroundWritten(const fs::path& file, GdkPixbuf* image) -> bool {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto it = this->backgrounds.find(file);
+    return it != this->backgrounds.end() && it->second.get() == image && fs::exists(file);
+}
+
+void SaveCache::setBackgroundWritten(const fs::path& file, GdkPixbuf* image) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    // Keep a reference: the address must not be reused by another image
+    this->backgrounds[file].reset(image, xoj::util::ref);
+}
+
+void SaveCache::retainPages(const std::vector<PageRef>& pages) {
+    std::unordered_map<const XojPage*, PageEntry> retained;
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const PageRef& p: pages) {
+        if (auto it = this->pages.find(p.get()); it != this->pages.end()) {
+            retained.insert(this->pages.extract(it));
+        }
+    }
+    std::swap(this->pages, retained);
+}
+
+auto SaveCache::getCompressedPageCount() -> size_t {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->compressedPageCount;
+}
@@ -0,0 +1,76 @@
+/*
+ * Xournal++
+ *
+ * Compressed pages and written attachments of the previous saves
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <map>            // for map
+#include <memory>         // for shared_ptr, weak_ptr
+#include <mutex>          // for mutex
+#include <string>         // for string
+#include <unordered_map>  // for unordered_map
+#include <vector>         // for vector
+
+#include <gdk-pixbuf/gdk-pixbuf.h>  // for GdkPixbuf
+
+#include "model/PageRef.h"          // for PageRef
+#include "util/raii/GObjectSPtr.h"  // for GObjectSPtr
+
+#include "filesystem.h"  // for path
+
+class XojPage;
+
+/**
+ * Lets a save only compress the pages which changed since the previous save, and only write the background images
+ * which are not on the disk yet. Thread safe.
+ *
+ * A page is considered unchanged if it serializes to the same XML: the change events of the model do not cover every
+ * edit (e.g. the elements of a selection return to their layer silently), so they cannot be trusted with the content
+ * of the file. Serializing is cheap compared to the compression.
+ */
+class SaveCache {
+public:
+    SaveCache() = default;
+    SaveCache(const SaveCache&) = delete;
+    SaveCache& operator=(const SaveCache&) = delete;
+
+    /**
+     * @return A gzip member holding the serialized page, which is only compressed if the page changed
+     */
+    std::shared_ptr<const std::string> getPageMember(const PageRef& page, const std::string& xml);
+
+    /**
+     * @return true if the image has already been written to the file (and the file still exists)
+     */
+    bool isBackgroundWritten(const fs::path& file, GdkPixbuf* image);
+    void setBackgroundWritten(const fs::path& file, GdkPixbuf* image);
+
+    /**
+     * Forget the pages which are not in the list (i.e. not in the document anymore)
+     */
+    void retainPages(const std::vector<PageRef>& pages);
+
+    /**
+     * @return The number of pages compressed since the cache was created
+     */
+    size_t getCompressedPageCount();
+
+private:
+    struct PageEntry {
+        std::weak_ptr<XojPage> page;
+        std::string digest;
+        std::shared_ptr<const std::string> member;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<const XojPage*, PageEntry> pages;
+    std::map<fs::path, xoj::util::GObjectSPtr<GdkPixbuf>> backgrounds;
+    size_t compressedPageCount = 0;
+};
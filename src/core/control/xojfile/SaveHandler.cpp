@@ -1,21 +1,24 @@
 #include "SaveHandler.h"
 
-#include <cinttypes>   // for PRIx32
-#include <cstdint>     // for uint32_t
-#include <cstdio>      // for sprintf, size_t
-#include <filesystem>  // for exists
+#include <cinttypes>     // for PRIx32
+#include <cstdint>       // for uint32_t
+#include <cstdio>        // for sprintf, size_t
+#include <filesystem>    // for exists
+#include <memory>        // for shared_ptr
+#include <mutex>         // for defer_lock
+#include <shared_mutex>  // for shared_lock
+#include <string>        // for string, to_string
+#include <utility>       // for move
+#include <vector>        // for vector
 
 #include <cairo.h>                  // for cairo_surface_t
 #include <gdk-pixbuf/gdk-pixbuf.h>  // for gdk_pixbuf_save
-#include <glib.h>                   // for g_free, g_strdup_printf
+#include <glib.h>                   // for g_warning, g_error_free
 
+#include "control/jobs/ProgressListener.h"     // for ProgressListener
 #include "control/pagetype/PageTypeHandler.h"  // for PageTypeHandler
-#include "control/xml/XmlAudioNode.h"          // for XmlAudioNode
-#include "control/xml/XmlImageNode.h"          // for XmlImageNode
-#include "control/xml/XmlNode.h"               // for XmlNode
-#include "control/xml/XmlPointNode.h"          // for XmlPointNode
-#include "control/xml/XmlTexNode.h"            // for XmlTexNode
-#include "control/xml/XmlTextNode.h"           // for XmlTextNode
+#include "control/xml/XmlStreamWriter.h"       // for XmlStreamWriter
+#include "control/xojfile/SaveCache.h"         // for SaveCache
 #include "model/AudioElement.h"                // for AudioElement
 #include "model/BackgroundImage.h"             // for BackgroundImage
 #include "model/Document.h"                    // for Document
@@ -32,7 +35,7 @@
 #include "model/Text.h"                        // for Text
 #include "model/XojPage.h"                     // for XojPage
 #include "pdf/base/XojPdfDocument.h"           // for XojPdfDocument
-#include "util/OutputStream.h"                 // for GzOutputStream, Output...
+#include "util/OutputStream.h"                 // for GzOutputStream, GzMemb...
 #include "util/PathUtil.h"                     // for clearExtensions
 #include "util/PlaceholderString.h"            // for PlaceholderString
 #include "util/i18n.h"                         // for FS, _F
@@ -44,41 +47,110 @@ SaveHandler::SaveHandler() {
     this->attachBgId = 1;
 }
 
-void SaveHandler::prepareSave(Document* doc) {
-    if (this->root) {
-        // cleanup old data
-        backgroundImages.clear();
+void SaveHandler::prepareSave(Document* doc, bool lockDocument) {
+    this->doc = doc;
+    this->lockDocument = lockDocument;
+
+    this->pages.clear();
+    this->pages.reserve(doc->getPageCount());
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        this->pages.push_back(doc->getPage(i));
     }
 
+    this->preview.reset(doc->getPreview(), xoj::util::ref);
+    this->docFilepath = doc->getFilepath();
+    this->pdfFilepath = doc->getPdfFilepath();
+    this->pdfDocument = doc->getPdfDocument();
+    this->attachPdf = doc->isAttachPdf();
+}
+
+void SaveHandler::setCache(SaveCache* cache) { this->cache = cache; }
+
+/**
+ * Locks the document (shared) for the time the pages are read, unless the handler was told not to
+ */
+static auto lockForReading(Document* doc, bool lockDocument) -> std::shared_lock<Document> {
+    return lockDocument ? std::shared_lock<Document>(*doc) : std::shared_lock<Document>(*doc, std::defer_lock);
+}
+
+void SaveHandler::writeDocument(XmlStreamWriter& writer, ProgressListener* listener) {
+    // cleanup old data
+    backgroundImages.clear();
+    backgroundCloneIds.clear();
+    pdfAttachmentPath.clear();
+
     this->firstPdfPageVisited = false;
     this->attachBgId = 1;
 
-    root.reset(new XmlNode("xournal"));
+    if (listener) {
+        // One step for the header, one for the preview and one per page
+        listener->setMaximumState(static_cast<int>(this->pages.size()) + (this->preview ? 2 : 1));
+    }
+    int state = 0;
 
-    writeHeader();
+    writer.startElement("xournal");
+    writeHeader(writer);
+    if (listener) {
+        listener->setCurrentState(++state);
+    }
 
-    cairo_surface_t* preview = doc->getPreview();
-    if (preview) {
-        auto* image = new XmlImageNode("preview");
-        image->setImage(preview);
-        this->root->addChild(image);
+    if (this->preview) {
+        writer.startElement("preview");
+        writer.writePng(this->preview.get());
+        writer.endElement();
+        if (listener) {
+            listener->setCurrentState(++state);
+        }
     }
 
-    for (size_t i = 0; i < doc->getPageCount(); i++) {
-        PageRef p = doc->getPage(i);
-        p->getBackgroundImage().clearSaveState();
+    // All the pages are read under a single lock, so that the file is a consistent snapshot of the document. Each page
+    // is compressed as soon as it is serialized: at most one page is held uncompressed at a time. With a cache, the
+    // unchanged pages are not compressed again, and the compressed pages are only written out once the lock is
+    // released. Without cache, the pages are written to the output stream directly.
+    std::vector<std::shared_ptr<const std::string>> pageMembers;
+    {
+        auto lock = lockForReading(this->doc, this->lockDocument);
+        StringOutputStream pageOut;
+        for (size_t i = 0; i < this->pages.size(); i++) {
+            pageOut.clear();
+            XmlStreamWriter pageWriter(&pageOut);
+            visitPage(pageWriter, this->pages[i], static_cast<int>(i));
+            if (this->members) {
+                pageMembers.push_back(this->cache->getPageMember(this->pages[i], pageOut.getString()));
+            } else {
+                writer.writeSerializedElement(pageOut.getString());
+            }
+            if (listener) {
+                listener->setCurrentState(++state);
+            }
+        }
     }
 
-    for (size_t i = 0; i < doc->getPageCount(); i++) {
-        PageRef p = doc->getPage(i);
-        visitPage(root.get(), p, doc, static_cast<int>(i));
+    for (auto& member: pageMembers) {
+        writeMember(writer, *member);
+        // The cache keeps the members of the pages which are still in the document
+        member.reset();
     }
+
+    writer.endElement();
 }
 
-void SaveHandler::writeHeader() {
-    this->root->setAttrib("creator", PROJECT_STRING);
-    this->root->setAttrib("fileversion", FILE_FORMAT_VERSION);
-    this->root->addChild(new XmlTextNode("title", std::string{"Xournal++ document - see "} + PROJECT_HOMEPAGE_URL));
+void SaveHandler::writeMember(XmlStreamWriter& writer, const std::string& member) {
+    if (member.empty()) {
+        this->errorMessage = _("Error compressing data");
+        return;
+    }
+    // Only close the start tag of the parent in the current member: the page gets its own member
+    writer.writeSerializedElement("");
+    this->members->writeMember(member);
+}
+
+void SaveHandler::writeHeader(XmlStreamWriter& writer) {
+    writer.setAttrib("creator", PROJECT_STRING);
+    writer.setAttrib("fileversion", FILE_FORMAT_VERSION);
+    writer.startElement("title");
+    writer.writeText(std::string{"Xournal++ document - see "} + PROJECT_HOMEPAGE_URL);
+    writer.endElement();
 }
 
 auto SaveHandler::getColorStr(Color c, unsigned char alpha) -> std::string {
@@ -88,138 +160,141 @@ auto SaveHandler::getColorStr(Color c, unsigned char alpha) -> std::string {
     return color;
 }
 
-void SaveHandler::writeTimestamp(AudioElement* audioElement, XmlAudioNode* xmlAudioNode) {
+void SaveHandler::writeTimestamp(AudioElement* audioElement, XmlStreamWriter& writer) {
     if (!audioElement->getAudioFilename().empty()) {
-        /** set stroke timestamp value to the XmlPointNode */
-        xmlAudioNode->setAttrib("ts", audioElement->getTimestamp());
-        xmlAudioNode->setAttrib("fn", audioElement->getAudioFilename().u8string());
+        /** set stroke timestamp value to the element */
+        writer.setAttrib("ts", audioElement->getTimestamp());
+        writer.setAttrib("fn", audioElement->getAudioFilename().u8string());
     }
 }
 
-void SaveHandler::visitStroke(XmlPointNode* stroke, Stroke* s) {
+void SaveHandler::visitStroke(XmlStreamWriter& writer, Stroke* s) {
     StrokeTool t = s->getToolType();
 
     unsigned char alpha = 0xff;
 
     if (t == StrokeTool::PEN) {
-        stroke->setAttrib("tool", "pen");
-        writeTimestamp(s, stroke);
+        writer.setAttrib("tool", "pen");
+        writeTimestamp(s, writer);
     } else if (t == StrokeTool::ERASER) {
-        stroke->setAttrib("tool", "eraser");
+        writer.setAttrib("tool", "eraser");
     } else if (t == StrokeTool::HIGHLIGHTER) {
-        stroke->setAttrib("tool", "highlighter");
+        writer.setAttrib("tool", "highlighter");
         alpha = 0x7f;
     } else {
         g_warning("Unknown StrokeTool::Value");
-        stroke->setAttrib("tool", "pen");
+        writer.setAttrib("tool", "pen");
     }
 
-    stroke->setAttrib("color", getColorStr(s->getColor(), alpha).c_str());
+    writer.setAttrib("color", getColorStr(s->getColor(), alpha).c_str());
 
     const auto& pts = s->getPointVector();
 
-    stroke->setPoints(pts);
-
     if (s->hasPressure()) {
-        std::vector<double> values;
-        values.reserve(pts.size() + 1);
-        values.emplace_back(s->getWidth());
-        std::transform(pts.begin(), pts.end() - 1, std::back_inserter(values), [](const Point& p) { return p.z; });
-        stroke->setAttrib("width", std::move(values));
+        // The stroke width, followed by the pressure of each point but the last one
+        writer.setDoubleListAttrib("width", pts.size(),
+                                   [&](size_t i) { return i == 0 ? s->getWidth() : pts[i - 1].z; });
     } else {
-        stroke->setAttrib("width", s->getWidth());
+        writer.setAttrib("width", s->getWidth());
     }
 
-    visitStrokeExtended(stroke, s);
+    visitStrokeExtended(writer, s);
+
+    writer.writePoints(pts);
 }
 
 /**
  * Export the fill attributes
  */
-void SaveHandler::visitStrokeExtended(XmlPointNode* stroke, Stroke* s) {
+void SaveHandler::visitStrokeExtended(XmlStreamWriter& writer, Stroke* s) {
     if (s->getFill() != -1) {
-        stroke->setAttrib("fill", s->getFill());
+        writer.setAttrib("fill", s->getFill());
     }
 
     const StrokeCapStyle capStyle = s->getStrokeCapStyle();
     if (capStyle == StrokeCapStyle::BUTT) {
-        stroke->setAttrib("capStyle", "butt");
+        writer.setAttrib("capStyle", "butt");
     } else if (capStyle == StrokeCapStyle::ROUND) {
-        stroke->setAttrib("capStyle", "round");
+        writer.setAttrib("capStyle", "round");
     } else if (capStyle == StrokeCapStyle::SQUARE) {
-        stroke->setAttrib("capStyle", "square");
+        writer.setAttrib("capStyle", "square");
     } else {
         g_warning("Unknown stroke cap type: %i", capStyle);
-        stroke->setAttrib("capStyle", "round");
+        writer.setAttrib("capStyle", "round");
     }
 
     if (s->getLineStyle().hasDashes()) {
-        stroke->setAttrib("style", StrokeStyle::formatStyle(s->getLineStyle()));
+        writer.setAttrib("style", StrokeStyle::formatStyle(s->getLineStyle()));
     }
 }
 
-void SaveHandler::visitLayer(XmlNode* page, Layer* l) {
-    auto* layer = new XmlNode("layer");
-    page->addChild(layer);
+void SaveHandler::visitLayer(XmlStreamWriter& writer, Layer* l) {
+    writer.startElement("layer");
     if (l->hasName()) {
-        layer->setAttrib("name", l->getName().c_str());
+        writer.setAttrib("name", l->getName().c_str());
     }
 
     for (Element* e: l->getElements()) {
         if (e->getType() == ELEMENT_STROKE) {
             auto* s = dynamic_cast<Stroke*>(e);
-            auto* stroke = new XmlPointNode("stroke");
-            layer->addChild(stroke);
-            visitStroke(stroke, s);
+            writer.startElement("stroke");
+            visitStroke(writer, s);
+            writer.endElement();
         } else if (e->getType() == ELEMENT_TEXT) {
             Text* t = dynamic_cast<Text*>(e);
-            auto* text = new XmlTextNode("text", t->getText());
-            layer->addChild(text);
+            writer.startElement("text");
 
             XojFont& f = t->getFont();
 
-            text->setAttrib("font", f.getName().c_str());
-            text->setAttrib("size", f.getSize());
-            text->setAttrib("x", t->getX());
-            text->setAttrib("y", t->getY());
-            text->setAttrib("color", getColorStr(t->getColor()).c_str());
+            writer.setAttrib("font", f.getName().c_str());
+            writer.setAttrib("size", f.getSize());
+            writer.setAttrib("x", t->getX());
+            writer.setAttrib("y", t->getY());
+            writer.setAttrib("color", getColorStr(t->getColor()).c_str());
+
+            writeTimestamp(t, writer);
 
-            writeTimestamp(t, text);
+            writer.writeText(t->getText());
+            writer.endElement();
         } else if (e->getType() == ELEMENT_IMAGE) {
             auto* i = dynamic_cast<Image*>(e);
-            auto* image = new XmlImageNode("image");
-            layer->addChild(image);
+            writer.startElement("image");
 
-            image->setImage(i->getImage());
+            writer.setAttrib("left", i->getX());
+            writer.setAttrib("top", i->getY());
+            writer.setAttrib("right", i->getX() + i->getElementWidth());
+            writer.setAttrib("bottom", i->getY() + i->getElementHeight());
 
-            image->setAttrib("left", i->getX());
-            image->setAttrib("top", i->getY());
-            image->setAttrib("right", i->getX() + i->getElementWidth());
-            image->setAttrib("bottom", i->getY() + i->getElementHeight());
+            // The original encoded data (PNG, JPEG...) is written as is: it is neither decoded nor compressed again
+            writer.writeBase64(reinterpret_cast<const char*>(i->getRawData()), i->getRawDataLength());
+            writer.endElement();
         } else if (e->getType() == ELEMENT_TEXIMAGE) {
             auto* i = dynamic_cast<TexImage*>(e);
-            auto* image = new XmlTexNode("teximage", std::string(i->getBinaryData()));
-            layer->addChild(image);
-
-            image->setAttrib("text", i->getText().c_str());
-            image->setAttrib("left", i->getX());
-            image->setAttrib("top", i->getY());
-            image->setAttrib("right", i->getX() + i->getElementWidth());
-            image->setAttrib("bottom", i->getY() + i->getElementHeight());
+            writer.startElement("teximage");
+
+            writer.setAttrib("text", i->getText().c_str());
+            writer.setAttrib("left", i->getX());
+            writer.setAttrib("top", i->getY());
+            writer.setAttrib("right", i->getX() + i->getElementWidth());
+            writer.setAttrib("bottom", i->getY() + i->getElementHeight());
+
+            const std::string& data = i->getBinaryData();
+            writer.writeBase64(data.data(), data.length());
+            writer.endElement();
         }
     }
+
+    writer.endElement();
 }
 
-void SaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
-    auto* page = new XmlNode("page");
-    root->addChild(page);
-    page->setAttrib("width", p->getWidth());
-    page->setAttrib("height", p->getHeight());
+void SaveHandler::visitPage(XmlStreamWriter& writer, PageRef p, int id) {
+    writer.startElement("page");
+    writer.setAttrib("width", p->getWidth());
+    writer.setAttrib("height", p->getHeight());
 
-    auto* background = new XmlNode("background");
-    page->addChild(background);
+    writer.startElement("background");
 
-    writeBackgroundName(background, p);
+    writeBackgroundName(writer, p);
 
     if (p->getBackgroundType().isPdfPage()) {
         /**
@@ -227,79 +302,86 @@ void SaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
          * DO NOT CHANGE THE ORDER OF THE ATTRIBUTES!
          */
 
-        background->setAttrib("type", "pdf");
+        writer.setAttrib("type", "pdf");
         if (!firstPdfPageVisited) {
             firstPdfPageVisited = true;
 
-            if (doc->isAttachPdf()) {
-                background->setAttrib("domain", "attach");
-                auto filepath = doc->getFilepath();
+            if (this->attachPdf) {
+                writer.setAttrib("domain", "attach");
+                auto filepath = this->docFilepath;
                 Util::clearExtensions(filepath);
                 filepath += ".xopp.bg.pdf";
-                background->setAttrib("filename", "bg.pdf");
+                writer.setAttrib("filename", "bg.pdf");
 
-                GError* error = nullptr;
+                // The PDF is copied once the document is written, without lock
                 if (!exists(filepath)) {
-                    doc->getPdfDocument().save(filepath, &error);
-                }
-
-                if (error) {
-                    if (!this->errorMessage.empty()) {
-                        this->errorMessage += "\n";
-                    }
-                    this->errorMessage +=
-                            FS(_F("Could not write background \"{1}\", {2}") % filepath.u8string() % error->message);
-
-                    g_error_free(error);
+                    this->pdfAttachmentPath = filepath;
                 }
             } else {
-                background->setAttrib("domain", "absolute");
-                background->setAttrib("filename", doc->getPdfFilepath().u8string());
+                writer.setAttrib("domain", "absolute");
+                writer.setAttrib("filename", this->pdfFilepath.u8string());
             }
         }
-        background->setAttrib("pageno", p->getPdfPageNr() + 1);
+        writer.setAttrib("pageno", p->getPdfPageNr() + 1);
     } else if (p->getBackgroundType().isImagePage()) {
-        background->setAttrib("type", "pixmap");
-
-        int cloneId = p->getBackgroundImage().getCloneId();
-        if (cloneId != -1) {
-            background->setAttrib("domain", "clone");
-            char* filename = g_strdup_printf("%i", cloneId);
-            background->setAttrib("filename", filename);
-            g_free(filename);
-        } else if (p->getBackgroundImage().isAttached() && p->getBackgroundImage().getPixbuf()) {
-            char* filename = g_strdup_printf("bg_%d.png", this->attachBgId++);
-            background->setAttrib("domain", "attach");
-            background->setAttrib("filename", filename);
-            p->getBackgroundImage().setFilepath(filename);
-
-            backgroundImages.emplace_back(p->getBackgroundImage());
-
-            g_free(filename);
-            p->getBackgroundImage().setCloneId(id);
+        writer.setAttrib("type", "pixmap");
+
+        // The save state is kept in the handler: the document may be saved by several handlers at once
+        const BackgroundImage& img = p->getBackgroundImage();
+        auto cloneId = this->backgroundCloneIds.find(img.getPixbuf());
+        if (cloneId != this->backgroundCloneIds.end()) {
+            writer.setAttrib("domain", "clone");
+            writer.setAttrib("filename", std::to_string(cloneId->second));
+        } else if (img.isAttached() && img.getPixbuf()) {
+            std::string filename = "bg_" + std::to_string(this->attachBgId++) + ".png";
+            writer.setAttrib("domain", "attach");
+            writer.setAttrib("filename", filename);
+
+            backgroundImages.push_back({std::move(filename), img});
+            this->backgroundCloneIds[img.getPixbuf()] = id;
         } else {
-            background->setAttrib("domain", "absolute");
-            background->setAttrib("filename", p->getBackgroundImage().getFilepath().u8string());
-            p->getBackgroundImage().setCloneId(id);
+            writer.setAttrib("domain", "absolute");
+            writer.setAttrib("filename", img.getFilepath().u8string());
+            if (img.getPixbuf()) {
+                this->backgroundCloneIds[img.getPixbuf()] = id;
+            }
         }
     } else {
-        writeSolidBackground(background, p);
+        writeSolidBackground(writer, p);
+    }
+
+    writer.endElement();
+
+    if (writeUnloadedLayers(writer, p)) {
+        writer.endElement();
+        return;
     }
 
     // no layer, but we need to write one layer, else the old Xournal cannot read the file
     if (p->getLayers()->empty()) {
-        auto* layer = new XmlNode("layer");
-        page->addChild(layer);
+        writer.startElement("layer");
+        writer.endElement();
     }
 
     for (Layer* l: *p->getLayers()) {
-        visitLayer(page, l);
+        visitLayer(writer, l);
     }
+
+    writer.endElement();
+}
+
+auto SaveHandler::writeUnloadedLayers(XmlStreamWriter& writer, PageRef p) -> bool {
+    auto layers = p->getUnloadedLayers();
+    if (!layers) {
+        return false;
+    }
+    writer.writeSerializedElement(*layers);
+    return true;
 }
 
-void SaveHandler::writeSolidBackground(XmlNode* background, PageRef p) {
-    background->setAttrib("type", "solid");
-    background->setAttrib("color", getColorStr(p->getBackgroundColor()));
+void SaveHandler::writeSolidBackground(XmlStreamWriter& writer, PageRef p) {
+    writer.setAttrib("type", "solid");
+    writer.setAttrib("color", getColorStr(p->getBackgroundColor()));
 
     if (auto fmt = p->getBackgroundType().format; fmt == PageTypeFormat::Copy) {
         /*
@@ -316,55 +398,93 @@ void SaveHandler::writeSolidBackground(XmlNode* background, PageRef p) {
         this->errorMessage += _("Page type format is PageTypeFormat::Copy - converted to PageTypeFormat::Plain to "
                                 "avoid corrupted file");
 
-        background->setAttrib("style", PageTypeHandler::getStringForPageTypeFormat(PageTypeFormat::Plain));
+        writer.setAttrib("style", PageTypeHandler::getStringForPageTypeFormat(PageTypeFormat::Plain));
     } else {
-        background->setAttrib("style", PageTypeHandler::getStringForPageTypeFormat(fmt));
+        writer.setAttrib("style", PageTypeHandler::getStringForPageTypeFormat(fmt));
     }
 
     // Not compatible with Xournal, so the background needs
     // to be changed to a basic one!
     if (!p->getBackgroundType().config.empty()) {
-        background->setAttrib("config", p->getBackgroundType().config);
+        writer.setAttrib("config", p->getBackgroundType().config);
     }
 }
 
-void SaveHandler::writeBackgroundName(XmlNode* background, PageRef p) {
+void SaveHandler::writeBackgroundName(XmlStreamWriter& writer, PageRef p) {
     if (p->backgroundHasName()) {
-        background->setAttrib("name", p->getBackgroundName());
+        writer.setAttrib("name", p->getBackgroundName());
     }
 }
 
 void SaveHandler::saveTo(const fs::path& filepath, ProgressListener* listener) {
-    GzOutputStream out(filepath);
-
-    if (!out.getLastError().empty()) {
-        this->errorMessage = out.getLastError();
-        return;
-    }
+    auto write = [&](auto& out) {
+        if (!out.getLastError().empty()) {
+            this->errorMessage = out.getLastError();
+            return;
+        }
 
-    saveTo(&out, filepath, listener);
+        saveTo(&out, filepath, listener);
 
-    out.close();
+        out.close();
 
-    if (this->errorMessage.empty()) {
-        this->errorMessage = out.getLastError();
+        if (this->errorMessage.empty()) {
+            this->errorMessage = out.getLastError();
+        }
+    };
+
+    if (this->cache) {
+        GzMemberOutputStream out(filepath);
+        this->members = &out;
+        write(out);
+        this->members = nullptr;
+        this->cache->retainPages(this->pages);
+    } else {
+        GzOutputStream out(filepath);
+        write(out);
     }
 }
 
 void SaveHandler::saveTo(OutputStream* out, const fs::path& filepath, ProgressListener* listener) {
-    // XMLNode should be locale-safe ( store doubles using Locale 'C' format
+    if (this->doc == nullptr) {
+        g_warning("SaveHandler::saveTo() called without prepareSave()");
+        return;
+    }
+
+    // XmlStreamWriter is locale-safe ( store doubles using Locale 'C' format
 
     out->write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
-    root->writeOut(out, listener);
+    XmlStreamWriter writer(out);
+    writeDocument(writer, listener);
 
-    for (BackgroundImage const& img: backgroundImages) {
-        auto tmpfn = (fs::path(filepath) += ".") += img.getFilepath();
+    if (!this->pdfAttachmentPath.empty()) {
+        GError* error = nullptr;
+        this->pdfDocument.save(this->pdfAttachmentPath, &error);
+
+        if (error) {
+            if (!this->errorMessage.empty()) {
+                this->errorMessage += "\n";
+            }
+            this->errorMessage += FS(_F("Could not write background \"{1}\", {2}") %
+                                     this->pdfAttachmentPath.u8string() % error->message);
+
+            g_error_free(error);
+        }
+    }
+
+    for (AttachedImage const& attached: backgroundImages) {
+        const BackgroundImage& img = attached.image;
+        auto tmpfn = (fs::path(filepath) += ".") += attached.filename;
+        if (this->cache && this->cache->isBackgroundWritten(tmpfn, img.getPixbuf())) {
+            continue;
+        }
         if (!gdk_pixbuf_save(img.getPixbuf(), tmpfn.u8string().c_str(), "png", nullptr, nullptr)) {
             if (!this->errorMessage.empty()) {
                 this->errorMessage += "\n";
             }
 
             this->errorMessage += FS(_F("Could not write background \"{1}\". Continuing anyway.") % tmpfn.u8string());
+        } else if (this->cache) {
+            this->cache->setBackgroundWritten(tmpfn, img.getPixbuf());
         }
     }
 }
@@ -11,32 +11,58 @@
 
 #pragma once
 
-#include <memory>  // for unique_ptr
+#include <map>     // for map
 #include <string>  // for string
 #include <vector>  // for vector
 
-#include "control/xml/XmlNode.h"    // for XmlNode
-#include "model/BackgroundImage.h"  // for BackgroundImage
-#include "model/PageRef.h"          // for PageRef
-#include "util/Color.h"             // for Color
+#include <gdk-pixbuf/gdk-pixbuf.h>  // for GdkPixbuf
+
+#include "model/BackgroundImage.h"    // for BackgroundImage
+#include "model/PageRef.h"            // for PageRef
+#include "pdf/base/XojPdfDocument.h"  // for XojPdfDocument
+#include "util/Color.h"               // for Color
+#include "util/raii/CairoWrappers.h"  // for CairoSurfaceSPtr
 
 #include "filesystem.h"  // for path
 
-class XmlPointNode;
 class ProgressListener;
 class AudioElement;
+class GzMemberOutputStream;
+class SaveCache;
 class Document;
 class Layer;
 class OutputStream;
 class Stroke;
-class XmlAudioNode;
+class XmlStreamWriter;
 
 class SaveHandler {
 public:
     SaveHandler();
 
 public:
-    void prepareSave(Document* doc);
+    /**
+     * Prepare the saving of the document: takes a snapshot of the page list and of the document properties, in
+     * O(pages). The document must be locked during this call.
+     *
+     * saveTo() must then be called WITHOUT holding the lock: it locks the document (shared) once, for the time it
+     * serializes the pages, one after the other. The file is a consistent snapshot of the content of the pages at that
+     * time; pages added or removed since prepareSave() are not part of it. Edits wait for the end of the serialization.
+     *
+     * Each page is compressed right after it is serialized, so that at most one page is held uncompressed in memory.
+     * With a cache, only the changed pages are compressed (under the lock), and the file is written once the lock is
+     * released. Without cache, the file is written while the lock is held.
+     *
+     * If lockDocument is false, saveTo() does not lock the document at all (emergency save).
+     */
+    void prepareSave(Document* doc, bool lockDocument = true);
+
+    /**
+     * With a cache, saveTo() writes the file as one gzip member per page: the pages which did not change since the
+     * previous save are copied from the cache instead of being compressed again. Gzip readers (including older
+     * versions) read such a file as a single stream. Without cache, the file is a single gzip stream.
+     */
+    void setCache(SaveCache* cache);
+
     void saveTo(const fs::path& filepath, ProgressListener* listener = nullptr);
     void saveTo(OutputStream* out, const fs::path& filepath, ProgressListener* listener = nullptr);
     std::string getErrorMessage();
@@ -44,26 +70,61 @@ public:
 protected:
     static std::string getColorStr(Color c, unsigned char alpha = 0xff);
 
-    virtual void visitPage(XmlNode* root, PageRef p, Document* doc, int id);
-    virtual void visitLayer(XmlNode* page, Layer* l);
-    virtual void visitStroke(XmlPointNode* stroke, Stroke* s);
+    void writeDocument(XmlStreamWriter& writer, ProgressListener* listener);
+    void writeMember(XmlStreamWriter& writer, const std::string& member);
+
+    virtual void visitPage(XmlStreamWriter& writer, PageRef p, int id);
+    virtual void visitLayer(XmlStreamWriter& writer, Layer* l);
+
+    /**
+     * Write the layers of a page which has not been loaded yet as they are in the file, without loading them
+     * @return false if the layers have to be written by visitLayer()
+     */
+    virtual bool writeUnloadedLayers(XmlStreamWriter& writer, PageRef p);
+    virtual void visitStroke(XmlStreamWriter& writer, Stroke* s);
 
     /**
      * Export the fill attributes
      */
-    virtual void visitStrokeExtended(XmlPointNode* stroke, Stroke* s);
+    virtual void visitStrokeExtended(XmlStreamWriter& writer, Stroke* s);
 
-    virtual void writeHeader();
-    virtual void writeSolidBackground(XmlNode* background, PageRef p);
-    virtual void writeTimestamp(AudioElement* audioElement, XmlAudioNode* xmlAudioNode);
-    virtual void writeBackgroundName(XmlNode* background, PageRef p);
+    virtual void writeHeader(XmlStreamWriter& writer);
+    virtual void writeSolidBackground(XmlStreamWriter& writer, PageRef p);
+    virtual void writeTimestamp(AudioElement* audioElement, XmlStreamWriter& writer);
+    virtual void writeBackgroundName(XmlStreamWriter& writer, PageRef p);
 
 protected:
-    std::unique_ptr<XmlNode> root{};
+    Document* doc = nullptr;
+    bool lockDocument = true;
+
+    /// Snapshot taken by prepareSave()
+    std::vector<PageRef> pages;
+    xoj::util::CairoSurfaceSPtr preview;
+    fs::path docFilepath;
+    fs::path pdfFilepath;
+    XojPdfDocument pdfDocument;
+    bool attachPdf = false;
+
+    SaveCache* cache = nullptr;
+    /// The file being written, if it is written with one gzip member per page
+    GzMemberOutputStream* members = nullptr;
+
+    /// Where the attached PDF background has to be copied to, if it does not exist yet
+    fs::path pdfAttachmentPath;
+
     bool firstPdfPageVisited;
     int attachBgId;
 
     std::string errorMessage;
 
-    std::vector<BackgroundImage> backgroundImages{};
+    struct AttachedImage {
+        std::string filename;
+        BackgroundImage image;
+    };
+
+    /// The background images to write next to the file
+    std::vector<AttachedImage> backgroundImages{};
+
+    /// The index of the first page using each background image, for the next pages to refer to it
+    std::map<GdkPixbuf*, int> backgroundCloneIds{};
 };
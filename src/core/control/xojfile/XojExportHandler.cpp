@@ -4,8 +4,7 @@
 #include <string>  // for string, allocator, ope...
 
 #include "control/pagetype/PageTypeHandler.h"  // for PageTypeHandler
-#include "control/xml/XmlNode.h"               // for XmlNode
-#include "control/xml/XmlTextNode.h"           // for XmlTextNode
+#include "control/xml/XmlStreamWriter.h"       // for XmlStreamWriter
 #include "model/PageType.h"                    // for PageTypeFormat, PageType
 #include "model/XojPage.h"                     // for XojPage
 
@@ -13,8 +12,6 @@
 
 class AudioElement;
 class Stroke;
-class XmlAudioNode;
-class XmlPointNode;
 
 XojExportHandler::XojExportHandler() = default;
 
@@ -23,22 +20,23 @@ XojExportHandler::~XojExportHandler() = default;
 /**
  * Export the fill attributes
  */
-void XojExportHandler::visitStrokeExtended(XmlPointNode* stroke, Stroke* s) {
+void XojExportHandler::visitStrokeExtended(XmlStreamWriter& writer, Stroke* s) {
     // Fill is not exported in .xoj
     // Line style is also not supported
 }
 
-void XojExportHandler::writeHeader() {
-    this->root->setAttrib("creator", PROJECT_STRING);
+void XojExportHandler::writeHeader(XmlStreamWriter& writer) {
+    writer.setAttrib("creator", PROJECT_STRING);
     // Keep this version on 2, as this is anyway not read by Xournal
-    this->root->setAttrib("fileversion", "2");
-    this->root->addChild(
-            new XmlTextNode("title", std::string{"Xournal document (Compatibility) - see "} + PROJECT_HOMEPAGE_URL));
+    writer.setAttrib("fileversion", "2");
+    writer.startElement("title");
+    writer.writeText(std::string{"Xournal document (Compatibility) - see "} + PROJECT_HOMEPAGE_URL);
+    writer.endElement();
 }
 
-void XojExportHandler::writeSolidBackground(XmlNode* background, PageRef p) {
-    background->setAttrib("type", "solid");
-    background->setAttrib("color", getColorStr(p->getBackgroundColor()));
+void XojExportHandler::writeSolidBackground(XmlStreamWriter& writer, PageRef p) {
+    writer.setAttrib("type", "solid");
+    writer.setAttrib("color", getColorStr(p->getBackgroundColor()));
 
     PageTypeFormat bgFormat = p->getBackgroundType().format;
     std::string format;
@@ -49,13 +47,18 @@ void XojExportHandler::writeSolidBackground(XmlNode* background, PageRef p) {
         format = "plain";
     }
 
-    background->setAttrib("style", format);
+    writer.setAttrib("style", format);
 }
 
-void XojExportHandler::writeTimestamp(AudioElement* audioElement, XmlAudioNode* xmlAudioNode) {
+void XojExportHandler::writeTimestamp(AudioElement* audioElement, XmlStreamWriter& writer) {
     // Do nothing since timestamp are not supported by Xournal
 }
 
-void XojExportHandler::writeBackgroundName(XmlNode* background, PageRef p) {
+void XojExportHandler::writeBackgroundName(XmlStreamWriter& writer, PageRef p) {
     // Do nothing since background name is not supported by Xournal
 }
+
+auto XojExportHandler::writeUnloadedLayers(XmlStreamWriter& writer, PageRef p) -> bool {
+    // The layers have to be converted for Xournal
+    return false;
+}
@@ -18,9 +18,7 @@
 
 class AudioElement;
 class Stroke;
-class XmlAudioNode;
-class XmlNode;
-class XmlPointNode;
+class XmlStreamWriter;
 
 
 class XojExportHandler: public SaveHandler {
@@ -32,11 +30,12 @@ protected:
     /**
      * Export the fill attributes
      */
-    void visitStrokeExtended(XmlPointNode* stroke, Stroke* s) override;
-    void writeHeader() override;
-    void writeSolidBackground(XmlNode* background, PageRef p) override;
-    void writeTimestamp(AudioElement* audioElement, XmlAudioNode* xmlAudioNode) override;
-    void writeBackgroundName(XmlNode* background, PageRef p) override;
+    void visitStrokeExtended(XmlStreamWriter& writer, Stroke* s) override;
+    void writeHeader(XmlStreamWriter& writer) override;
+    void writeSolidBackground(XmlStreamWriter& writer, PageRef p) override;
+    void writeTimestamp(AudioElement* audioElement, XmlStreamWriter& writer) override;
+    void writeBackgroundName(XmlStreamWriter& writer, PageRef p) override;
+    bool writeUnloadedLayers(XmlStreamWriter& writer, PageRef p) override;
 
 private:
 };
@@ -110,7 +110,7 @@ XojPageView::~XojPageView() {
 
     this->overlayViews.clear();
     endText();
-    deleteViewBuffer();  // Ensures the mutex is locked during the buffer's destruction
+    deleteViewBuffer();
 }
 
 void XojPageView::addOverlayView(std::unique_ptr<xoj::view::OverlayView> overlay) {
@@ -119,9 +119,46 @@ void XojPageView::addOverlayView(std::unique_ptr<xoj::view::OverlayView> overlay
 
 void XojPageView::setIsVisible(bool visible) { this->visible = visible; }
 
-void XojPageView::deleteViewBuffer() {
-    std::lock_guard lock(this->drawingMutex);
-    this->buffer.reset();
+void XojPageView::deleteViewBuffer() { this->buffer.reset(); }
+
+void XojPageView::evictInvisibleTiles() {
+    Range keep;
+    {
+        std::lock_guard lock(this->repaintRectMutex);
+        keep = this->visibleArea;
+    }
+    if (!keep.empty()) {
+        // Keep a margin of one tile around the visible area, so that small scrolls do not show missing tiles
+        keep.addPadding(xoj::view::TiledBuffer::TILE_SIZE / getZoom());
+    }
+    this->buffer.evictOutside(keep);
+}
+
+auto XojPageView::paintBufferForPreview(cairo_t* cr, double minZoom, bool onlyUpdated) -> BufferState {
+    Range area(0, 0, getWidth(), getHeight());
+    {
+        std::lock_guard lock(this->repaintRectMutex);
+        if (this->buffer.getZoom() < minZoom || !this->buffer.coversPage()) {
+            return BufferState::UNAVAILABLE;
+        }
+        if (this->rendering || this->rerenderComplete || !this->rerenderRects.empty()) {
+            this->previewPending = true;
+            return BufferState::PENDING;
+        }
+        if (onlyUpdated && this->paintedForPreview) {
+            area = this->updatedForPreview;
+        }
+        this->updatedForPreview = Range();
+        this->paintedForPreview = true;
+    }
+
+    if (!area.empty()) {
+        xoj::util::CairoSaveGuard guard(cr);
+        cairo_rectangle(cr, area.minX, area.minY, area.getWidth(), area.getHeight());
+        cairo_clip(cr);
+        this->buffer.paintTo(cr);
+    }
+    return BufferState::PAINTED;
 }
 
 auto XojPageView::containsPoint(int x, int y, bool local) const -> bool {
@@ -149,9 +186,9 @@ auto XojPageView::searchTextOnPage(const std::string& text, size_t* occurrences,
         if (pNr != npos) {
             Document* doc = xournal->getControl()->getDocument();
 
-            doc->lock();
+            doc->lock_shared();
             pdf = doc->getPdfPage(pNr);
-            doc->unlock();
+            doc->unlock_shared();
         }
         this->search = std::make_unique<SearchControl>(page, pdf);
         this->overlayViews.emplace_back(
@@ -765,9 +802,10 @@ void XojPageView::drawAndDeleteToolView(xoj::view::ToolView* v, const Range& rg)
     if (v->isViewOf(this->inputHandler.get()) || v->isViewOf(this->verticalSpace.get()) ||
         v->isViewOf(this->textEditor.get())) {
         // Draw the inputHandler's view onto the page buffer.
-        std::lock_guard lock(this->drawingMutex);
-        if (auto cr = buffer.get(); cr) {
-            v->drawWithoutDrawingAids(cr);
+        if (buffer.isInitialized()) {
+            buffer.drawOnTiles(rg, [v](cairo_t* cr) { v->drawWithoutDrawingAids(cr); });
+            std::lock_guard lock(this->repaintRectMutex);
+            this->updatedForPreview = rg.empty() ? Range(0, 0, getWidth(), getHeight()) : updatedForPreview.unite(rg);
         } else {
             rerenderPage();
         }
@@ -924,9 +962,9 @@ bool XojPageView::displayLinkPopover(std::shared_ptr<XojPdfPage> page, double pa
             size_t pdfPage = dest->getPdfPage();
 
             Document* doc = xournal->getControl()->getDocument();
-            doc->lock();
+            doc->lock_shared();
             const size_t pageId = doc->findPdfPage(pdfPage);
-            doc->unlock();
+            doc->unlock_shared();
 
             GtkWidget* button{};
             if (pageId != npos) {
@@ -987,20 +1025,28 @@ auto XojPageView::paintPage(cairo_t* cr, GdkRectangle* rect) -> bool {
     cairo_scale(cr, zoom, zoom);
 
     {
-        std::lock_guard lock(this->drawingMutex);  // Lock the mutex first
-        xoj::util::CairoSaveGuard saveGuard(cr);   // see comment at the end of the scope
+        std::lock_guard lock(this->repaintRectMutex);
+        this->visibleArea = getVisiblePart();
+    }
+
+    {
+        xoj::util::CairoSaveGuard saveGuard(cr);  // see comment at the end of the scope
         if (!this->hasBuffer()) {
             drawLoadingPage(cr);
             return true;
         }
 
-        if (this->buffer.getZoom() != zoom) {
+        bool zoomChanged = this->buffer.getZoom() != zoom;
+        if (zoomChanged) {
             rerenderPage();
             cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
         }
-        this->buffer.paintTo(cr);
-    }  // Restore the state of cr and then release the mutex
-       // restoring the state of cr ensures this->buffer.surface is not longer referenced as the source in cr.
+        if (!this->buffer.paintTo(cr) && !zoomChanged) {
+            // Some visible tiles have not been rendered yet (or were evicted)
+            this->xournal->getControl()->getScheduler()->addRerenderPage(this);
+        }
+    }  // Restore the state of cr
+       // restoring the state of cr ensures the buffer's surfaces are not longer referenced as the source in cr.
 
     /**
      * All the overlay painters below follow the assumption:
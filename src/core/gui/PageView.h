@@ -26,8 +26,9 @@
 #include "model/PageRef.h"            // for PageRef
 #include "util/Rectangle.h"           // for Rectangle
 #include "util/raii/CairoWrappers.h"  // for CairoSurfaceSPtr
-#include "view/Mask.h"                // for Mask
+#include "util/Range.h"               // for Range
 #include "view/Repaintable.h"         // for Repaintable
+#include "view/TiledBuffer.h"         // for TiledBuffer
 
 #include "Layout.h"            // for Layout
 #include "LegacyRedrawable.h"  // for LegacyRedrawable
@@ -43,7 +44,6 @@ class VerticalToolHandler;
 class XournalView;
 class Element;
 class PositionInputData;
-class Range;
 class TexImage;
 class XojPdfRectangle;
 class XojPdfPage;
@@ -114,6 +114,29 @@ public:
 
     void deleteViewBuffer() override;
 
+    /**
+     * Frees the tiles of the page buffer which are far from the visible part of the page
+     */
+    void evictInvisibleTiles();
+
+    enum class BufferState {
+        /// The page buffer has been painted
+        PAINTED,
+        /// The page buffer will be complete once the pending rendering is done: the previews of the page are then
+        /// notified again
+        PENDING,
+        /// The page buffer does not cover the whole page, or is too coarse
+        UNAVAILABLE
+    };
+
+    /**
+     * @brief Paints the page buffer onto cr (in page coordinates), so that the sidebar preview does not need to render
+     * the page again.
+     * @param minZoom The buffer must have been rendered at this zoom at least
+     * @param onlyUpdated Only paint the parts of the buffer updated since the last call (everything the first time)
+     */
+    BufferState paintBufferForPreview(cairo_t* cr, double minZoom, bool onlyUpdated);
+
     /**
      * Returns whether this PageView contains the
      * given point on the display
@@ -270,8 +293,10 @@ private:
     bool visible = true;
     bool selected = false;
 
-    xoj::view::Mask buffer;
-    std::mutex drawingMutex;
+    /**
+     * The rendered page. Only the tiles around the visible part of the page are allocated.
+     */
+    xoj::view::TiledBuffer buffer;
 
     bool inEraser = false;
 
@@ -290,6 +315,28 @@ private:
     bool rerenderComplete = false;
     bool sizeChanged = false;
 
+    /**
+     * Whether a RenderJob is updating the buffer
+     */
+    bool rendering = false;
+
+    /**
+     * The part of the buffer updated since it was last painted for the sidebar preview, and whether it has ever been
+     */
+    Range updatedForPreview;
+    bool paintedForPreview = false;
+
+    /**
+     * Whether a preview is waiting for the rendering to be over
+     */
+    bool previewPending = false;
+
+    /**
+     * The part of the page visible on screen, in page coordinates (empty if unknown). Updated on each paint, used by
+     * the RenderJob to select the tiles to render.
+     */
+    Range visibleArea;
+
     int dispX{};  // position on display - set in Layout::layoutPages
     int dispY{};
 
@@ -19,6 +19,7 @@
 #include "control/AudioController.h"
 #include "control/tools/EditSelection.h"
 #include "util/PathUtil.h"
+#include "util/Range.h"
 
 #include "XournalView.h"
 #include "filesystem.h"
@@ -62,13 +63,15 @@ protected:
          */
         bool found = false;
         double minDistSq = std::numeric_limits<double>::max();
-        for (Element* e: l->getElements()) {
+        const GdkRectangle matchRect = {gint(x - 10), gint(y - 10), 20, 20};
+        const Range matchRange(matchRect.x, matchRect.y, matchRect.x + matchRect.width,
+                               matchRect.y + matchRect.height);
+        for (Element* e: l->getElementsInRange(matchRange)) {
             const double eX = e->getX() + e->getElementWidth() / 2.0;
             const double eY = e->getY() + e->getElementHeight() / 2.0;
             const double dx = eX - this->x;
             const double dy = eY - this->y;
             const double distSq = dx * dx + dy * dy;
-            const GdkRectangle matchRect = {gint(x - 10), gint(y - 10), 20, 20};
             if (e->intersectsArea(&matchRect) && distSq < minDistSq) {
                 if (this->checkElement(e)) {
                     minDistSq = distSq;
@@ -3,7 +3,7 @@
 #include <algorithm>  // for max, min
 #include <cmath>      // for lround
 #include <iterator>   // for begin
-#include <memory>     // for unique_ptr, make_unique
+#include <memory>     // for unique_ptr, make_unique, weak_ptr
 #include <optional>   // for optional
 
 #include <gdk/gdk.h>         // for GdkEventKey, GDK_SHIF...
@@ -29,10 +29,13 @@
 #include "gui/toolbarMenubar/ColorToolItem.h"    // for ColorToolItem
 #include "gui/toolbarMenubar/ToolMenuHandler.h"  // for ToolMenuHandler
 #include "gui/widgets/XournalWidget.h"           // for gtk_xournal_get_layout
+#include "model/CachedPath.h"                    // for CachedPath
 #include "model/Document.h"                      // for Document
 #include "model/Element.h"                       // for Element, ELEMENT_STROKE
+#include "model/Image.h"                         // for Image
 #include "model/PageRef.h"                       // for PageRef
 #include "model/Stroke.h"                        // for Stroke, StrokeTool::E...
+#include "model/TexImage.h"                      // for TexImage
 #include "model/XojPage.h"                       // for XojPage
 #include "undo/DeleteUndoAction.h"               // for DeleteUndoAction
 #include "undo/UndoRedoHandler.h"                // for UndoRedoHandler
@@ -40,6 +43,7 @@
 #include "util/Rectangle.h"                      // for Rectangle
 #include "util/Util.h"                           // for npos
 #include "util/glib_casts.h"                     // for wrap_v
+#include "view/TiledBuffer.h"                    // for TiledBuffer
 
 #include "Layout.h"           // for Layout
 #include "PageView.h"         // for XojPageView
@@ -65,9 +69,10 @@ XournalView::XournalView(GtkWidget* parent, Control* control, ScrollHandling* sc
     Document* doc = control->getDocument();
     doc->lock();
     if (doc->getPdfPageCount() != 0) {
-        this->cache = std::make_unique<PdfCache>(doc->getPdfDocument(), control->getSettings());
+        createPdfCache(doc);
     }
     doc->unlock();
+    onSettingsChanged();
 
     registerListener(control);
 
@@ -94,6 +99,11 @@ XournalView::XournalView(GtkWidget* parent, Control* control, ScrollHandling* sc
 }
 
 XournalView::~XournalView() {
+    if (this->cache) {
+        this->cache->setPageReadyCallback(nullptr);
+    }
+    this->alive.reset();
+
     g_source_remove(this->cleanupTimeout);
 
     gtk_widget_destroy(this->widget);
@@ -118,6 +128,12 @@ auto XournalView::cleanupBufferCache() -> void {
             page->deleteViewBuffer();
         }
     }
+
+    // If the remaining pages still exceed the memory budget, only keep the tiles around the visible areas
+    auto budget = static_cast<size_t>(control->getSettings()->getPageBufferMemoryBudget()) * 1024 * 1024;
+    if (xoj::view::TiledBuffer::getTotalMemoryUsage() > budget) {
+        for (auto&& page: this->viewPages) { page->evictInvisibleTiles(); }
+    }
 }
 
 auto XournalView::getCurrentPage() const -> size_t { return currentPage; }
@@ -336,6 +352,12 @@ void XournalView::onRealized(GtkWidget* widget, XournalView* view) {
 }
 
 void XournalView::onSettingsChanged() {
+    Image::setDecodedMemoryBudget(static_cast<size_t>(control->getSettings()->getImageCacheMemoryBudget()) * 1024U *
+                                  1024U);
+    TexImage::setRasterMemoryBudget(static_cast<size_t>(control->getSettings()->getTexImageCacheMemoryBudget()) *
+                                    1024U * 1024U);
+    CachedPath::setMemoryBudget(static_cast<size_t>(control->getSettings()->getStrokePathCacheMemoryBudget()) * 1024U *
+                                1024U);
     if (this->cache) {
         this->cache->updateSettings(control->getSettings());
     }
@@ -509,13 +531,36 @@ auto XournalView::getVisibleRect(const XojPageView* redrawable) const -> Rectang
     return gtk_xournal_get_visible_area(this->widget, redrawable);
 }
 
+void XournalView::createPdfCache(Document* doc) {
+    this->cache = std::make_unique<PdfCache>(doc->getPdfDocument(), control->getSettings());
+
+    // Pages painted with a lower resolution version of their PDF page are rendered again when it is ready. The
+    // callback runs in a rendering thread: it only touches the view from the UI thread, if the view still exists.
+    this->cache->setPageReadyCallback([this, alive = std::weak_ptr<bool>(this->alive)](size_t pdfPageNo) {
+        Util::execInUiThread([this, alive, pdfPageNo]() {
+            if (alive.expired()) {
+                return;
+            }
+            for (auto&& v: this->viewPages) {
+                PageRef page = v->getPage();
+                if (page->getBackgroundType().isPdfPage() && page->getPdfPageNr() == pdfPageNo) {
+                    v->rerenderPage();
+                }
+            }
+        });
+    });
+}
+
 void XournalView::recreatePdfCache() {
+    if (this->cache) {
+        this->cache->setPageReadyCallback(nullptr);
+    }
     this->cache.reset();
 
     Document* doc = control->getDocument();
     doc->lock();
     if (doc->getPdfPageCount() != 0) {
-        this->cache = std::make_unique<PdfCache>(doc->getPdfDocument(), control->getSettings());
+        createPdfCache(doc);
     }
     doc->unlock();
 }
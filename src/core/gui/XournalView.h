@@ -12,7 +12,7 @@
 #pragma once
 
 #include <cstddef>  // for size_t
-#include <memory>   // for unique_ptr
+#include <memory>   // for unique_ptr, shared_ptr
 #include <string>   // for string
 #include <utility>  // for pair
 #include <vector>   // for vector
@@ -153,6 +153,8 @@ public:
 private:
     void fireZoomChanged();
 
+    void createPdfCache(Document* doc);
+
     std::pair<size_t, size_t> preloadPageBounds(size_t page, size_t maxPage);
 
     static auto clearMemoryTimer(XournalView* widget) -> gboolean;
@@ -176,6 +178,12 @@ private:
 
     std::unique_ptr<PdfCache> cache;
 
+    /**
+     * Expires with the view. The PDF rendering threads queue closures in the UI thread which may run after the view has
+     * been destroyed: they check it first.
+     */
+    std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+
     /**
      * Handler for rerendering pages / repainting pages
      */
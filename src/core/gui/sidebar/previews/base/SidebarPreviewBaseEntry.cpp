@@ -81,6 +81,7 @@ void SidebarPreviewBaseEntry::drawLoadingPage() {
     gtk_widget_get_allocation(widget, &alloc);
 
     this->crBuffer = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, alloc.width, alloc.height);
+    this->bufferZoom = 0;
 
     double zoom = sidebar->getZoom();
 
@@ -103,5 +103,10 @@ protected:
      */
     cairo_surface_t* crBuffer = nullptr;
 
+    /**
+     * The zoom at which crBuffer shows the page, or 0 if it does not show the page (e.g. "Loading...")
+     */
+    double bufferZoom = 0;
+
     friend class PreviewJob;
 };
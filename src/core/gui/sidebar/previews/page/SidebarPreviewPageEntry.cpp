@@ -1,10 +1,19 @@
 #include "SidebarPreviewPageEntry.h"
 
+#include <mutex>  // for lock_guard
+
 #include "control/Control.h"                                // for Control
 #include "control/ScrollHandler.h"                          // for ScrollHan...
+#include "control/ToolEnums.h"                              // for TOOL_PLAY...
+#include "control/ToolHandler.h"                            // for ToolHandler
 #include "control/settings/Settings.h"                      // for Settings
+#include "gui/MainWindow.h"                                 // for MainWindow
 #include "gui/PagePreviewDecoration.h"                      // for Drawing  ...
+#include "gui/PageView.h"                                   // for XojPageView
+#include "gui/Shadow.h"                                     // for Shadow
+#include "gui/XournalView.h"                                // for XournalView
 #include "gui/sidebar/previews/page/SidebarPreviewPages.h"  // for SidebarPr...
+#include "model/XojPage.h"                                  // for XojPage
 
 SidebarPreviewPageEntry::SidebarPreviewPageEntry(SidebarPreviewPages* sidebar, const PageRef& page, size_t index):
         SidebarPreviewBaseEntry(sidebar, page), sidebar(sidebar), index(index) {}
@@ -18,6 +27,59 @@ void SidebarPreviewPageEntry::mouseButtonPressCallback() {
     sidebar->getControl()->firePageSelected(page);
 }
 
+void SidebarPreviewPageEntry::repaint() {
+    if (!repaintFromPageBuffer()) {
+        SidebarPreviewBaseEntry::repaint();
+    }
+}
+
+auto SidebarPreviewPageEntry::repaintFromPageBuffer() -> bool {
+    Control* control = sidebar->getControl();
+    MainWindow* win = control->getWindow();
+    // While playing audio, the main view highlights the elements being played, which the preview should not show
+    if (win == nullptr || control->getToolHandler()->getToolType() == TOOL_PLAY_OBJECT) {
+        return false;
+    }
+    XojPageView* view = win->getXournal()->getViewFor(this->index);
+    if (view == nullptr || view->getPage() != this->page) {
+        return false;
+    }
+
+    GtkAllocation alloc;
+    gtk_widget_get_allocation(this->widget, &alloc);
+    const double zoom = sidebar->getZoom();
+
+    std::lock_guard lock(this->drawingMutex);
+
+    const bool incremental = this->crBuffer && this->bufferZoom == zoom &&
+                             cairo_image_surface_get_width(this->crBuffer) == alloc.width &&
+                             cairo_image_surface_get_height(this->crBuffer) == alloc.height;
+    cairo_surface_t* surface = incremental ? cairo_surface_reference(this->crBuffer) :
+                                             cairo_image_surface_create(CAIRO_FORMAT_ARGB32, alloc.width, alloc.height);
+
+    cairo_t* cr = cairo_create(surface);
+    cairo_translate(cr, Shadow::getShadowTopLeftSize() + 2, Shadow::getShadowTopLeftSize() + 2);
+    cairo_scale(cr, zoom, zoom);
+    cairo_rectangle(cr, 0, 0, page->getWidth(), page->getHeight());
+    cairo_clip(cr);
+    auto state = view->paintBufferForPreview(cr, zoom, incremental);
+    cairo_destroy(cr);
+
+    if (state != XojPageView::BufferState::PAINTED) {
+        cairo_surface_destroy(surface);
+        // A pending rendering of the page buffer notifies the preview again once done: keep the current one until then
+        return state == XojPageView::BufferState::PENDING && incremental;
+    }
+
+    if (this->crBuffer) {
+        cairo_surface_destroy(this->crBuffer);
+    }
+    this->crBuffer = surface;
+    this->bufferZoom = zoom;
+    gtk_widget_queue_draw(this->widget);
+    return true;
+}
+
 void SidebarPreviewPageEntry::paint(cairo_t* cr) {
     SidebarPreviewBaseEntry::paint(cr);
     if (sidebar->getControl()->getSettings()->getSidebarNumberingStyle() == SidebarNumberingStyle::NONE) {
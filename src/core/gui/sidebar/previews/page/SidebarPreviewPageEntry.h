@@ -34,6 +34,12 @@ public:
     bool isSelected() const;
     double getZoom() const;
 
+    /**
+     * Takes the preview from the buffer of the main view of the page if possible, else renders the page again
+     * @override
+     */
+    void repaint() override;
+
 protected:
     SidebarPreviewPages* sidebar;
     void mouseButtonPressCallback() override;
@@ -45,4 +51,11 @@ private:
     friend class PreviewJob;
 
     void drawEntryNumber(cairo_t* cr);
+
+    /**
+     * Downsamples the page buffer of the main view into the preview. Only the parts changed since the last time are
+     * painted again when the preview is already at the right zoom.
+     * @return false if the page has to be rendered from scratch
+     */
+    bool repaintFromPageBuffer();
 };
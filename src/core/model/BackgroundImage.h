@@ -36,10 +36,6 @@ struct BackgroundImage {
     void loadFile(fs::path const& filepath, GError** error);
     void loadFile(GInputStream* stream, fs::path const& filepath, GError** error);
 
-    int getCloneId();
-    void setCloneId(int id);
-    void clearSaveState();
-
     fs::path getFilepath() const;
     void setFilepath(fs::path filepath);
 
@@ -0,0 +1,31 @@
+#include "CachedPath.h"
+
+#include <utility>  // for move
+
+#include "util/LruCache.h"  // for LruCache
+
+namespace {
+struct PathSize {
+    size_t operator()(const std::shared_ptr<const cairo_path_t>& path) const {
+        return sizeof(cairo_path_t) + static_cast<size_t>(path->num_data) * sizeof(cairo_path_data_t);
+    }
+};
+
+/// The paths of all the handles, each at level 0
+using PathCache = xoj::util::LruCache<CachedPath, std::shared_ptr<const cairo_path_t>, PathSize>;
+
+auto getPathCache() -> PathCache& {
+    static PathCache cache(64U * 1024U * 1024U);
+    return cache;
+}
+}  // namespace
+
+CachedPath::CachedPath(std::shared_ptr<const cairo_path_t> path) { getPathCache().put(this, 0, std::move(path)); }
+
+CachedPath::~CachedPath() { getPathCache().remove(this); }
+
+auto CachedPath::get() const -> std::shared_ptr<const cairo_path_t> { return getPathCache().get(this, 0); }
+
+void CachedPath::setMemoryBudget(size_t bytes) { getPathCache().setMemoryBudget(bytes); }
+
+auto CachedPath::getMemoryBudget() -> size_t { return getPathCache().getMemoryBudget(); }
@@ -0,0 +1,40 @@
+/*
+ * Xournal++
+ *
+ * A cairo path kept in a cache bounded by memory
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>  // for size_t
+#include <memory>   // for shared_ptr
+
+#include <cairo.h>  // for cairo_path_t
+
+/**
+ * Handle to a path in the cache of the stroke geometries. All the cached paths share a memory budget: the least
+ * recently used paths are dropped first, and get() then returns nullptr. The path is dropped with the handle at the
+ * latest. Thread safe.
+ */
+class CachedPath {
+public:
+    explicit CachedPath(std::shared_ptr<const cairo_path_t> path);
+    ~CachedPath();
+
+    CachedPath(const CachedPath&) = delete;
+    CachedPath& operator=(const CachedPath&) = delete;
+
+    /**
+     * @brief The path, or nullptr if it was dropped from the cache and must be computed again
+     */
+    std::shared_ptr<const cairo_path_t> get() const;
+
+    /// Set the amount of memory all the cached paths may use together. The least recently used paths are freed first.
+    static void setMemoryBudget(size_t bytes);
+    static size_t getMemoryBudget();
+};
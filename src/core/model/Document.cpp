@@ -4,6 +4,7 @@
 #include <codecvt>  // for codecvt_utf8_utf16
 #include <ctime>    // for size_t, localtime, strf...
 #include <iomanip>
+#include <mutex>    // for lock_guard, unique_lock
 #include <sstream>
 #include <string>   // for string
 #include <utility>  // for move, pair
@@ -28,6 +29,8 @@
 #include "XojPage.h"          // for XojPage
 #include "filesystem.h"       // for path
 
+#include "config-debug.h"  // for DEBUG_DOCUMENT_LOCK
+
 Document::Document(DocumentHandler* handler): handler(handler) {}
 
 Document::~Document() {
@@ -59,30 +62,78 @@ auto Document::freeTreeContentEntry(GtkTreeModel* treeModel, GtkTreePath* path,
     return false;
 }
 
-void Document::lock() {
-    this->documentLock.lock();
+#ifdef DEBUG_DOCUMENT_LOCK
+namespace {
+/// Waits and holds shorter than this are not reported
+constexpr double REPORT_THRESHOLD_MS = 5.0;
+
+thread_local std::chrono::steady_clock::time_point sharedLockedSince;
+
+auto msSince(std::chrono::steady_clock::time_point t) -> double {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+void reportTime(const char* what, double ms) {
+    if (ms >= REPORT_THRESHOLD_MS) {
+        g_message("Document lock: %s for %.1f ms", what, ms);
+    }
+}
+}  // namespace
+#define LOCK_DEBUG(f) f
+#else
+#define LOCK_DEBUG(f)
+#endif
 
-    //	if(tryLock()) {
-    //		fprintf(stderr, "Locked by\n");
-    //		Stacktrace::printStacktrace();
-    //		fprintf(stderr, "\n\n\n\n");
-    //	} else {
-    //		g_mutex_lock(&this->documentLock);
-    //	}
+void Document::lock() {
+    LOCK_DEBUG(auto start = std::chrono::steady_clock::now());
+    {
+        std::lock_guard<std::mutex> gate(this->writerGate);
+        this->documentLock.lock();
+    }
+    LOCK_DEBUG(reportTime("waited for exclusive access", msSince(start)));
+    LOCK_DEBUG(this->lockedSince = std::chrono::steady_clock::now());
 }
 
 void Document::unlock() {
+    LOCK_DEBUG(reportTime("held exclusively", msSince(this->lockedSince)));
     this->documentLock.unlock();
-
-    //	fprintf(stderr, "Unlocked by\n");
-    //	Stacktrace::printStacktrace();
-    //	fprintf(stderr, "\n\n\n\n");
 }
 
 /*
 ** Returns true when successfully acquiring lock.
 */
-auto Document::tryLock() -> bool { return this->documentLock.try_lock(); }
+auto Document::tryLock() -> bool {
+    if (!this->documentLock.try_lock()) {
+        return false;
+    }
+    LOCK_DEBUG(this->lockedSince = std::chrono::steady_clock::now());
+    return true;
+}
+
+void Document::lock_shared() {
+    LOCK_DEBUG(auto start = std::chrono::steady_clock::now());
+    {
+        // Let the waiting writer go first
+        std::lock_guard<std::mutex> gate(this->writerGate);
+    }
+    this->documentLock.lock_shared();
+    LOCK_DEBUG(reportTime("waited for shared access", msSince(start)));
+    LOCK_DEBUG(sharedLockedSince = std::chrono::steady_clock::now());
+}
+
+void Document::unlock_shared() {
+    LOCK_DEBUG(reportTime("held shared", msSince(sharedLockedSince)));
+    this->documentLock.unlock_shared();
+}
+
+auto Document::try_lock_shared() -> bool {
+    std::unique_lock<std::mutex> gate(this->writerGate, std::try_to_lock);
+    if (!gate.owns_lock() || !this->documentLock.try_lock_shared()) {
+        return false;
+    }
+    LOCK_DEBUG(sharedLockedSince = std::chrono::steady_clock::now());
+    return true;
+}
 
 void Document::clearDocument(bool destroy) {
     if (this->preview) {
@@ -102,6 +153,7 @@ void Document::clearDocument(bool destroy) {
     }
 
     this->pages.clear();
+    this->pageNumbers.clear();
     this->pageIndex.reset();
     freeTreeContentModel();
 
@@ -206,6 +258,7 @@ auto Document::getEvMetadataFilename() const -> fs::path {
 auto Document::isAttachPdf() const -> bool { return this->attachPdf; }
 
 auto Document::findPdfPage(size_t pdfPage) -> size_t {
+    std::lock_guard<std::mutex> lock(this->pageIndexMutex);
     // Create a page index if not already indexed.
     if (!this->pageIndex)
         indexPdfPages();
@@ -358,6 +411,8 @@ auto Document::readPdf(const fs::path& filename, bool initPages, bool attachToDo
             p->setBackgroundPdfPageNr(i);
             this->pages.emplace_back(std::move(p));
         }
+        this->pageNumbers.clear();
+        renumberPages(0);
     }
 
     indexPdfPages();
@@ -384,40 +439,47 @@ auto Document::getPageHeight(PageRef p) -> double { return p->getHeight(); }
  */
 auto Document::getLastErrorMsg() const -> std::string { return lastError; }
 
-void Document::deletePage(size_t pNr) {
-    auto it = this->pages.begin() + pNr;
-    this->pages.erase(it);
+void Document::deletePage(size_t pNr) { deletePages(pNr, 1); }
 
-    // Reset the page index
-    this->pageIndex.reset();
-    updateIndexPageNumbers();
+void Document::deletePages(size_t first, size_t count) {
+    auto begin = this->pages.begin() + static_cast<std::ptrdiff_t>(first);
+    auto end = begin + static_cast<std::ptrdiff_t>(count);
+    for (auto it = begin; it != end; ++it) {
+        this->pageNumbers.erase(it->get());
+    }
+    this->pages.erase(begin, end);
+
+    pagesChanged(first);
 }
 
 void Document::insertPage(const PageRef& p, size_t position) {
-    this->pages.insert(this->pages.begin() + position, p);
-
-    // Reset the page index
-    this->pageIndex.reset();
-    updateIndexPageNumbers();
+    this->pages.insert(this->pages.begin() + static_cast<std::ptrdiff_t>(position), p);
+    pagesChanged(position);
 }
 
 void Document::addPage(const PageRef& p) {
     this->pages.push_back(p);
+    pagesChanged(this->pages.size() - 1);
+}
+
+void Document::renumberPages(size_t position) {
+    for (size_t i = position; i < this->pages.size(); i++) {
+        this->pageNumbers[this->pages[i].get()] = i;
+    }
+}
+
+void Document::pagesChanged(size_t position) {
+    // Only the pages from the position on moved
+    renumberPages(position);
 
     // Reset the page index
     this->pageIndex.reset();
     updateIndexPageNumbers();
 }
 
-auto Document::indexOf(const PageRef& page) -> size_t {
-    for (size_t i = 0; i < this->pages.size(); i++) {
-        PageRef pg = this->pages[i];
-        if (pg == page) {
-            return i;
-        }
-    }
-
-    return npos;
+auto Document::indexOf(const PageRef& page) const -> size_t {
+    auto it = this->pageNumbers.find(page.get());
+    return it == this->pageNumbers.end() ? npos : it->second;
 }
 
 auto Document::getPage(size_t page) const -> PageRef {
@@ -448,6 +510,9 @@ auto Document::operator=(const Document& doc) -> Document& {
     this->pages = doc.pages;
     this->attachPdf = doc.attachPdf;
 
+    this->pageNumbers.clear();
+    renumberPages(0);
+
     indexPdfPages();
     buildContentsModel();
     updateIndexPageNumbers();
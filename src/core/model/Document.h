@@ -4,6 +4,8 @@
  * The document
  *
  * All methods are unlocked, you need to lock the document before you change something and unlock after.
+ * Code which only reads the document (rendering, previews, search, export...) may take the lock in shared mode
+ * instead: any number of readers then run together, and only changes take exclusive access.
  *
  * @author Xournal++ Team
  * https://github.com/xournalpp/xournalpp
@@ -13,9 +15,11 @@
 
 #pragma once
 
-#include <cstddef>        // for size_t
+#include <cstddef>        // for size_t, ptrdiff_t
 #include <memory>         // for unique_ptr
+#include <chrono>         // for steady_clock
 #include <mutex>          // for mutex
+#include <shared_mutex>   // for shared_mutex
 #include <string>         // for string
 #include <unordered_map>  // for unordered_map
 #include <vector>         // for vector
@@ -53,17 +57,29 @@ public:
     const XojPdfDocument& getPdfDocument() const;
 
     void insertPage(const PageRef& p, size_t position);
+    /**
+     * Insert several pages before the given position. The following pages are renumbered once for all of them.
+     */
+    template <class InputIter>
+    void insertPages(InputIter first, InputIter last, size_t position);
     void addPage(const PageRef& p);
     template <class InputIter>
     void addPages(InputIter first, InputIter last);
     PageRef getPage(size_t page) const;
     void deletePage(size_t pNr);
+    /**
+     * Delete the pages first, ..., first + count - 1. The following pages are renumbered once for all of them.
+     */
+    void deletePages(size_t first, size_t count);
 
     static void setPageSize(PageRef p, double width, double height);
     static double getPageWidth(PageRef p);
     static double getPageHeight(PageRef p);
 
-    size_t indexOf(const PageRef& page);
+    /**
+     * @return The position of the page in the document, or npos. Constant time.
+     */
+    size_t indexOf(const PageRef& page) const;
 
     /**
      * @return The last error message to show to the user
@@ -94,10 +110,22 @@ public:
     cairo_surface_t* getPreview() const;
     void setPreview(cairo_surface_t* preview);
 
+    /**
+     * Exclusive lock, for changes of the document. Also usable with std::lock_guard<Document>.
+     */
     void lock();
     void unlock();
     bool tryLock();
 
+    /**
+     * Shared lock, for code only reading the document. Named after the SharedLockable requirements, so that
+     * std::shared_lock<Document> can be used.
+     * Not recursive: a thread holding the lock (in any mode) must not lock it again.
+     */
+    void lock_shared();
+    void unlock_shared();
+    bool try_lock_shared();
+
 private:
     void buildContentsModel();
     void freeTreeContentModel();
@@ -105,6 +133,12 @@ private:
 
     void buildTreeContentsModel(GtkTreeIter* parent, XojPdfBookmarkIterator* iter);
     void updateIndexPageNumbers();
+
+    /**
+     * Must be called after pages were inserted or deleted at the given position
+     */
+    void pagesChanged(size_t position);
+    void renumberPages(size_t position);
     static bool fillPageLabels(GtkTreeModel* treeModel, GtkTreePath* path, GtkTreeIter* iter, Document* doc);
 
 private:
@@ -128,6 +162,12 @@ private:
      */
     std::vector<PageRef> pages;
 
+    /**
+     * Index from page to its position in pages. Updated when pages are inserted or deleted, so that indexOf() does
+     * not need to modify the document, and can be called by several readers at once.
+     */
+    std::unordered_map<const XojPage*, size_t> pageNumbers;
+
     /**
      * Index from pdf page number to document page number
      */
@@ -160,15 +200,35 @@ private:
      */
     cairo_surface_t* preview = nullptr;
 
+    /**
+     * Protects the lazy creation of pageIndex, which may happen while the document is shared by several readers
+     */
+    std::mutex pageIndexMutex;
+
     /**
      * The lock of the document
      */
-    std::mutex documentLock;
+    std::shared_mutex documentLock;
+
+    /**
+     * Taken by the writers while they wait for the document lock, and briefly by the readers before they take it:
+     * a waiting writer thus holds back the new readers, and is not starved by a stream of render jobs.
+     */
+    std::mutex writerGate;
+
+    /**
+     * When the exclusive lock was taken, to report the time it is held in DEBUG_DOCUMENT_LOCK builds
+     */
+    std::chrono::steady_clock::time_point lockedSince;
 };
 
+template <class InputIter>
+void Document::insertPages(InputIter first, InputIter last, size_t position) {
+    this->pages.insert(this->pages.begin() + static_cast<std::ptrdiff_t>(position), first, last);
+    pagesChanged(position);
+}
+
 template <class InputIter>
 void Document::addPages(InputIter first, InputIter last) {
-    this->pages.insert(this->pages.end(), first, last);
-    this->pageIndex.reset();
-    updateIndexPageNumbers();
+    insertPages(first, last, this->pages.size());
 }
@@ -1,14 +1,18 @@
 #include "Element.h"
 
 #include <algorithm>  // for max, min
+#include <array>      // for array
 #include <cmath>      // for ceil, floor, NAN
-#include <cstdint>    // for uint32_t
+#include <cstdint>    // for uint32_t, uintptr_t
+#include <mutex>      // for mutex, lock_guard
 
 #include <glib.h>  // for gint
 
 #include "util/serializing/ObjectInputStream.h"   // for ObjectInputStream
 #include "util/serializing/ObjectOutputStream.h"  // for ObjectOutputStream
 
+#include "SpatialIndex.h"  // for SpatialIndex
+
 using xoj::util::Rectangle;
 
 Element::Element(ElementType type): type(type) {}
@@ -20,33 +24,26 @@ auto Element::getType() const -> ElementType { return this->type; }
 void Element::setX(double x) {
     this->x = x;
     this->sizeCalculated = false;
+    notifyBoundsChanged();
 }
 
 void Element::setY(double y) {
     this->y = y;
     this->sizeCalculated = false;
+    notifyBoundsChanged();
 }
 
 auto Element::getX() const -> double {
-    if (!this->sizeCalculated) {
-        this->sizeCalculated = true;
-        calcSize();
-    }
+    ensureSizeCalculated();
     return x;
 }
 
 auto Element::getY() const -> double {
-    if (!this->sizeCalculated) {
-        this->sizeCalculated = true;
-        calcSize();
-    }
+    ensureSizeCalculated();
     return y;
 }
 auto Element::getSnappedBounds() const -> Rectangle<double> {
-    if (!this->sizeCalculated) {
-        this->sizeCalculated = true;
-        calcSize();
-    }
+    ensureSizeCalculated();
     return this->snappedBounds;
 }
 
@@ -54,21 +51,37 @@ void Element::move(double dx, double dy) {
     this->x += dx;
     this->y += dy;
     this->snappedBounds = this->snappedBounds.translated(dx, dy);
+    notifyBoundsChanged();
 }
 
-auto Element::getElementWidth() const -> double {
+void Element::setSpatialIndex(SpatialIndex* index) { this->spatialIndex.index = index; }
+
+void Element::ensureSizeCalculated() const {
+    if (this->sizeCalculated) {
+        return;
+    }
+    // Elements share a few mutexes, as the size is calculated once in a while only
+    static std::array<std::mutex, 16> mutexes;
+    std::lock_guard<std::mutex> lock(mutexes[(reinterpret_cast<uintptr_t>(this) / alignof(Element)) % mutexes.size()]);
     if (!this->sizeCalculated) {
-        this->sizeCalculated = true;
         calcSize();
+        this->sizeCalculated = true;
+    }
+}
+
+void Element::notifyBoundsChanged() {
+    if (this->spatialIndex.index) {
+        this->spatialIndex.index->markDirty(this);
     }
+}
+
+auto Element::getElementWidth() const -> double {
+    ensureSizeCalculated();
     return this->width;
 }
 
 auto Element::getElementHeight() const -> double {
-    if (!this->sizeCalculated) {
-        this->sizeCalculated = true;
-        calcSize();
-    }
+    ensureSizeCalculated();
     return this->height;
 }
 
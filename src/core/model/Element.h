@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <atomic>  // for atomic
 #include <iosfwd>  // for ptrdiff_t
 
 #include <gdk/gdk.h>  // for GdkRectangle
@@ -21,6 +22,7 @@
 
 class ObjectInputStream;
 class ObjectOutputStream;
+class SpatialIndex;
 
 enum ElementType { ELEMENT_STROKE = 1, ELEMENT_IMAGE, ELEMENT_TEXIMAGE, ELEMENT_TEXT };
 
@@ -79,13 +81,50 @@ public:
     void serialize(ObjectOutputStream& out) const override;
     void readSerialized(ObjectInputStream& in) override;
 
+    /**
+     * Set by the Layer containing this element. The index is notified whenever the bounding box changes.
+     */
+    void setSpatialIndex(SpatialIndex* index);
+
 private:
 protected:
     virtual void calcSize() const = 0;
 
+    /**
+     * Must be called by any method which (possibly) changes the bounding box of the element
+     */
+    void notifyBoundsChanged();
+
+    /**
+     * Calls calcSize() if needed. Several readers of the document may get here at the same time: only one of them
+     * calculates the size.
+     */
+    void ensureSizeCalculated() const;
+
 protected:
+    /**
+     * A copyable atomic flag
+     */
+    class SizeCalculatedFlag {
+    public:
+        SizeCalculatedFlag() = default;
+        SizeCalculatedFlag(const SizeCalculatedFlag& other): value(other.value.load()) {}
+        SizeCalculatedFlag& operator=(const SizeCalculatedFlag& other) {
+            value.store(other.value.load());
+            return *this;
+        }
+        SizeCalculatedFlag& operator=(bool calculated) {
+            value.store(calculated);
+            return *this;
+        }
+        operator bool() const { return value.load(); }
+
+    private:
+        std::atomic<bool> value{false};
+    };
+
     // If the size has been calculated
-    mutable bool sizeCalculated = false;
+    mutable SizeCalculatedFlag sizeCalculated;
 
     mutable double width = 0;
     mutable double height = 0;
@@ -107,4 +146,16 @@ private:
      * The color in RGB format
      */
     Color color{0U};
+
+    /**
+     * The spatial index of the layer containing this element, if any.
+     * Not copied along with the element: a copy does not belong to any layer.
+     */
+    struct IndexLink {
+        SpatialIndex* index = nullptr;
+
+        IndexLink() = default;
+        IndexLink(const IndexLink&) {}
+        IndexLink& operator=(const IndexLink&) { return *this; }
+    } spatialIndex;
 };
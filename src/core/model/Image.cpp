@@ -1,8 +1,11 @@
 #include "Image.h"
 
-#include <algorithm>  // for min
+#include <algorithm>  // for min, max
 #include <array>      // for array
-#include <cmath>      // for sqrt
+#include <cmath>      // for sqrt, ceil, ldexp
+#include <cstdint>    // for uint64_t
+#include <cstdlib>    // for atoi
+#include <mutex>      // for lock_guard
 #include <utility>    // for move, pair
 
 #include <cairo.h>    // for cairo_surface_destroy
@@ -10,22 +13,59 @@
 #include <glib.h>     // for g_assert, guchar
 
 #include "model/Element.h"   // for Element, ELEMENT_IMAGE
-#include "util/Rectangle.h"  // for Rectangle
+#include "util/Rectangle.h"     // for Rectangle
+#include "util/SurfaceCache.h"  // for SurfaceCache
 #include "util/i18n.h"
 #include "util/raii/GObjectSPtr.h"  // for GObjectSPtr
 #include "util/safe_casts.h"
 #include "util/serializing/ObjectInputStream.h"   // for ObjectInputStream
 #include "util/serializing/ObjectOutputStream.h"  // for ObjectOutputStream
 
+using xoj::util::CairoSurfaceSPtr;
 using xoj::util::Rectangle;
 
+namespace {
+/// Max number of pixels: 32M = more than enough for A4 in 72pp
+constexpr uint64_t MAX_SIZE = 1 << 25;
+
+/// Size of a level of the mipmap pyramid of an image of the given size
+std::pair<int, int> getLevelSize(std::pair<int, int> size, int level) {
+    return {std::max(1, ceil_cast<int>(std::ldexp(size.first, -level))),
+            std::max(1, ceil_cast<int>(std::ldexp(size.second, -level)))};
+}
+
+/// Index of the last level of the mipmap pyramid (the 1x1 pixel one)
+int getLastLevel(std::pair<int, int> size) {
+    int level = 0;
+    while (getLevelSize(size, level) != std::make_pair(1, 1)) {
+        level++;
+    }
+    return level;
+}
+
+/// Whether the embedded orientation of the pixbuf swaps its width and height (see
+/// gdk_pixbuf_apply_embedded_orientation)
+bool isTransposed(GdkPixbuf* pixbuf) {
+    const gchar* orientation = gdk_pixbuf_get_option(pixbuf, "orientation");
+    return orientation && std::atoi(orientation) >= 5;
+}
+
+/**
+ * The decoded mipmap levels of all the images. They share a memory budget: the least recently used levels are
+ * dropped first.
+ */
+using DecodedImageCache = xoj::util::SurfaceCache<Image>;
+
+auto getDecodedImageCache() -> DecodedImageCache& {
+    static DecodedImageCache cache(256U * 1024U * 1024U);
+    return cache;
+}
+}  // namespace
+
 Image::Image(): Element(ELEMENT_IMAGE) {}
 
 Image::~Image() {
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
+    clearLevels();
 
     if (this->format) {
         gdk_pixbuf_format_free(this->format);
@@ -43,7 +83,15 @@ auto Image::clone() const -> Element* {
     img->height = this->height;
     img->data = this->data;
 
-    img->image = cairo_surface_reference(this->image);
+    // The clone draws the same pixels: let it start with the levels decoded for this image
+    std::lock_guard<std::mutex> lock(this->decodeMutex);
+    img->imageSize = this->imageSize;
+    img->orientationSwapsSize = this->orientationSwapsSize;
+    for (int level = 0; this->imageSize != NOSIZE && level <= getLastLevel(this->imageSize); level++) {
+        if (auto surface = getDecodedImageCache().get(this, level)) {
+            getDecodedImageCache().put(img, level, std::move(surface));
+        }
+    }
     img->snappedBounds = this->snappedBounds;
     img->sizeCalculated = this->sizeCalculated;
 
@@ -53,20 +101,19 @@ auto Image::clone() const -> Element* {
 void Image::setWidth(double width) {
     this->width = width;
     this->calcSize();
+    notifyBoundsChanged();
 }
 
 void Image::setHeight(double height) {
     this->height = height;
     this->calcSize();
+    notifyBoundsChanged();
 }
 
 void Image::setImage(std::string_view data) { setImage(std::string(data)); }
 
 void Image::setImage(std::string&& data) {
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
+    clearLevels();
     this->data = std::move(data);
 
     if (this->format) {
@@ -110,10 +157,7 @@ void Image::setImage(GdkPixbuf* img) {
 }
 
 void Image::setImage(cairo_surface_t* image) {
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
+    clearLevels();
 
     struct {
         std::string buffer;
@@ -132,38 +176,97 @@ void Image::setImage(cairo_surface_t* image) {
 
 auto Image::renderBuffer() const -> std::optional<std::string> {
     g_assert(data.length() > 0 && "image has no data, cannot render it!");
-    if (this->image) {
+    if (getDecodedImageCache().get(this, 0)) {
         // Already rendered
         return std::nullopt;
     }
+    CairoSurfaceSPtr surface;
+    if (auto error = decodeLevel(0, surface); error.has_value()) {
+        return error;
+    }
+    getDecodedImageCache().put(this, 0, std::move(surface));
+    return std::nullopt;
+}
+
+auto Image::probeImageSize() const -> std::pair<int, int> {
+    struct Header {
+        int width = -1;
+        int height = -1;
+        bool swapped = false;
+    } header;
+
+    // Only feed the loader until it knows the size: the pixels are not decoded
+    xoj::util::GObjectSPtr<GdkPixbufLoader> loader(gdk_pixbuf_loader_new(), xoj::util::adopt);
+    g_signal_connect(loader.get(), "area-prepared", G_CALLBACK(+[](GdkPixbufLoader* self, gpointer h) {
+                         auto* header = static_cast<Header*>(h);
+                         GdkPixbuf* pixbuf = gdk_pixbuf_loader_get_pixbuf(self);
+                         header->width = gdk_pixbuf_get_width(pixbuf);
+                         header->height = gdk_pixbuf_get_height(pixbuf);
+                         header->swapped = isTransposed(pixbuf);
+                     }),
+                     &header);
+    constexpr size_t CHUNK_SIZE = 4096;
+    for (size_t pos = 0; pos < this->data.size() && header.width < 0; pos += CHUNK_SIZE) {
+        size_t len = std::min(CHUNK_SIZE, this->data.size() - pos);
+        if (!gdk_pixbuf_loader_write(loader.get(), reinterpret_cast<const guchar*>(this->data.data() + pos), len,
+                                     nullptr)) {
+            break;
+        }
+    }
+    gdk_pixbuf_loader_close(loader.get(), nullptr);
+
+    if (header.width <= 0 || header.height <= 0) {
+        return NOSIZE;
+    }
+    auto [width, height] = std::make_pair(header.width, header.height);
+    if (static_cast<uint64_t>(width) * static_cast<uint64_t>(height) > MAX_SIZE) {
+        double ratio = static_cast<double>(width) / static_cast<double>(height);
+        height = floor_cast<int>(std::sqrt(MAX_SIZE / ratio));
+        width = floor_cast<int>(height * ratio);
+        g_warning("Trying to open an image too big %d x %d. Resizing it to %d x %d", header.width, header.height,
+                  width, height);
+    }
+    this->orientationSwapsSize = header.swapped;
+    return header.swapped ? std::make_pair(height, width) : std::make_pair(width, height);
+}
+
+auto Image::decodeLevel(int level, CairoSurfaceSPtr& surface) const -> std::optional<std::string> {
+    if (this->imageSize == NOSIZE) {
+        this->imageSize = probeImageSize();
+        if (this->imageSize == NOSIZE) {
+            return std::string(_("Failed to load image")) + "\n" + _("Could not determine image size!");
+        }
+    }
+
+    // Let the loader decode directly at the size of the level (JPEG images are then decoded at a reduced scale)
+    std::pair<int, int> size = getLevelSize(this->imageSize, level);
+    if (this->orientationSwapsSize) {
+        std::swap(size.first, size.second);
+    }
     xoj::util::GObjectSPtr<GdkPixbufLoader> loader(gdk_pixbuf_loader_new(), xoj::util::adopt);
     g_signal_connect(loader.get(), "size-prepared",
-                     G_CALLBACK(+[](GdkPixbufLoader* self, gint width, gint height, gpointer) {
-                         static constexpr uint64_t MAX_SIZE =
-                                 1 << 25;  ///< Max number of pixels: 32M = more than enough for A4 in 72pp
+                     G_CALLBACK(+[](GdkPixbufLoader* self, gint width, gint height, gpointer s) {
+                         auto* size = static_cast<std::pair<int, int>*>(s);
                          if (width <= 0 || height <= 0) {
-                             g_warning("Image::renderBuffer(): non-positive width/height");
+                             g_warning("Image::decodeLevel(): non-positive width/height");
                              return;
                          }
-                         if (static_cast<uint64_t>(width) * static_cast<uint64_t>(height) > MAX_SIZE) {
-                             double ratio = static_cast<double>(width) / static_cast<double>(height);
-                             gint maxHeight = floor_cast<gint>(std::sqrt(MAX_SIZE / ratio));
-                             gint maxWidth = floor_cast<gint>(maxHeight * ratio);
-                             g_warning("Trying to open an image too big %d x %d. Resizing it to %d x %d", width, height,
-                                       maxWidth, maxHeight);
-                             gdk_pixbuf_loader_set_size(self, maxHeight, maxWidth);
+                         if (width != size->first || height != size->second) {
+                             gdk_pixbuf_loader_set_size(self, size->first, size->second);
                          }
                      }),
-                     nullptr);
+                     &size);
     GError* err = nullptr;
     bool success = gdk_pixbuf_loader_write(loader.get(), reinterpret_cast<const guchar*>(this->data.c_str()),
                                            this->data.length(), &err);
     if (!success) {
         if (err != nullptr) {
             std::string msg = std::string(_("Failed to load image")) + "\n" + _("Error: ") + err->message;
-            g_free(err);
+            g_error_free(err);
+            gdk_pixbuf_loader_close(loader.get(), nullptr);
             return msg;
         } else {
+            gdk_pixbuf_loader_close(loader.get(), nullptr);
             return std::string(_("Failed to load image")) + "\n" + _("Unrecoverable error");
         }
     }
@@ -171,7 +274,7 @@ auto Image::renderBuffer() const -> std::optional<std::string> {
     if (!success) {
         if (err != nullptr) {
             std::string msg = std::string(_("Failed to close image stream")) + "\n" + _("Error: ") + err->message;
-            g_free(err);
+            g_error_free(err);
             return msg;
         } else {
             return std::string(_("Failed to close image stream")) + "\n" + _("Unrecoverable error");
@@ -180,30 +283,91 @@ auto Image::renderBuffer() const -> std::optional<std::string> {
 
     GdkPixbuf* tmp = gdk_pixbuf_loader_get_pixbuf(loader.get());
     g_assert(tmp != nullptr);
+    if (bool swapped = isTransposed(tmp); swapped != this->orientationSwapsSize) {
+        // Some loaders only set the orientation once the image is decoded
+        this->orientationSwapsSize = swapped;
+        std::swap(this->imageSize.first, this->imageSize.second);
+    }
     xoj::util::GObjectSPtr<GdkPixbuf> pixbuf(gdk_pixbuf_apply_embedded_orientation(tmp), xoj::util::adopt);
 
-    this->imageSize = {gdk_pixbuf_get_width(pixbuf.get()), gdk_pixbuf_get_height(pixbuf.get())};
-
     // TODO: pass in window once this code is refactored into ImageView
-    this->image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, this->imageSize.first, this->imageSize.second);
-    g_assert(this->image != nullptr);
+    surface.reset(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, gdk_pixbuf_get_width(pixbuf.get()),
+                                             gdk_pixbuf_get_height(pixbuf.get())),
+                  xoj::util::adopt);
+    g_assert(surface);
 
     // Paint the pixbuf on to the surface
     // NOTE: we do this manually instead of using gdk_cairo_surface_create_from_pixbuf
     // since this does not work in CLI mode.
-    cairo_t* cr = cairo_create(this->image);
+    cairo_t* cr = cairo_create(surface.get());
     gdk_cairo_set_source_pixbuf(cr, pixbuf.get(), 0, 0);
     cairo_paint(cr);
     cairo_destroy(cr);
     return std::nullopt;
 }
 
-auto Image::getImage() const -> cairo_surface_t* {
-    if (auto opt = renderBuffer(); opt.has_value()) {
-        // An error occurred
-        g_warning("%s", opt->c_str());
+auto Image::getLevel(int level) const -> CairoSurfaceSPtr {
+    DecodedImageCache& cache = getDecodedImageCache();
+    if (auto surface = cache.get(this, level)) {
+        return surface;
+    }
+
+    CairoSurfaceSPtr surface;
+    if (auto [larger, source] = cache.getClosestLower(this, level); source) {
+        // Downscaling a larger level is much cheaper than decoding the image again
+        auto [width, height] = getLevelSize(this->imageSize, level);
+        surface.reset(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height), xoj::util::adopt);
+        cairo_t* cr = cairo_create(surface.get());
+        cairo_scale(cr, static_cast<double>(width) / cairo_image_surface_get_width(source.get()),
+                    static_cast<double>(height) / cairo_image_surface_get_height(source.get()));
+        cairo_set_source_surface(cr, source.get(), 0, 0);
+        cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+    } else if (auto error = decodeLevel(level, surface); error.has_value()) {
+        g_warning("%s", error->c_str());
+        return nullptr;
+    }
+
+    cache.put(this, level, surface);
+    return surface;
+}
+
+auto Image::getImage() const -> CairoSurfaceSPtr {
+    std::lock_guard<std::mutex> lock(this->decodeMutex);
+    return getLevel(0);
+}
+
+auto Image::getImage(double width, double height) const -> CairoSurfaceSPtr {
+    std::lock_guard<std::mutex> lock(this->decodeMutex);
+    if (this->imageSize == NOSIZE) {
+        this->imageSize = probeImageSize();
+        if (this->imageSize == NOSIZE) {
+            return getLevel(0);
+        }
+    }
+
+    // The smallest level that does not need to be upscaled
+    int level = 0;
+    const int lastLevel = getLastLevel(this->imageSize);
+    while (level < lastLevel) {
+        auto [w, h] = getLevelSize(this->imageSize, level + 1);
+        if (w < width || h < height) {
+            break;
+        }
+        level++;
     }
-    return this->image;
+    return getLevel(level);
+}
+
+void Image::setDecodedMemoryBudget(size_t bytes) { getDecodedImageCache().setMemoryBudget(bytes); }
+
+auto Image::getDecodedMemoryBudget() -> size_t { return getDecodedImageCache().getMemoryBudget(); }
+
+void Image::clearLevels() {
+    getDecodedImageCache().remove(this);
+    this->imageSize = NOSIZE;
+    this->orientationSwapsSize = false;
 }
 
 void Image::scale(double x0, double y0, double fx, double fy, double rotation,
@@ -218,6 +382,7 @@ void Image::scale(double x0, double y0, double fx, double fy, double rotation,
     this->width *= fx;
     this->height *= fy;
     this->calcSize();
+    notifyBoundsChanged();
 }
 
 void Image::rotate(double x0, double y0, double th) {}
@@ -243,11 +408,7 @@ void Image::readSerialized(ObjectInputStream& in) {
     this->width = in.readDouble();
     this->height = in.readDouble();
 
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
-
+    clearLevels();
     this->data = in.readImage();
 
     in.endObject();
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <cstddef>      // for size_t
+#include <mutex>        // for mutex
 #include <optional>     // for optional
 #include <string>       // for string
 #include <string_view>  // for string_view
@@ -20,6 +21,8 @@
 #include <cairo.h>                  // for cairo_surface_t, cairo_status_t
 #include <gdk-pixbuf/gdk-pixbuf.h>  // for GdkPixbufFormat, GdkPixbuf
 
+#include "util/raii/CairoWrappers.h"  // for CairoSurfaceSPtr
+
 #include "Element.h"  // for Element
 
 class ObjectInputStream;
@@ -52,12 +55,21 @@ public:
     /// FIXME: remove this method. Currently, it is used by Control::clipboardPasteImage.
     [[deprecated]] void setImage(GdkPixbuf* img);
 
-    /// The image is rendered lazily by default; call this method to render it.
+    /// The image is rendered lazily by default; call this method to render it at full resolution.
     /// Returns std::nullopt on success, an error message on failure
     std::optional<std::string> renderBuffer() const;
 
-    /// Returns the internal surface that contains the rendered image data.
-    cairo_surface_t* getImage() const;
+    /// Returns a surface containing the image rendered at full resolution, or nullptr if it cannot be decoded.
+    xoj::util::CairoSurfaceSPtr getImage() const;
+
+    /// Returns the smallest level of the mipmap pyramid (the full resolution image, then halved in size at each level)
+    /// that is at least `width` x `height` pixels large, or nullptr if the image cannot be decoded.
+    xoj::util::CairoSurfaceSPtr getImage(double width, double height) const;
+
+    /// Set the amount of memory all the decoded images may use together. The least recently used levels are freed
+    /// first; they are decoded again from the raw data when needed.
+    static void setDecodedMemoryBudget(size_t bytes);
+    static size_t getDecodedMemoryBudget();
 
     void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) override;
     void rotate(double x0, double y0, double th) override;
@@ -89,6 +101,19 @@ private:
 
     static cairo_status_t cairoReadFunction(const Image* image, unsigned char* data, unsigned int length);
 
+    /// Reads the image size (once its embedded orientation is applied) from the header of the raw data
+    std::pair<int, int> probeImageSize() const;
+
+    /// Returns the given level of the mipmap pyramid, decoding or downscaling it if it is not cached
+    xoj::util::CairoSurfaceSPtr getLevel(int level) const;
+
+    /// Decodes the raw data at the size of the given level.
+    /// Returns std::nullopt on success, an error message on failure
+    std::optional<std::string> decodeLevel(int level, xoj::util::CairoSurfaceSPtr& surface) const;
+
+    /// Drops the decoded levels of this image
+    void clearLevels();
+
 private:
     /// Set the image data by rendering the surface to PNG and copying the PNG data.
     ///
@@ -97,12 +122,17 @@ private:
     /// FIXME: remove this when setImage(GdkPixbuf*) is removed.
     [[deprecated]] void setImage(cairo_surface_t* image);
 
-    /// Temporary surface used as a render buffer.
-    mutable cairo_surface_t* image = nullptr;
-
     /// Image format information.
     mutable GdkPixbufFormat* format = nullptr;
+
+    /// Size of the image once its embedded orientation is applied (before any resizing of overly large images)
     mutable std::pair<int, int> imageSize = {-1, -1};
 
+    /// Whether the embedded orientation swaps the width and the height of the raw image
+    mutable bool orientationSwapsSize = false;
+
+    /// Serializes the probing and decoding of the image, which several readers of the document may request together
+    mutable std::mutex decodeMutex;
+
     std::string data;
 };
@@ -3,6 +3,7 @@
 #include <glib.h>  // for g_warning
 
 #include "model/Element.h"    // for Element, Element::Index, Element::Inval...
+#include "util/Range.h"       // for Range
 #include "util/Stacktrace.h"  // for Stacktrace
 
 Layer::Layer() = default;
@@ -39,6 +40,8 @@ void Layer::addElement(Element* e) {
     }
 
     this->elements.push_back(e);
+    this->spatialIndex.add(e);
+    e->setSpatialIndex(&this->spatialIndex);
 }
 
 void Layer::insertElement(Element* e, Element::Index pos) {
@@ -65,9 +68,12 @@ void Layer::insertElement(Element* e, Element::Index pos) {
     // If the element should be inserted at the top
     if (pos >= static_cast<int>(this->elements.size())) {
         this->elements.push_back(e);
+        this->spatialIndex.add(e);
     } else {
         this->elements.insert(this->elements.begin() + pos, e);
+        this->spatialIndex.insert(e, static_cast<size_t>(pos), this->elements);
     }
+    e->setSpatialIndex(&this->spatialIndex);
 }
 
 auto Layer::indexOf(Element* e) const -> Element::Index {
@@ -84,6 +90,8 @@ auto Layer::removeElement(Element* e, bool free) -> Element::Index {
     for (unsigned int i = 0; i < this->elements.size(); i++) {
         if (e == this->elements[i]) {
             this->elements.erase(this->elements.begin() + i);
+            this->spatialIndex.remove(e);
+            e->setSpatialIndex(nullptr);
 
             if (free) {
                 delete e;
@@ -97,7 +105,11 @@ auto Layer::removeElement(Element* e, bool free) -> Element::Index {
     return Element::InvalidIndex;
 }
 
-void Layer::clearNoFree() { this->elements.clear(); }
+void Layer::clearNoFree() {
+    for (Element* e: this->elements) { e->setSpatialIndex(nullptr); }
+    this->elements.clear();
+    this->spatialIndex.clear();
+}
 
 auto Layer::isAnnotated() const -> bool { return !this->elements.empty(); }
 
@@ -113,6 +125,8 @@ void Layer::setVisible(bool visible) { this->visible = visible; }
 
 auto Layer::getElements() const -> const std::vector<Element*>& { return this->elements; }
 
+auto Layer::getElementsInRange(const Range& rg) const -> std::vector<Element*> { return this->spatialIndex.query(rg); }
+
 auto Layer::hasName() const -> bool { return name.has_value(); }
 
 auto Layer::getName() const -> std::string { return name.value_or(""); }
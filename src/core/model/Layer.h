@@ -16,7 +16,10 @@
 #include <string>    // for string
 #include <vector>    // for vector
 
-#include "Element.h"  // for Element, Element::Index
+#include "Element.h"       // for Element, Element::Index
+#include "SpatialIndex.h"  // for SpatialIndex
+
+class Range;
 
 template <class T>
 using optional = std::optional<T>;
@@ -63,6 +66,12 @@ public:
      */
     const std::vector<Element*>& getElements() const;
 
+    /**
+     * Returns the Element%s whose bounding box intersects the given range, in the same order as getElements().
+     * Only the bounding boxes are checked: the caller must test the actual shape of the elements if required.
+     */
+    std::vector<Element*> getElementsInRange(const Range& rg) const;
+
     /**
      * Returns whether or not the Layer is empty
      */
@@ -101,6 +110,11 @@ public:
 private:
     std::vector<Element*> elements;
 
+    /**
+     * Index of the elements' bounding boxes, for fast lookup of the elements in a given area
+     */
+    SpatialIndex spatialIndex;
+
     bool visible = true;
 
     optional<std::string> name;
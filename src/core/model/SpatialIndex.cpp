@@ -0,0 +1,196 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>  // for clamp, find, sort, unique
+#include <cmath>      // for floor
+#include <limits>     // for numeric_limits
+#include <utility>    // for pair
+
+#include "model/Element.h"    // for Element
+#include "util/Rectangle.h"  // for Rectangle
+
+auto SpatialIndex::CellRange::count() const -> size_t {
+    return static_cast<size_t>(maxX - minX + 1) * static_cast<size_t>(maxY - minY + 1);
+}
+
+auto SpatialIndex::cellsOf(const Range& rg) -> CellRange {
+    constexpr double LIMIT = std::numeric_limits<int32_t>::max() / 2;
+    auto toCell = [](double v) { return static_cast<int32_t>(std::clamp(std::floor(v / CELL_SIZE), -LIMIT, LIMIT)); };
+    return {toCell(rg.minX), toCell(rg.minY), toCell(rg.maxX), toCell(rg.maxY)};
+}
+
+auto SpatialIndex::cellKey(int32_t x, int32_t y) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32U) | static_cast<uint32_t>(y);
+}
+
+void SpatialIndex::add(Element* e) {
+    std::lock_guard lock(this->mutex);
+    addUnlocked(e, this->nextOrder);
+    this->nextOrder += ORDER_STEP;
+}
+
+void SpatialIndex::insert(Element* e, size_t pos, const std::vector<Element*>& elements) {
+    std::lock_guard lock(this->mutex);
+    if (pos + 1 >= elements.size()) {
+        addUnlocked(e, this->nextOrder);
+        this->nextOrder += ORDER_STEP;
+        return;
+    }
+
+    uint64_t lower = pos > 0 ? this->entries.at(elements[pos - 1]).order : 0;
+    uint64_t upper = this->entries.at(elements[pos + 1]).order;
+    if (upper - lower >= 2) {
+        addUnlocked(e, lower + (upper - lower) / 2);
+    } else {
+        // No room left between the neighbours
+        addUnlocked(e, 0);
+        renumber(elements);
+    }
+}
+
+void SpatialIndex::addUnlocked(Element* e, uint64_t order) {
+    // The element is linked into the grid by the next query: this avoids computing the bounding boxes of all the
+    // elements when loading a document.
+    auto [it, inserted] = this->entries.emplace(e, Entry{order, Range(), CellRange{}, false, true});
+    if (inserted) {
+        this->dirtyElements.push_back(e);
+    }
+}
+
+void SpatialIndex::renumber(const std::vector<Element*>& elements) {
+    uint64_t order = ORDER_STEP;
+    for (Element* e: elements) {
+        if (auto it = this->entries.find(e); it != this->entries.end()) {
+            it->second.order = order;
+            order += ORDER_STEP;
+        }
+    }
+    this->nextOrder = order;
+}
+
+void SpatialIndex::remove(Element* e) {
+    std::lock_guard lock(this->mutex);
+    auto it = this->entries.find(e);
+    if (it == this->entries.end()) {
+        return;
+    }
+    unlink(e, it->second);
+    this->entries.erase(it);
+}
+
+void SpatialIndex::clear() {
+    std::lock_guard lock(this->mutex);
+    this->entries.clear();
+    this->cells.clear();
+    this->largeElements.clear();
+    this->dirtyElements.clear();
+    this->nextOrder = ORDER_STEP;
+}
+
+void SpatialIndex::markDirty(Element* e) {
+    std::lock_guard lock(this->mutex);
+    auto it = this->entries.find(e);
+    if (it == this->entries.end() || it->second.dirty) {
+        return;
+    }
+    unlink(e, it->second);
+    it->second.dirty = true;
+    this->dirtyElements.push_back(e);
+}
+
+void SpatialIndex::link(Element* e, Entry& entry) const {
+    entry.bounds = Range(e->boundingRect());
+    entry.cells = cellsOf(entry.bounds);
+    entry.dirty = false;
+    entry.large = entry.cells.count() > MAX_CELLS_PER_ELEMENT;
+
+    if (entry.large) {
+        this->largeElements.push_back(e);
+        return;
+    }
+    for (int32_t y = entry.cells.minY; y <= entry.cells.maxY; y++) {
+        for (int32_t x = entry.cells.minX; x <= entry.cells.maxX; x++) { this->cells[cellKey(x, y)].push_back(e); }
+    }
+}
+
+void SpatialIndex::unlink(Element* e, Entry& entry) {
+    auto eraseFrom = [e](std::vector<Element*>& list) {
+        if (auto it = std::find(list.begin(), list.end(), e); it != list.end()) {
+            list.erase(it);
+        }
+    };
+
+    if (entry.dirty) {
+        // Dirty elements are not in the grid
+        eraseFrom(this->dirtyElements);
+        return;
+    }
+    if (entry.large) {
+        eraseFrom(this->largeElements);
+        return;
+    }
+    for (int32_t y = entry.cells.minY; y <= entry.cells.maxY; y++) {
+        for (int32_t x = entry.cells.minX; x <= entry.cells.maxX; x++) {
+            auto it = this->cells.find(cellKey(x, y));
+            if (it == this->cells.end()) {
+                continue;
+            }
+            eraseFrom(it->second);
+            if (it->second.empty()) {
+                this->cells.erase(it);
+            }
+        }
+    }
+}
+
+void SpatialIndex::refreshDirty() const {
+    for (Element* e: this->dirtyElements) { link(e, this->entries.at(e)); }
+    this->dirtyElements.clear();
+}
+
+auto SpatialIndex::query(const Range& rg) const -> std::vector<Element*> {
+    std::lock_guard lock(this->mutex);
+    refreshDirty();
+
+    std::vector<Element*> res;
+    if (rg.empty() || !rg.isValid()) {
+        return res;
+    }
+
+    std::vector<std::pair<uint64_t, Element*>> candidates;
+    auto consider = [&](Element* e) {
+        const Entry& entry = this->entries.at(e);
+        const Range& b = entry.bounds;
+        if (b.minX <= rg.maxX && b.maxX >= rg.minX && b.minY <= rg.maxY && b.maxY >= rg.minY) {
+            candidates.emplace_back(entry.order, e);
+        }
+    };
+
+    const CellRange q = cellsOf(rg);
+    if (q.count() <= this->cells.size()) {
+        for (int32_t y = q.minY; y <= q.maxY; y++) {
+            for (int32_t x = q.minX; x <= q.maxX; x++) {
+                if (auto it = this->cells.find(cellKey(x, y)); it != this->cells.end()) {
+                    for (Element* e: it->second) { consider(e); }
+                }
+            }
+        }
+    } else {
+        // The query covers more cells than are allocated: walk the allocated ones
+        for (auto&& [key, list]: this->cells) {
+            auto x = static_cast<int32_t>(static_cast<uint32_t>(key >> 32U));
+            auto y = static_cast<int32_t>(static_cast<uint32_t>(key));
+            if (q.minX <= x && x <= q.maxX && q.minY <= y && y <= q.maxY) {
+                for (Element* e: list) { consider(e); }
+            }
+        }
+    }
+    for (Element* e: this->largeElements) { consider(e); }
+
+    // Elements spanning several cells were found several times
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    res.reserve(candidates.size());
+    for (auto&& [order, e]: candidates) { res.push_back(e); }
+    return res;
+}
@@ -0,0 +1,127 @@
+/*
+ * Xournal++
+ *
+ * Spatial index of the elements of a layer
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>        // for size_t
+#include <cstdint>        // for uint64_t, int32_t
+#include <mutex>          // for mutex
+#include <unordered_map>  // for unordered_map
+#include <vector>         // for vector
+
+#include "util/Range.h"  // for Range
+
+class Element;
+
+/**
+ * @brief Uniform grid over the page, mapping each cell to the elements whose bounding box overlaps it.
+ *
+ * The index is maintained incrementally by the Layer owning it. Elements notify the index when their bounding box
+ * changes (see Element::notifyBoundsChanged()); such elements are re-inserted lazily on the next query.
+ *
+ * Queries return the elements in z-order (i.e. in the order of the Layer's element list).
+ * All methods are thread safe.
+ */
+class SpatialIndex {
+public:
+    /**
+     * Side length of a grid cell, in page coordinates
+     */
+    static constexpr double CELL_SIZE = 32.0;
+
+    SpatialIndex() = default;
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+    ~SpatialIndex() = default;
+
+    /**
+     * @brief Add an element on top of all the others
+     */
+    void add(Element* e);
+
+    /**
+     * @brief Add an element at the given position
+     * @param elements The element list of the layer, already containing e at position pos
+     */
+    void insert(Element* e, size_t pos, const std::vector<Element*>& elements);
+
+    void remove(Element* e);
+
+    void clear();
+
+    /**
+     * @brief The bounding box of e has (possibly) changed
+     */
+    void markDirty(Element* e);
+
+    /**
+     * @brief Get the elements whose bounding box intersects rg, in z-order.
+     * The result can contain elements which do not intersect rg: the caller must still check the actual geometry.
+     */
+    std::vector<Element*> query(const Range& rg) const;
+
+private:
+    struct CellRange {
+        int32_t minX;
+        int32_t minY;
+        int32_t maxX;
+        int32_t maxY;
+
+        size_t count() const;
+    };
+
+    struct Entry {
+        /**
+         * Sort key for the z-order. Strictly increasing along the Layer's element list.
+         */
+        uint64_t order;
+
+        Range bounds;
+        CellRange cells;
+
+        /**
+         * The element spans too many cells, and is stored in the list of large elements instead
+         */
+        bool large;
+
+        bool dirty;
+    };
+
+    static CellRange cellsOf(const Range& rg);
+    static uint64_t cellKey(int32_t x, int32_t y);
+
+    void addUnlocked(Element* e, uint64_t order);
+    void link(Element* e, Entry& entry) const;
+    void unlink(Element* e, Entry& entry);
+    void refreshDirty() const;
+    void renumber(const std::vector<Element*>& elements);
+
+private:
+    mutable std::mutex mutex;
+
+    /**
+     * Elements spanning more than this number of cells are not stored in the grid
+     */
+    static constexpr size_t MAX_CELLS_PER_ELEMENT = 256;
+
+    /**
+     * Gap between the order keys of consecutive elements, leaving room for insertions
+     */
+    static constexpr uint64_t ORDER_STEP = 1U << 16U;
+
+    // Mutable, as dirty elements are re-inserted lazily by queries
+    mutable std::unordered_map<Element*, Entry> entries;
+    mutable std::unordered_map<uint64_t, std::vector<Element*>> cells;
+    mutable std::vector<Element*> largeElements;
+    mutable std::vector<Element*> dirtyElements;
+
+    uint64_t nextOrder = ORDER_STEP;
+};
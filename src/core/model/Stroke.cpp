@@ -6,21 +6,23 @@
 #include <cstdint>    // for uint64_t
 #include <iterator>   // for back_insert_iterator
 #include <limits>     // for numeric_limits
+#include <memory>     // for atomic_load, atomic_store, shared_ptr
 #include <numeric>    // for accumulate
 #include <optional>   // for optional, nullopt
 #include <string>     // for to_string, operator<<
+#include <utility>    // for move
 
 #include <cairo.h>  // for cairo_matrix_translate
 #include <glib.h>   // for g_free, g_message
 
 #include "eraser/PaddedBox.h"                     // for PaddedBox
+#include "eraser/SegmentBoxFilter.h"              // for findSegmentNearBox
 #include "model/AudioElement.h"                   // for AudioElement
 #include "model/Element.h"                        // for Element, ELEMENT_ST...
 #include "model/LineStyle.h"                      // for LineStyle
 #include "model/Point.h"                          // for Point, Point::NO_PR...
 #include "util/BasePointerIterator.h"             // for BasePointerIterator
 #include "util/Interval.h"                        // for Interval
-#include "util/PairView.h"                        // for PairView<>::BaseIte...
 #include "util/PlaceholderString.h"               // for PlaceholderString
 #include "util/Rectangle.h"                       // for Rectangle
 #include "util/SmallVector.h"                     // for SmallVector
@@ -35,6 +37,12 @@
 
 using xoj::util::Rectangle;
 
+/**
+ * Margin added around the boxes given to SegmentBoxFilter. The rounding errors of the exact intersection tests are of
+ * the order of 1e-16 times the coordinates, far below it for any page size.
+ */
+constexpr double SEGMENT_FILTER_MARGIN = 1e-6;
+
 #define COMMA ,
 // #define ENABLE_ERASER_DEBUG // See config-debug.h.in
 #ifdef ENABLE_ERASER_DEBUG
@@ -105,6 +113,7 @@ auto Stroke::cloneStroke() const -> Stroke* {
     s->Element::height = this->Element::height;
     s->snappedBounds = this->snappedBounds;
     s->sizeCalculated = this->sizeCalculated;
+    s->setCachedGeometry(getCachedGeometry());
     return s;
 }
 
@@ -120,16 +129,16 @@ std::unique_ptr<Stroke> Stroke::cloneSection(const PathParameter& lowerBound, co
 
     s->points.reserve(upperBound.index - lowerBound.index + 2);
 
-    s->points.emplace_back(this->getPoint(lowerBound));
+    s->points.push_back(this->getPoint(lowerBound));
 
     auto beginIt = std::next(this->points.cbegin(), (std::ptrdiff_t)lowerBound.index + 1);
     auto endIt = std::next(this->points.cbegin(), (std::ptrdiff_t)upperBound.index + 1);
     std::copy(beginIt, endIt, std::back_inserter(s->points));
 
-    s->points.emplace_back(this->getPoint(upperBound));
+    s->points.push_back(this->getPoint(upperBound));
 
     // Remove unused pressure value
-    s->points.back().z = Point::NO_PRESSURE;
+    s->points.setPressure(s->points.size() - 1, Point::NO_PRESSURE);
 
     return s;
 }
@@ -145,7 +154,7 @@ std::unique_ptr<Stroke> Stroke::cloneCircularSectionOfClosedStroke(const PathPar
 
     s->points.reserve(this->points.size() - startParam.index + endParam.index + 1);
 
-    s->points.emplace_back(this->getPoint(startParam));
+    s->points.push_back(this->getPoint(startParam));
 
     auto startIt = std::next(this->points.cbegin(), (std::ptrdiff_t)startParam.index + 1);
     // Skip the last point: points.back().equalPos(points.front()) == true and we want this point only once
@@ -155,10 +164,10 @@ std::unique_ptr<Stroke> Stroke::cloneCircularSectionOfClosedStroke(const PathPar
     auto endIt = std::next(this->points.cbegin(), (std::ptrdiff_t)endParam.index + 1);
     std::copy(this->points.cbegin(), endIt, std::back_inserter(s->points));
 
-    s->points.emplace_back(this->getPoint(endParam));
+    s->points.push_back(this->getPoint(endParam));
 
     // Remove unused pressure value
-    s->points.back().z = Point::NO_PRESSURE;
+    s->points.setPressure(s->points.size() - 1, Point::NO_PRESSURE);
 
     return s;
 }
@@ -176,7 +185,9 @@ void Stroke::serialize(ObjectOutputStream& out) const {
 
     out.writeInt(this->capStyle);
 
-    out.writeData(this->points.data(), this->points.size(), sizeof(Point));
+    // Same format as a std::vector<Point>
+    const std::vector<Point> pts = this->points.toVector();
+    out.writeData(pts.data(), pts.size(), sizeof(Point));
 
     this->lineStyle.serialize(out);
 
@@ -196,8 +207,11 @@ void Stroke::readSerialized(ObjectInputStream& in) {
 
     this->capStyle = static_cast<StrokeCapStyle>(in.readInt());
 
-    in.readData(this->points);
+    std::vector<Point> pts;
+    in.readData(pts);
+    this->points.assign(pts);
     this->lineStyle.readSerialized(in);
+    invalidateGeometry();
 
     in.endObject();
 }
@@ -220,7 +234,10 @@ auto Stroke::getFill() const -> int { return fill; }
  */
 void Stroke::setFill(int fill) { this->fill = fill; }
 
-void Stroke::setWidth(double width) { this->width = width; }
+void Stroke::setWidth(double width) {
+    this->width = width;
+    notifyBoundsChanged();
+}
 
 auto Stroke::getWidth() const -> double { return this->width; }
 
@@ -240,7 +257,9 @@ auto Stroke::isInSelection(ShapeContainer* container) const -> bool {
 }
 
 void Stroke::addPoint(const Point& p) {
-    this->points.emplace_back(p);
+    this->points.push_back(p);
+    invalidateGeometry();
+    notifyBoundsChanged();
     if (!sizeCalculated) {
         return;
     }
@@ -255,11 +274,13 @@ void Stroke::addPoint(const Point& p) {
 
 auto Stroke::getPointCount() const -> int { return this->points.size(); }
 
-auto Stroke::getPointVector() const -> std::vector<Point> const& { return points; }
+auto Stroke::getPointVector() const -> StrokePoints const& { return points; }
 
 void Stroke::deletePointsFrom(size_t index) {
-    points.resize(std::min(index, points.size()));
+    points.truncate(index);
+    invalidateGeometry();
     this->sizeCalculated = false;
+    notifyBoundsChanged();
 }
 
 auto Stroke::getPoint(int index) const -> Point {
@@ -267,21 +288,20 @@ auto Stroke::getPoint(int index) const -> Point {
         g_warning("Stroke::getPoint(%i) out of bounds!", index);
         return Point(0, 0, Point::NO_PRESSURE);
     }
-    return points.at(index);
+    return points[static_cast<size_t>(index)];
 }
 
 Point Stroke::getPoint(PathParameter parameter) const {
     assert(parameter.isValid() && parameter.index < this->points.size() - 1);
 
-    const Point& p = this->points[parameter.index];
+    const Point p = this->points[parameter.index];
     Point res = p.relativeLineTo(this->points[parameter.index + 1], parameter.t);
     res.z = p.z;  // The point's width should be that of the segment's first point
     return res;
 }
 
-auto Stroke::getPoints() const -> const Point* { return this->points.data(); }
-
 void Stroke::setPointVectorInternal(const Range* const snappingBox) {
+    invalidateGeometry();
     if (!snappingBox || this->points.empty() || this->points.front().z != Point::NO_PRESSURE) {
         // We cannot deduce the bounding box from the snapping box if the stroke has pressure values
         this->sizeCalculated = false;
@@ -294,20 +314,16 @@ void Stroke::setPointVectorInternal(const Range* const snappingBox) {
         Element::height = snappingBox->getHeight() + this->width;
         this->sizeCalculated = true;
     }
+    notifyBoundsChanged();
 }
 
 void Stroke::setPointVector(const std::vector<Point>& other, const Range* const snappingBox) {
-    this->points = other;
+    this->points.assign(other);
     this->setPointVectorInternal(snappingBox);
 }
 
-void Stroke::setPointVector(std::vector<Point>&& other, const Range* const snappingBox) {
-    this->points = std::move(other);
-    this->setPointVectorInternal(snappingBox);
-}
 
-
-void Stroke::freeUnusedPointItems() { this->points = {begin(this->points), end(this->points)}; }
+void Stroke::freeUnusedPointItems() { this->points.shrinkToFit(); }
 
 void Stroke::setToolType(StrokeTool type) { this->toolType = type; }
 
@@ -318,13 +334,15 @@ void Stroke::setLineStyle(const LineStyle& style) { this->lineStyle = style; }
 auto Stroke::getLineStyle() const -> const LineStyle& { return this->lineStyle; }
 
 void Stroke::move(double dx, double dy) {
-    for (auto&& point: points) {
-        point.x += dx;
-        point.y += dy;
-    }
+    points.transformCoordinates([dx, dy](double& x, double& y) {
+        x += dx;
+        y += dy;
+    });
     Element::x += dx;
     Element::y += dy;
     Element::snappedBounds = Element::snappedBounds.translated(dx, dy);
+    invalidateGeometry();
+    notifyBoundsChanged();
 }
 
 void Stroke::rotate(double x0, double y0, double th) {
@@ -334,10 +352,11 @@ void Stroke::rotate(double x0, double y0, double th) {
     cairo_matrix_rotate(&rotMatrix, th);
     cairo_matrix_translate(&rotMatrix, -x0, -y0);
 
-    for (auto&& p: points) {
-        cairo_matrix_transform_point(&rotMatrix, &p.x, &p.y);
-    }
+    points.transformCoordinates(
+            [&rotMatrix](double& x, double& y) { cairo_matrix_transform_point(&rotMatrix, &x, &y); });
+    invalidateGeometry();
     this->sizeCalculated = false;
+    notifyBoundsChanged();
     // Width and Height will likely be changed after this operation
 }
 
@@ -351,16 +370,14 @@ void Stroke::scale(double x0, double y0, double fx, double fy, double rotation,
     cairo_matrix_rotate(&scaleMatrix, -rotation);
     cairo_matrix_translate(&scaleMatrix, -x0, -y0);
 
-    for (auto&& p: points) {
-        cairo_matrix_transform_point(&scaleMatrix, &p.x, &p.y);
-
-        if (p.z != Point::NO_PRESSURE) {
-            p.z *= fz;
-        }
-    }
+    points.transformCoordinates(
+            [&scaleMatrix](double& x, double& y) { cairo_matrix_transform_point(&scaleMatrix, &x, &y); });
+    points.scalePressures(fz);
     this->width *= fz;
 
+    invalidateGeometry();
     this->sizeCalculated = false;
+    notifyBoundsChanged();
 }
 
 auto Stroke::hasPressure() const -> bool {
@@ -371,7 +388,7 @@ auto Stroke::hasPressure() const -> bool {
 }
 
 auto Stroke::getAvgPressure() const -> double {
-    return std::accumulate(begin(this->points), end(this->points), 0.0,
+    return std::accumulate(this->points.begin(), this->points.end(), 0.0,
                            [](double l, Point const& p) { return l + p.z; }) /
            this->points.size();
 }
@@ -384,8 +401,8 @@ void Stroke::updateBoundsLastTwoPressures() {
     auto const pointCount = this->getPointCount();
     assert(pointCount >= 2);
 
-    Point& p = this->points.back();
-    Point& p2 = this->points[pointCount - 2];
+    const Point p = this->points.back();
+    const Point p2 = this->points[pointCount - 2];
     double pressure = p2.z;
 
     updateSnappedBounds(snappedBounds, p);
@@ -397,26 +414,28 @@ void Stroke::scalePressure(double factor) {
     if (!hasPressure()) {
         return;
     }
-    for (auto&& p: this->points) {
-        p.z *= factor;
-    }
+    this->points.scalePressures(factor);
+    invalidateGeometry();
     this->sizeCalculated = false;
+    notifyBoundsChanged();
 }
 
 void Stroke::setLastPressure(double pressure) {
     if (!this->points.empty()) {
         assert(pressure != Point::NO_PRESSURE);
-        Point& back = this->points.back();
-        back.z = pressure;
+        this->points.setPressure(this->points.size() - 1, pressure);
+        invalidateGeometry();
+        notifyBoundsChanged();
     }
 }
 
 void Stroke::setSecondToLastPressure(double pressure) {
     auto const pointCount = this->getPointCount();
     if (pointCount >= 2) {
-        Point& p = this->points[pointCount - 2];
-        p.z = pressure;
+        this->points.setPressure(pointCount - 2, pressure);
+        invalidateGeometry();
         updateBoundsLastTwoPressures();
+        notifyBoundsChanged();
     }
 }
 
@@ -429,8 +448,10 @@ void Stroke::setPressure(const std::vector<double>& pressure) {
 
     auto max_size = std::min(pressure.size(), this->points.size() - 1);
     for (size_t i = 0U; i != max_size; ++i) {
-        this->points[i].z = pressure[i];
+        this->points.setPressure(i, pressure[i]);
     }
+    invalidateGeometry();
+    notifyBoundsChanged();
 }
 
 /**
@@ -453,12 +474,10 @@ auto Stroke::intersects(double x, double y, double halfEraserSize, double* gap)
     double y1 = y - halfEraserSize;
     double y2 = y + halfEraserSize;
 
-    double lastX = points[0].x;
-    double lastY = points[0].y;
-    for (auto&& point: points) {
-        double px = point.x;
-        double py = point.y;
+    constexpr double PADDING = 0.1;
 
+    // Tests the point (px, py) and the segment joining it to the previous point (lastX, lastY)
+    auto intersectsSegment = [&](double lastX, double lastY, double px, double py) -> bool {
         if (px >= x1 && py >= y1 && px <= x2 && py <= y2) {
             if (gap) {
                 *gap = 0;
@@ -488,8 +507,6 @@ auto Stroke::intersects(double x, double y, double halfEraserSize, double* gap)
 
                 distance -= halfEraserSize * std::sqrt(2);
 
-                constexpr double PADDING = 0.1;
-
                 if (distance <= len / 2 + PADDING) {
                     if (gap) {
                         *gap = distance;
@@ -498,9 +515,30 @@ auto Stroke::intersects(double x, double y, double halfEraserSize, double* gap)
                 }
             }
         }
+        return false;
+    };
 
-        lastX = px;
-        lastY = py;
+    const auto& coords = this->points.getCoordinates();
+    if (intersectsSegment(coords[0].x, coords[0].y, coords[0].x, coords[0].y)) {
+        return true;
+    }
+    if (coords.size() < 2) {
+        return false;
+    }
+
+    /*
+     * By the above tests, a segment is only hit if the center of the eraser box is at most
+     * halfEraserSize * (1 + sqrt(2)) + PADDING away from it. The segments farther away are skipped in batches. The
+     * margin is slightly enlarged to absorb the rounding errors, so that the result does not change.
+     */
+    const double margin = (halfEraserSize * (1 + std::sqrt(2)) + PADDING) * (1 + 1e-9) + SEGMENT_FILTER_MARGIN;
+    const Rectangle<double> nearBox(x - margin, y - margin, 2 * margin, 2 * margin);
+    const size_t last = coords.size() - 2;
+    for (size_t i = SegmentBoxFilter::findSegmentNearBox(coords.data(), 0, last, nearBox); i <= last;
+         i = SegmentBoxFilter::findSegmentNearBox(coords.data(), i + 1, last, nearBox)) {
+        if (intersectsSegment(coords[i].x, coords[i].y, coords[i + 1].x, coords[i + 1].y)) {
+            return true;
+        }
     }
 
     return false;
@@ -617,10 +655,7 @@ auto Stroke::intersectWithPaddedBox(const PaddedBox& box, size_t firstIndex, siz
 
     size_t index = firstIndex;
 
-    const PairView segments(this->points);
-    auto segmentIt = std::next(segments.begin(), (std::ptrdiff_t)index);
-
-    Flags flags = initializeFlagsFromHalfTangentAtFirstKnot(segmentIt.first(), segmentIt.second());
+    Flags flags = initializeFlagsFromHalfTangentAtFirstKnot(this->points[index], this->points[index + 1]);
 
     DEBUG_ERASER(auto debugstream = serdes_stream<std::stringstream>();
                  debugstream << "Stroke::intersectWithPaddedBox debug:\n"; debugstream << std::boolalpha;
@@ -714,9 +749,17 @@ auto Stroke::intersectWithPaddedBox(const PaddedBox& box, size_t firstIndex, siz
         DEBUG_ERASER(debugstream << "|  |__** result.size() = " << std::setw(3) << result.size() << std::endl;)
     };
 
-    auto endSegmentIt = std::next(segments.begin(), (std::ptrdiff_t)(lastIndex + 1));
-    for (; segmentIt != endSegmentIt; segmentIt++, index++) {
-        processSegment(segmentIt.first(), segmentIt.second(), index);
+    /*
+     * processSegment() does nothing for the segments which are away from outerBox: skip them in batches. The margin
+     * absorbs the rounding errors of intersectLineWithRectangle(), so that no segment it would find is skipped.
+     */
+    const auto& coords = this->points.getCoordinates();
+    const Rectangle<double> nearBox(outerBox.x - SEGMENT_FILTER_MARGIN, outerBox.y - SEGMENT_FILTER_MARGIN,
+                                    outerBox.width + 2 * SEGMENT_FILTER_MARGIN,
+                                    outerBox.height + 2 * SEGMENT_FILTER_MARGIN);
+    for (index = SegmentBoxFilter::findSegmentNearBox(coords.data(), index, lastIndex, nearBox); index <= lastIndex;
+         index = SegmentBoxFilter::findSegmentNearBox(coords.data(), index + 1, lastIndex, nearBox)) {
+        processSegment(this->points[index], this->points[index + 1], index);
     }
 
     auto isHalfTangentAtLastKnotGoingTowardInnerBox =
@@ -735,13 +778,13 @@ auto Stroke::intersectWithPaddedBox(const PaddedBox& box, size_t firstIndex, siz
     bool inconsistentResults = false;
     if (result.size() % 2) {
         // Not necessarily inconsistent: could be the stroke ends in outerBox
-        --segmentIt;
-        const Point& lastPoint = segmentIt.second();
+        const Point lastPoint = this->points[index];
 
         DEBUG_ERASER(debugstream << "|  |  Odd number of intersection points" << std::endl;)
 
         if (lastPoint.isInside(outerBox)) {
-            if (flags.wentInsideInner || isHalfTangentAtLastKnotGoingTowardInnerBox(lastPoint, segmentIt.first())) {
+            if (flags.wentInsideInner ||
+                isHalfTangentAtLastKnotGoingTowardInnerBox(lastPoint, this->points[index - 1])) {
                 result.emplace_back(index - 1, 1.0);
                 DEBUG_ERASER(debugstream << "|  |  ** pushing   (" << std::setw(3) << result.back().index << ","
                                          << std::setw(20) << result.back().t << ")" << std::endl;)
@@ -857,7 +900,20 @@ void Stroke::setErasable(ErasableStroke* erasable) { this->erasable = erasable;
 
 auto Stroke::getStrokeCapStyle() const -> StrokeCapStyle { return this->capStyle; }
 
-void Stroke::setStrokeCapStyle(const StrokeCapStyle capStyle) { this->capStyle = capStyle; }
+void Stroke::setStrokeCapStyle(const StrokeCapStyle capStyle) {
+    this->capStyle = capStyle;
+    invalidateGeometry();
+}
+
+auto Stroke::getCachedGeometry() const -> std::shared_ptr<const StrokeGeometry> {
+    return std::atomic_load(&this->geometry);
+}
+
+void Stroke::setCachedGeometry(std::shared_ptr<const StrokeGeometry> geometry) const {
+    std::atomic_store(&this->geometry, std::move(geometry));
+}
+
+void Stroke::invalidateGeometry() { std::atomic_store(&this->geometry, std::shared_ptr<const StrokeGeometry>()); }
 
 void Stroke::debugPrint() const {
     g_message("%s", FC(FORMAT_STR("Stroke {1} / hasPressure() = {2}") % (uint64_t)this % this->hasPressure()));
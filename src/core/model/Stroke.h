@@ -15,9 +15,13 @@
 #include <memory>   // for unique_ptr
 #include <vector>   // for vector
 
+#include <cairo.h>  // for cairo_line_cap_t
+
 #include "AudioElement.h"  // for AudioElement
+#include "CachedPath.h"    // for CachedPath
 #include "LineStyle.h"     // for LineStyle
 #include "Point.h"         // for Point
+#include "StrokePoints.h"  // for StrokePoints
 
 class Element;
 class ObjectInputStream;
@@ -53,6 +57,24 @@ class SmallVector;
 
 using IntersectionParametersContainer = SmallVector<PathParameter, 4>;
 
+/**
+ * The geometry of a stroke as cairo paths, in page coordinates. It is computed by the views and cached in the stroke,
+ * so that unchanged strokes are not computed again on each repaint. The paths themselves are in a cache bounded by
+ * memory (see CachedPath): they may have to be computed again.
+ */
+struct StrokeGeometry {
+    /**
+     * The path through the points of the stroke
+     */
+    std::shared_ptr<const CachedPath> polyline;
+
+    /**
+     * The outline of the stroke with pressure, with the given line cap (see StrokeViewHelper::fillPressureOutline())
+     */
+    std::shared_ptr<const CachedPath> pressureOutline;
+    cairo_line_cap_t pressureOutlineCap = CAIRO_LINE_CAP_ROUND;
+};
+
 class Stroke: public AudioElement {
 public:
     Stroke();
@@ -110,10 +132,9 @@ public:
     void addPoint(const Point& p);
     int getPointCount() const;
     void freeUnusedPointItems();
-    std::vector<Point> const& getPointVector() const;
+    StrokePoints const& getPointVector() const;
     Point getPoint(int index) const;
     Point getPoint(PathParameter parameter) const;
-    const Point* getPoints() const;
 
     /**
      * @brief Replace the stroke's points by the ones in the provided vector (they will be copied).
@@ -123,7 +144,6 @@ public:
      * recomputation of the bounding boxes if the new points have no pressure values.
      */
     void setPointVector(const std::vector<Point>& other, const Range* const snappingBox = nullptr);
-    void setPointVector(std::vector<Point>&& other, const Range* const snappingBox = nullptr);
 
 private:
     void setPointVectorInternal(const Range* const snappingBox);
@@ -160,7 +180,6 @@ public:
     void setPressure(const std::vector<double>& pressure);
     void setLastPressure(double pressure);
     void setSecondToLastPressure(double pressure);
-    void clearPressure();
     void scalePressure(double factor);
 
     /**
@@ -183,6 +202,13 @@ public:
     StrokeCapStyle getStrokeCapStyle() const;
     void setStrokeCapStyle(const StrokeCapStyle capStyle);
 
+    /**
+     * @brief The geometry cached by the views, or nullptr if the stroke changed since it was cached.
+     * The views may call these methods from several threads at once.
+     */
+    std::shared_ptr<const StrokeGeometry> getCachedGeometry() const;
+    void setCachedGeometry(std::shared_ptr<const StrokeGeometry> geometry) const;
+
     [[maybe_unused]] void debugPrint() const;
 
 public:
@@ -195,13 +221,19 @@ public:
 protected:
     void calcSize() const override;
 
+private:
+    /**
+     * Must be called by any method which changes the points or the cap style
+     */
+    void invalidateGeometry();
+
 private:
     // The stroke width cannot be inherited from Element
     double width = 0;
     StrokeTool toolType = StrokeTool::PEN;
 
-    // The array with the points
-    std::vector<Point> points{};
+    // The points, without a pressure channel if the stroke has no pressure
+    StrokePoints points{};
 
     /**
      * Dashed line
@@ -220,4 +252,9 @@ private:
     int fill = -1;
 
     StrokeCapStyle capStyle = StrokeCapStyle::ROUND;
+
+    /**
+     * Only accessed atomically. Copies of the stroke share the geometry, as long as neither changes.
+     */
+    mutable std::shared_ptr<const StrokeGeometry> geometry;
 };
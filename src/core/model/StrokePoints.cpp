@@ -0,0 +1,86 @@
+#include "StrokePoints.h"
+
+#include <algorithm>  // for any_of, min
+
+StrokePoints::StrokePoints(const std::vector<Point>& points) { assign(points); }
+
+auto StrokePoints::toVector() const -> std::vector<Point> {
+    std::vector<Point> res;
+    res.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+        res.emplace_back((*this)[i]);
+    }
+    return res;
+}
+
+void StrokePoints::push_back(const Point& p) {
+    if (hasPressureChannel() || p.z != Point::NO_PRESSURE) {
+        if (pressures.size() != coordinates.size()) {
+            // First point with pressure: allocate the channel
+            pressures.reserve(coordinates.capacity());
+            pressures.resize(coordinates.size(), Point::NO_PRESSURE);
+        }
+        pressures.push_back(p.z);
+    }
+    coordinates.push_back({p.x, p.y});
+}
+
+void StrokePoints::assign(const std::vector<Point>& points) {
+    coordinates.clear();
+    coordinates.reserve(points.size());
+    for (const Point& p: points) {
+        coordinates.push_back({p.x, p.y});
+    }
+
+    pressures.clear();
+    if (std::any_of(points.begin(), points.end(), [](const Point& p) { return p.z != Point::NO_PRESSURE; })) {
+        pressures.reserve(points.size());
+        for (const Point& p: points) {
+            pressures.push_back(p.z);
+        }
+    } else {
+        pressures.shrink_to_fit();
+    }
+}
+
+void StrokePoints::setPressure(size_t i, double pressure) {
+    if (pressures.empty()) {
+        if (pressure == Point::NO_PRESSURE) {
+            return;
+        }
+        pressures.resize(coordinates.size(), Point::NO_PRESSURE);
+    }
+    pressures[i] = pressure;
+}
+
+void StrokePoints::scalePressures(double factor) {
+    for (double& z: pressures) {
+        if (z != Point::NO_PRESSURE) {
+            z *= factor;
+        }
+    }
+}
+
+void StrokePoints::clearPressure() {
+    pressures.clear();
+    pressures.shrink_to_fit();
+}
+
+void StrokePoints::truncate(size_t count) {
+    coordinates.resize(std::min(count, coordinates.size()));
+    if (!pressures.empty()) {
+        pressures.resize(coordinates.size());
+    }
+}
+
+void StrokePoints::reserve(size_t count) {
+    coordinates.reserve(count);
+    if (!pressures.empty()) {
+        pressures.reserve(count);
+    }
+}
+
+void StrokePoints::shrinkToFit() {
+    coordinates.shrink_to_fit();
+    pressures.shrink_to_fit();
+}
@@ -0,0 +1,194 @@
+/*
+ * Xournal++
+ *
+ * The points of a stroke
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>   // for size_t, ptrdiff_t
+#include <iterator>  // for random_access_iterator_tag
+#include <vector>    // for vector
+
+#include "Point.h"  // for Point
+
+/**
+ * @brief The points of a stroke, in two channels: the coordinates, and the pressure values.
+ *
+ * The pressure channel is only allocated once a point with pressure is added, so the strokes without pressure (the
+ * vast majority: highlighters, shapes, mouse input...) take 16 bytes per point instead of 24.
+ *
+ * The points are read by value, as Point. Iterating over them does not copy them into a std::vector<Point>.
+ */
+class StrokePoints {
+public:
+    struct Coordinates {
+        double x;
+        double y;
+    };
+
+    class const_iterator {
+    public:
+        /**
+         * Lets it->x work although the iterator has no Point to point to
+         */
+        class ArrowProxy {
+        public:
+            const Point* operator->() const { return &p; }
+
+        private:
+            explicit ArrowProxy(const Point& p): p(p) {}
+            Point p;
+
+            friend class const_iterator;
+        };
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Point;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ArrowProxy;
+        using reference = Point;
+
+        const_iterator() = default;
+
+        Point operator*() const { return (*points)[index]; }
+        ArrowProxy operator->() const { return ArrowProxy((*points)[index]); }
+        Point operator[](difference_type n) const { return (*points)[index + static_cast<size_t>(n)]; }
+
+        const_iterator& operator++() {
+            ++index;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator res = *this;
+            ++index;
+            return res;
+        }
+        const_iterator& operator--() {
+            --index;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator res = *this;
+            --index;
+            return res;
+        }
+        const_iterator& operator+=(difference_type n) {
+            index += static_cast<size_t>(n);
+            return *this;
+        }
+        const_iterator& operator-=(difference_type n) {
+            index -= static_cast<size_t>(n);
+            return *this;
+        }
+        const_iterator operator+(difference_type n) const {
+            return const_iterator(points, index + static_cast<size_t>(n));
+        }
+        const_iterator operator-(difference_type n) const {
+            return const_iterator(points, index - static_cast<size_t>(n));
+        }
+        friend const_iterator operator+(difference_type n, const const_iterator& it) { return it + n; }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+        }
+
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator<(const const_iterator& other) const { return index < other.index; }
+        bool operator>(const const_iterator& other) const { return index > other.index; }
+        bool operator<=(const const_iterator& other) const { return index <= other.index; }
+        bool operator>=(const const_iterator& other) const { return index >= other.index; }
+
+    private:
+        const_iterator(const StrokePoints* points, size_t index): points(points), index(index) {}
+
+        const StrokePoints* points = nullptr;
+        size_t index = 0;
+
+        friend class StrokePoints;
+    };
+
+    using value_type = Point;
+    using size_type = size_t;
+    using iterator = const_iterator;
+
+public:
+    StrokePoints() = default;
+    explicit StrokePoints(const std::vector<Point>& points);
+
+    size_t size() const { return coordinates.size(); }
+    bool empty() const { return coordinates.empty(); }
+
+    Point operator[](size_t i) const { return Point(coordinates[i].x, coordinates[i].y, getPressure(i)); }
+    Point front() const { return (*this)[0]; }
+    Point back() const { return (*this)[size() - 1]; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    double getPressure(size_t i) const { return pressures.empty() ? Point::NO_PRESSURE : pressures[i]; }
+
+    /**
+     * @return true if the pressure channel is allocated, i.e. if some point has or had a pressure value
+     */
+    bool hasPressureChannel() const { return !pressures.empty(); }
+
+    /**
+     * @brief Direct access to the coordinates, for the loops which do not need the pressure values
+     */
+    const std::vector<Coordinates>& getCoordinates() const { return coordinates; }
+
+    std::vector<Point> toVector() const;
+
+public:
+    void push_back(const Point& p);
+    void assign(const std::vector<Point>& points);
+
+    /**
+     * @brief Set the pressure of a point. Setting Point::NO_PRESSURE does not allocate the pressure channel.
+     */
+    void setPressure(size_t i, double pressure);
+
+    /**
+     * @brief Multiply the pressure values by the factor, except Point::NO_PRESSURE
+     */
+    void scalePressures(double factor);
+
+    /**
+     * @brief Remove all pressure values and free the pressure channel
+     */
+    void clearPressure();
+
+    /**
+     * @brief Apply fun(double& x, double& y) to the coordinates of each point
+     */
+    template <typename Fun>
+    void transformCoordinates(Fun fun) {
+        for (auto& c: coordinates) {
+            fun(c.x, c.y);
+        }
+    }
+
+    /**
+     * @brief Remove the points from the given index on
+     */
+    void truncate(size_t count);
+
+    void reserve(size_t count);
+    void shrinkToFit();
+
+private:
+    std::vector<Coordinates> coordinates;
+
+    /**
+     * Empty, or one value per point
+     */
+    std::vector<double> pressures;
+};
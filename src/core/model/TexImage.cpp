@@ -1,18 +1,37 @@
 #include "TexImage.h"
 
-#include <utility>  // for move
+#include <algorithm>  // for max
+#include <cmath>      // for ceil, log2, ldexp
+#include <mutex>      // for lock_guard
+#include <utility>    // for move
 
 #include <poppler-document.h>  // for poppler_document_ge...
 #include <poppler-page.h>      // for poppler_page_get_size
 
 #include "model/Element.h"                        // for Element, ELEMENT_TE...
 #include "util/Rectangle.h"                       // for Rectangle
+#include "util/SurfaceCache.h"                    // for SurfaceCache
+#include "util/safe_casts.h"                      // for ceil_cast
 #include "util/raii/GObjectSPtr.h"                // for GObjectSPtr
 #include "util/serializing/ObjectInputStream.h"   // for ObjectInputStream
 #include "util/serializing/ObjectOutputStream.h"  // for ObjectOutputStream
 
+using xoj::util::CairoSurfaceSPtr;
 using xoj::util::Rectangle;
 
+namespace {
+/// Rasters larger than this (in pixels, in either direction) are not cached: the PDF is rendered directly
+constexpr int MAX_RASTER_SIZE = 4096;
+
+/// The rasters of all the TeX images. The level of a raster is its zoom bucket: level b is rendered at the scale 2^-b.
+using TexRasterCache = xoj::util::SurfaceCache<TexImage>;
+
+auto getTexRasterCache() -> TexRasterCache& {
+    static TexRasterCache cache(64U * 1024U * 1024U);
+    return cache;
+}
+}  // namespace
+
 TexImage::TexImage(): Element(ELEMENT_TEXIMAGE) { this->sizeCalculated = true; }
 
 TexImage::~TexImage() { freeImageAndPdf(); }
@@ -23,7 +42,10 @@ void TexImage::freeImageAndPdf() {
         this->image = nullptr;
     }
 
+    getTexRasterCache().remove(this);
     this->pdf.reset();
+    this->pdfWidth = 0;
+    this->pdfHeight = 0;
 }
 
 auto TexImage::clone() const -> Element* {
@@ -51,11 +73,13 @@ auto TexImage::clone() const -> Element* {
 void TexImage::setWidth(double width) {
     this->width = width;
     this->calcSize();
+    notifyBoundsChanged();
 }
 
 void TexImage::setHeight(double height) {
     this->height = height;
     this->calcSize();
+    notifyBoundsChanged();
 }
 
 auto TexImage::cairoReadFunction(TexImage* image, unsigned char* data, unsigned int length) -> cairo_status_t {
@@ -93,9 +117,11 @@ auto TexImage::loadData(std::string&& bytes, GError** err) -> bool {
         if (!pdf.get() || poppler_document_get_n_pages(this->pdf.get()) < 1) {
             return false;
         }
+        xoj::util::GObjectSPtr<PopplerPage> page(poppler_document_get_page(this->pdf.get(), 0), xoj::util::adopt);
+        poppler_page_get_size(page.get(), &this->pdfWidth, &this->pdfHeight);
         if (!this->width && !this->height) {
-            xoj::util::GObjectSPtr<PopplerPage> page(poppler_document_get_page(this->pdf.get(), 0), xoj::util::adopt);
-            poppler_page_get_size(page.get(), &this->width, &this->height);
+            this->width = this->pdfWidth;
+            this->height = this->pdfHeight;
         }
     } else if (type == "PNG") {
         this->image = cairo_image_surface_create_from_png_stream(
@@ -111,6 +137,63 @@ auto TexImage::getImage() const -> cairo_surface_t* { return this->image; }
 
 auto TexImage::getPdf() const -> PopplerDocument* { return this->pdf.get(); }
 
+auto TexImage::getRaster(double width, double height) const -> CairoSurfaceSPtr {
+    if (!this->pdf || this->pdfWidth <= 0 || this->pdfHeight <= 0) {
+        return nullptr;
+    }
+    const double scale = std::max(width / this->pdfWidth, height / this->pdfHeight);
+    if (!(scale > 0)) {
+        return nullptr;
+    }
+
+    // The coarsest bucket that does not need to be upscaled
+    const int level = -ceil_cast<int>(std::log2(scale));
+    const double levelScale = std::ldexp(1.0, -level);
+    const int rasterWidth = std::max(1, ceil_cast<int>(this->pdfWidth * levelScale));
+    const int rasterHeight = std::max(1, ceil_cast<int>(this->pdfHeight * levelScale));
+    if (rasterWidth > MAX_RASTER_SIZE || rasterHeight > MAX_RASTER_SIZE) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(this->pdfMutex);
+    TexRasterCache& cache = getTexRasterCache();
+    if (auto surface = cache.get(this, level)) {
+        return surface;
+    }
+
+    xoj::util::GObjectSPtr<PopplerPage> page(poppler_document_get_page(this->pdf.get(), 0), xoj::util::adopt);
+    if (!page) {
+        return nullptr;
+    }
+    CairoSurfaceSPtr surface(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, rasterWidth, rasterHeight),
+                             xoj::util::adopt);
+    cairo_t* cr = cairo_create(surface.get());
+    cairo_scale(cr, levelScale, levelScale);
+    poppler_page_render(page.get(), cr);
+    cairo_destroy(cr);
+
+    cache.put(this, level, surface);
+    return surface;
+}
+
+void TexImage::drawPdf(cairo_t* cr) const {
+    if (!this->pdf || this->pdfWidth <= 0 || this->pdfHeight <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(this->pdfMutex);
+    xoj::util::GObjectSPtr<PopplerPage> page(poppler_document_get_page(this->pdf.get(), 0), xoj::util::adopt);
+    if (!page) {
+        return;
+    }
+    cairo_save(cr);
+    cairo_translate(cr, this->x, this->y);
+    cairo_scale(cr, this->width / this->pdfWidth, this->height / this->pdfHeight);
+    poppler_page_render(page.get(), cr);
+    cairo_restore(cr);
+}
+
+void TexImage::setRasterMemoryBudget(size_t bytes) { getTexRasterCache().setMemoryBudget(bytes); }
+
 void TexImage::scale(double x0, double y0, double fx, double fy, double rotation,
                      bool) {  // line width scaling option is not used
 
@@ -120,6 +203,7 @@ void TexImage::scale(double x0, double y0, double fx, double fy, double rotation
     this->width *= fx;
     this->height *= fy;
     this->calcSize();
+    notifyBoundsChanged();
 }
 
 void TexImage::rotate(double x0, double y0, double th) {
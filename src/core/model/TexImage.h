@@ -11,13 +11,16 @@
 
 #pragma once
 
-#include <string>  // for string
+#include <cstddef>  // for size_t
+#include <mutex>    // for mutex
+#include <string>   // for string
 
 #include <cairo.h>    // for cairo_surface_t, cairo_status_t
 #include <glib.h>     // for GError
 #include <poppler.h>  // for PopplerDocument
 
-#include "util/raii/GObjectSPtr.h"  // for GObjectSPtr
+#include "util/raii/CairoWrappers.h"  // for CairoSurfaceSPtr
+#include "util/raii/GObjectSPtr.h"    // for GObjectSPtr
 
 #include "Element.h"  // for Element
 
@@ -55,6 +58,21 @@ public:
      */
     PopplerDocument* getPdf() const;
 
+    /**
+     * @return The PDF rasterized at the coarsest power of two scale covering the given size (in pixels). The rasters are
+     * cached. nullptr if the image is not a PDF, or if the raster would be too large to be worth caching.
+     */
+    xoj::util::CairoSurfaceSPtr getRaster(double width, double height) const;
+
+    /**
+     * Renders the PDF (as vectors) at the position and size of the element
+     */
+    void drawPdf(cairo_t* cr) const;
+
+    /// Set the amount of memory the rasters of all the TeX images may use together. The least recently used rasters
+    /// are freed first.
+    static void setRasterMemoryBudget(size_t bytes);
+
     void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) override;
     void rotate(double x0, double y0, double th) override;
 
@@ -90,6 +108,17 @@ private:
      */
     xoj::util::GObjectSPtr<PopplerDocument> pdf;
 
+    /**
+     * Size of the page of the PDF
+     */
+    double pdfWidth = 0;
+    double pdfHeight = 0;
+
+    /**
+     * Poppler documents are not thread safe: serializes the renderings of the PDF by several readers of the document
+     */
+    mutable std::mutex pdfMutex;
+
     /**
      * Tex image, if rendered as image. Note: this is deprecated and subject to removal in a later version.
      */
@@ -44,7 +44,11 @@ auto Text::clone() const -> Text* {
 
 auto Text::getFont() -> XojFont& { return font; }
 
-void Text::setFont(const XojFont& font) { this->font = font; }
+void Text::setFont(const XojFont& font) {
+    this->font = font;
+    invalidateLayout();
+    notifyBoundsChanged();
+}
 
 auto Text::getFontSize() const -> double { return font.getSize(); }
 
@@ -54,15 +58,15 @@ auto Text::getText() const -> const std::string& { return this->text; }
 
 void Text::setText(std::string text) {
     this->text = std::move(text);
+    invalidateLayout();
     sizeCalculated = false;
+    notifyBoundsChanged();
 }
 
 void Text::calcSize() const {
-    auto layout = createPangoLayout();
-    pango_layout_set_text(layout.get(), this->text.c_str(), static_cast<int>(this->text.length()));
     int w = 0;
     int h = 0;
-    pango_layout_get_size(layout.get(), &w, &h);
+    withPangoLayout([&](PangoLayout* layout) { pango_layout_get_size(layout, &w, &h); });
     this->width = (static_cast<double>(w)) / PANGO_SCALE;
     this->height = (static_cast<double>(h)) / PANGO_SCALE;
     this->updateSnapping();
@@ -71,11 +75,13 @@ void Text::calcSize() const {
 void Text::setWidth(double width) {
     this->width = width;
     this->updateSnapping();
+    notifyBoundsChanged();
 }
 
 void Text::setHeight(double height) {
     this->height = height;
     this->updateSnapping();
+    notifyBoundsChanged();
 }
 
 void Text::setInEditing(bool inEditing) { this->inEditing = inEditing; }
@@ -94,6 +100,22 @@ auto Text::createPangoLayout() const -> xoj::util::GObjectSPtr<PangoLayout> {
     return layout;
 }
 
+auto Text::getCachedPangoLayout() const -> PangoLayout* {
+    std::string fontName = this->font.getName();
+    if (!this->layout || this->layoutFontName != fontName || this->layoutFontSize != this->font.getSize()) {
+        this->layout = createPangoLayout();
+        pango_layout_set_text(this->layout.get(), this->text.c_str(), static_cast<int>(this->text.length()));
+        this->layoutFontName = std::move(fontName);
+        this->layoutFontSize = this->font.getSize();
+    }
+    return this->layout.get();
+}
+
+void Text::invalidateLayout() {
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+    this->layout.reset();
+}
+
 void Text::updatePangoFont(PangoLayout* layout) const {
     PangoFontDescription* desc = pango_font_description_from_string(this->getFontName().c_str());
     pango_font_description_set_absolute_size(desc, this->getFontSize() * PANGO_SCALE);
@@ -119,8 +141,10 @@ void Text::scale(double x0, double y0, double fx, double fy, double rotation,
 
     double size = this->font.getSize() * fx;
     this->font.setSize(size);
+    invalidateLayout();
 
     sizeCalculated = false;
+    notifyBoundsChanged();
 }
 
 void Text::rotate(double x0, double y0, double th) {}
@@ -162,6 +186,7 @@ void Text::readSerialized(ObjectInputStream& in) {
     this->text = in.readString();
 
     font.readSerialized(in);
+    invalidateLayout();
 
     in.endObject();
 }
@@ -176,29 +201,37 @@ auto Text::findText(const std::string& search) const -> std::vector<XojPdfRectan
         return {};
     }
 
-    auto layout = this->createPangoLayout();
-    pango_layout_set_text(layout.get(), this->text.c_str(), static_cast<int>(this->text.length()));
-
-
     std::string text = StringUtils::toLowerCase(this->text);
 
     std::string pattern = StringUtils::toLowerCase(search);
 
     std::vector<XojPdfRectangle> list;
 
-    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
-        XojPdfRectangle mark;
-        PangoRectangle rect = {0};
-        pango_layout_index_to_pos(layout.get(), static_cast<int>(pos), &rect);
-        mark.x1 = (static_cast<double>(rect.x)) / PANGO_SCALE + this->getX();
-        mark.y1 = (static_cast<double>(rect.y)) / PANGO_SCALE + this->getY();
-
-        pango_layout_index_to_pos(layout.get(), static_cast<int>(pos + patternLength - 1), &rect);
-        mark.x2 = (static_cast<double>(rect.x) + rect.width) / PANGO_SCALE + this->getX();
-        mark.y2 = (static_cast<double>(rect.y) + rect.height) / PANGO_SCALE + this->getY();
-
-        list.push_back(mark);
+    // Only shape the text if it matches
+    size_t firstMatch = text.find(pattern);
+    if (firstMatch == std::string::npos) {
+        return list;
     }
 
+    // getX() and getY() may compute the size, which needs the layout
+    const double x = this->getX();
+    const double y = this->getY();
+
+    withPangoLayout([&](PangoLayout* layout) {
+        for (size_t pos = firstMatch; pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            XojPdfRectangle mark;
+            PangoRectangle rect = {0};
+            pango_layout_index_to_pos(layout, static_cast<int>(pos), &rect);
+            mark.x1 = (static_cast<double>(rect.x)) / PANGO_SCALE + x;
+            mark.y1 = (static_cast<double>(rect.y)) / PANGO_SCALE + y;
+
+            pango_layout_index_to_pos(layout, static_cast<int>(pos + patternLength - 1), &rect);
+            mark.x2 = (static_cast<double>(rect.x) + rect.width) / PANGO_SCALE + x;
+            mark.y2 = (static_cast<double>(rect.y) + rect.height) / PANGO_SCALE + y;
+
+            list.push_back(mark);
+        }
+    });
+
     return list;
 }
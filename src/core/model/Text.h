@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <mutex>   // for mutex, lock_guard
 #include <string>  // for string
 #include <vector>
 
@@ -49,6 +50,17 @@ public:
     xoj::util::GObjectSPtr<PangoLayout> createPangoLayout() const;
     void updatePangoFont(PangoLayout* layout) const;
 
+    /**
+     * @brief Call use(PangoLayout*) with the layout of the text. The layout is shaped once and cached until the text
+     * or the font changes, and is shared by the drawing, the size computation and the search.
+     * Calls from several threads are serialized. The layout must not be used after use() returns.
+     */
+    template <typename Fun>
+    void withPangoLayout(Fun&& use) const {
+        std::lock_guard<std::mutex> lock(this->layoutMutex);
+        use(getCachedPangoLayout());
+    }
+
     void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) override;
     void rotate(double x0, double y0, double th) override;
 
@@ -71,6 +83,13 @@ protected:
     void calcSize() const override;
     void updateSnapping() const;
 
+private:
+    /**
+     * Must be called with layoutMutex held
+     */
+    PangoLayout* getCachedPangoLayout() const;
+    void invalidateLayout();
+
 public:
     std::vector<XojPdfRectangle> findText(const std::string& search) const;
 
@@ -80,4 +99,12 @@ private:
     std::string text;
 
     bool inEditing = false;
+
+    /**
+     * The cached layout, and the font it was created with (the font can be changed through getFont())
+     */
+    mutable xoj::util::GObjectSPtr<PangoLayout> layout;
+    mutable std::string layoutFontName;
+    mutable double layoutFontSize = 0;
+    mutable std::mutex layoutMutex;
 };
@@ -2,6 +2,7 @@
 
 #include <algorithm>  // for find, transform
 #include <iterator>   // for back_insert_iterator, back_inserter, begin
+#include <mutex>      // for lock_guard
 #include <utility>    // for move
 
 #include "model/Layer.h"     // for Layer, Layer::Index
@@ -30,6 +31,7 @@ XojPage::XojPage(XojPage const& page):
         bgType(page.bgType),
         pdfBackgroundPage(page.pdfBackgroundPage),
         backgroundColor(page.backgroundColor) {
+    page.loadLayers();
     this->layer.reserve(page.layer.size());
     std::transform(begin(page.layer), end(page.layer), std::back_inserter(this->layer),
                    [](auto* layer) { return layer->clone(); });
@@ -37,12 +39,51 @@ XojPage::XojPage(XojPage const& page):
 
 auto XojPage::clone() -> XojPage* { return new XojPage(*this); }
 
+void XojPage::setLayerLoader(LayerLoader loader, LayerSerializer serializer) {
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    this->layerLoader = std::move(loader);
+    this->layerSerializer = this->layerLoader ? std::move(serializer) : nullptr;
+    this->layersLoaded = !this->layerLoader;
+}
+
+auto XojPage::isLoaded() const -> bool { return this->layersLoaded.load(std::memory_order_acquire); }
+
+auto XojPage::getUnloadedLayers() const -> std::optional<std::string> {
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    if (!this->layerSerializer) {
+        return std::nullopt;
+    }
+    return this->layerSerializer();
+}
+
+void XojPage::loadLayers() const {
+    if (this->layersLoaded.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Pages may be loaded by the render jobs as well as by the main thread
+    std::lock_guard<std::mutex> lock(this->layerLoaderMutex);
+    if (!this->layersLoaded.load(std::memory_order_relaxed)) {
+        LoadedLayers loaded = this->layerLoader();
+        this->layerLoader = nullptr;
+        if (loaded.complete) {
+            this->layerSerializer = nullptr;
+        }
+        // The layers were already part of the page, only their parsing was deferred
+        auto& layers = const_cast<XojPage*>(this)->layer;
+        layers.insert(layers.begin(), loaded.layers.begin(), loaded.layers.end());
+        this->layersLoaded.store(true, std::memory_order_release);
+    }
+}
+
 void XojPage::addLayer(Layer* layer) {
+    loadLayers();
     this->layer.push_back(layer);
     this->currentLayer = npos;
 }
 
 void XojPage::insertLayer(Layer* layer, Layer::Index index) {
+    loadLayers();
     if (index >= this->layer.size()) {
         addLayer(layer);
         return;
@@ -53,6 +94,7 @@ void XojPage::insertLayer(Layer* layer, Layer::Index index) {
 }
 
 void XojPage::removeLayer(Layer* l) {
+    loadLayers();
     if (auto it = std::find(layer.begin(), layer.end(), l); it != layer.end()) {
         this->layer.erase(it);
     }
@@ -65,14 +107,21 @@ void XojPage::removeLayer(Layer* l) {
 
 void XojPage::setSelectedLayerId(Layer::Index id) { this->currentLayer = id; }
 
-auto XojPage::getLayers() -> std::vector<Layer*>* { return &this->layer; }
+auto XojPage::getLayers() -> std::vector<Layer*>* {
+    loadLayers();
+    return &this->layer;
+}
 
-auto XojPage::getLayerCount() const -> Layer::Index { return this->layer.size(); }
+auto XojPage::getLayerCount() const -> Layer::Index {
+    loadLayers();
+    return this->layer.size();
+}
 
 /**
  * Layer ID 0 = Background, Layer ID 1 = Layer 1
  */
 auto XojPage::getSelectedLayerId() -> Layer::Index {
+    loadLayers();
     if (this->currentLayer == npos) {
         this->currentLayer = this->layer.size();
     }
@@ -86,6 +135,7 @@ void XojPage::setLayerVisible(Layer::Index layerId, bool visible) {
         return;
     }
 
+    loadLayers();
     layerId--;
     if (layerId >= this->layer.size()) {
         return;
@@ -99,6 +149,7 @@ auto XojPage::isLayerVisible(Layer::Index layerId) const -> bool {
         return backgroundVisible;
     }
 
+    loadLayers();
     layerId--;
     if (layerId >= this->layer.size()) {
         return false;
@@ -129,6 +180,7 @@ auto XojPage::getHeight() const -> double { return this->height; }
 auto XojPage::getPdfPageNr() const -> size_t { return this->pdfBackgroundPage; }
 
 auto XojPage::isAnnotated() const -> bool {
+    loadLayers();
     for (Layer* l: this->layer) {
         if (l->isAnnotated()) {
             return true;
@@ -155,6 +207,7 @@ auto XojPage::getBackgroundImage() -> BackgroundImage& { return this->background
 void XojPage::setBackgroundImage(BackgroundImage img) { this->backgroundImage = std::move(img); }
 
 auto XojPage::getSelectedLayer() -> Layer* {
+    loadLayers();
     g_assert(!layer.empty());
     size_t layer = getSelectedLayerId();
 
@@ -11,10 +11,13 @@
 
 #pragma once
 
-#include <cstddef>   // for size_t
-#include <optional>  // for optional
-#include <string>    // for string
-#include <vector>    // for vector
+#include <atomic>      // for atomic
+#include <cstddef>     // for size_t
+#include <functional>  // for function
+#include <mutex>       // for mutex
+#include <optional>    // for optional
+#include <string>      // for string
+#include <vector>      // for vector
 
 #include "util/Color.h"  // for Color
 #include "util/Util.h"   // for npos
@@ -40,6 +43,52 @@ protected:
     void setLayerVisible(Layer::Index layerId, bool visible);
 
 public:
+    struct LoadedLayers {
+        std::vector<Layer*> layers;
+
+        /**
+         * false if the layers could not be parsed completely: the page then keeps its serializer, so that it is saved
+         * as it is in the file rather than with what could be parsed
+         */
+        bool complete = true;
+    };
+
+    /**
+     * Parses the layers of a page whose loading has been deferred
+     */
+    using LayerLoader = std::function<LoadedLayers()>;
+
+    /**
+     * Serializes the layers of a page whose loading has been deferred, as they are in the file, or returns nothing if
+     * they cannot be saved without being parsed
+     */
+    using LayerSerializer = std::function<std::optional<std::string>()>;
+
+protected:
+    /**
+     * The layers will be loaded by the loader the first time they are accessed. Until then, the serializer lets the
+     * page be saved without loading them.
+     */
+    void setLayerLoader(LayerLoader loader, LayerSerializer serializer = nullptr);
+
+public:
+    /**
+     * @return false if the layers of the page have not been loaded yet
+     */
+    bool isLoaded() const;
+
+    /**
+     * @return The layers as XML if they have not been loaded yet (or could not be loaded completely) and can be saved
+     *         as they are in the file, nothing otherwise (the layers must then be saved from getLayers())
+     */
+    std::optional<std::string> getUnloadedLayers() const;
+
+    /**
+     * Load the layers now if their loading has been deferred. This is done automatically by all the methods accessing
+     * the layers, it is only useful to load a page in advance.
+     */
+    void loadLayers() const;
+
     // Also set the size over doc->setPageSize!
     void setBackgroundPdfPageNr(size_t page);
 
@@ -128,6 +177,14 @@ private:
      */
     std::optional<std::string> backgroundName;
 
+    /**
+     * Loads the layers, if they have not been loaded yet
+     */
+    mutable LayerLoader layerLoader;
+    mutable LayerSerializer layerSerializer;
+    mutable std::mutex layerLoaderMutex;
+    mutable std::atomic<bool> layersLoaded{true};
+
     // Allow LoadHandler to add layers directly
     friend class LoadHandler;
 
@@ -63,9 +63,9 @@ void ErasableStroke::beginErasure(const IntersectionParametersContainer& paddedI
         if (filled) {
             if (subsections.size() == 1) {
                 // We erased the stroke from its ends. Simply add the end points to ensure the filling is rerendered
-                const Point& p1 = this->stroke.getPointVector().front();
+                const Point p1 = this->stroke.getPointVector().front();
                 range.addPoint(p1.x, p1.y);
-                const Point& p2 = this->stroke.getPointVector().back();
+                const Point p2 = this->stroke.getPointVector().back();
                 range.addPoint(p2.x, p2.y);
             } else {
                 // The stroke was split in two or more (and possibly shrank). Need to rerender its entire box.
@@ -303,7 +303,7 @@ auto ErasableStroke::computeSubSectionBoundingBox(const SubSection& section) con
 
     Range rg = pointRange(this->stroke.getPoint(section.min));
 
-    auto data = this->stroke.getPointVector();
+    const auto& data = this->stroke.getPointVector();
     auto endIt = std::next(data.cbegin(), (std::ptrdiff_t)section.max.index + 1);
     for (auto ptIt = std::next(data.cbegin(), (std::ptrdiff_t)section.min.index + 1); ptIt != endIt; ++ptIt) {
         rg = rg.unite(pointRange(*ptIt));
@@ -25,6 +25,7 @@
 class Point;
 class Range;
 class Stroke;
+class StrokePoints;
 
 class ErasableStroke::OverlapTree {
 public:
@@ -140,24 +141,24 @@ private:
          *      firstPoint -- pts[min] -- ... -- pts[max] -- lastPoint
          */
         void populateNode(Node& node, const Point& firstPoint, size_t min, size_t max, const Point& lastPoint,
-                          const std::vector<Point>& pts);
+                          const StrokePoints& pts);
 
         /**
          * @brief Create a subtree corresponding to the subsection:
          *      firstPoint -- pts[min] -- ... -- pts[max]
          */
-        void populateNode(Node& node, const Point& firstPoint, size_t min, size_t max, const std::vector<Point>& pts);
+        void populateNode(Node& node, const Point& firstPoint, size_t min, size_t max, const StrokePoints& pts);
 
         /**
          * @brief Create a subtree corresponding to the subsection:
          *      pts[min] -- ... -- pts[max] -- lastPoint
          */
-        void populateNode(Node& node, size_t min, size_t max, const Point& lastPoint, const std::vector<Point>& pts);
+        void populateNode(Node& node, size_t min, size_t max, const Point& lastPoint, const StrokePoints& pts);
 
         /**
          * @brief Create a subtree corresponding to the subsection:
          *      pts[min] -- ... -- pts[max]
          */
-        void populateNode(Node& node, size_t min, size_t max, const std::vector<Point>& pts);
+        void populateNode(Node& node, size_t min, size_t max, const StrokePoints& pts);
     };
 };
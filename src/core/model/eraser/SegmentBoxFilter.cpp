@@ -0,0 +1,70 @@
+#include "SegmentBoxFilter.h"
+
+#include <algorithm>  // for min, max
+
+#ifdef __SSE2__
+#include <emmintrin.h>  // for __m128d, _mm_loadu_pd, _mm_min_pd, _mm_max_pd...
+#endif
+
+namespace SegmentBoxFilter {
+
+size_t findSegmentNearBoxScalar(const StrokePoints::Coordinates* points, size_t first, size_t last,
+                                const xoj::util::Rectangle<double>& box) {
+    const double maxX = box.x + box.width;
+    const double maxY = box.y + box.height;
+    for (size_t i = first; i <= last; i++) {
+        const auto& p = points[i];
+        const auto& q = points[i + 1];
+        if (std::min(p.x, q.x) <= maxX && std::max(p.x, q.x) >= box.x && std::min(p.y, q.y) <= maxY &&
+            std::max(p.y, q.y) >= box.y) {
+            return i;
+        }
+    }
+    return last + 1;
+}
+
+#ifdef __SSE2__
+size_t findSegmentNearBox(const StrokePoints::Coordinates* points, size_t first, size_t last,
+                          const xoj::util::Rectangle<double>& box) {
+    if (first > last) {
+        return last + 1;
+    }
+
+    // One lane for x, one for y
+    const __m128d boxMin = _mm_set_pd(box.y, box.x);
+    const __m128d boxMax = _mm_set_pd(box.y + box.height, box.x + box.width);
+
+    // Bits 0 and 1: the first segment meets the box in x and in y. Bits 2 and 3: the same for the second segment.
+    auto meetsBox = [&boxMin, &boxMax](__m128d p, __m128d q) {
+        __m128d meets = _mm_and_pd(_mm_cmple_pd(_mm_min_pd(p, q), boxMax), _mm_cmpge_pd(_mm_max_pd(p, q), boxMin));
+        return _mm_movemask_pd(meets);
+    };
+
+    __m128d p = _mm_loadu_pd(&points[first].x);
+    size_t i = first;
+    // Two segments per iteration
+    for (; i < last; i += 2) {
+        __m128d q = _mm_loadu_pd(&points[i + 1].x);
+        __m128d r = _mm_loadu_pd(&points[i + 2].x);
+        int mask = meetsBox(p, q) | (meetsBox(q, r) << 2);
+        if ((mask & 0x3) == 0x3) {
+            return i;
+        }
+        if ((mask & 0xc) == 0xc) {
+            return i + 1;
+        }
+        p = r;
+    }
+    if (i == last && meetsBox(p, _mm_loadu_pd(&points[i + 1].x)) == 0x3) {
+        return i;
+    }
+    return last + 1;
+}
+#else
+size_t findSegmentNearBox(const StrokePoints::Coordinates* points, size_t first, size_t last,
+                          const xoj::util::Rectangle<double>& box) {
+    return findSegmentNearBoxScalar(points, first, last, box);
+}
+#endif
+
+}  // namespace SegmentBoxFilter
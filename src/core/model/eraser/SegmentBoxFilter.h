@@ -0,0 +1,45 @@
+/*
+ * Xournal++
+ *
+ * Batched tests of the segments of a stroke against a box
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>  // for size_t
+
+#include "model/StrokePoints.h"  // for StrokePoints
+#include "util/Rectangle.h"      // for Rectangle
+
+/**
+ * The segment i of a stroke joins its points i and i + 1.
+ *
+ * The exact intersection tests of the eraser are stateful and run segment after segment, but almost all the segments
+ * of a stroke are far from the eraser. These functions skip those segments in batches (with SSE2 where available),
+ * so that the exact tests only run on the few segments near the eraser.
+ */
+namespace SegmentBoxFilter {
+
+/**
+ * @brief Find the first segment whose bounding box meets the box (borders included)
+ * @param points The points of the stroke. There must be at least last + 2 of them.
+ * @param first The first segment to test
+ * @param last The last segment to test
+ * @param box The box
+ * @return The index of the segment, or last + 1 if none of the segments first..last meets the box
+ */
+[[nodiscard]] size_t findSegmentNearBox(const StrokePoints::Coordinates* points, size_t first, size_t last,
+                                        const xoj::util::Rectangle<double>& box);
+
+/**
+ * @brief Portable implementation of findSegmentNearBox(), used when SSE2 is not available
+ */
+[[nodiscard]] size_t findSegmentNearBoxScalar(const StrokePoints::Coordinates* points, size_t first, size_t last,
+                                              const xoj::util::Rectangle<double>& box);
+
+}  // namespace SegmentBoxFilter
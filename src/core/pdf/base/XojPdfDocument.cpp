@@ -44,6 +44,14 @@ auto XojPdfDocument::isLoaded() const -> bool { return doc->isLoaded(); }
 
 void XojPdfDocument::reset() { doc->reset(); }
 
+auto XojPdfDocument::loadIndependentCopy(XojPdfDocumentInterface* doc, GError** error) -> bool {
+    return this->doc->loadIndependentCopy(doc, error);
+}
+
+auto XojPdfDocument::loadIndependentCopy(const XojPdfDocument& doc, GError** error) -> bool {
+    return this->doc->loadIndependentCopy(doc.doc, error);
+}
+
 auto XojPdfDocument::getPage(size_t page) const -> XojPdfPageSPtr { return doc->getPage(page); }
 
 auto XojPdfDocument::getPageCount() const -> size_t { return doc->getPageCount(); }
@@ -44,6 +44,8 @@ public:
     bool load(gpointer data, gsize length, std::string password, GError** error) override;
     bool isLoaded() const override;
     void reset() override;
+    bool loadIndependentCopy(XojPdfDocumentInterface* doc, GError** error) override;
+    bool loadIndependentCopy(const XojPdfDocument& doc, GError** error);
 
     XojPdfPageSPtr getPage(size_t page) const override;
     size_t getPageCount() const override;
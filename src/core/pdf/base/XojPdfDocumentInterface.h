@@ -37,6 +37,11 @@ public:
     virtual bool isLoaded() const = 0;
     virtual void reset() = 0;
 
+    /**
+     * Open the PDF of doc again, as an independent document which can be used in parallel with doc
+     */
+    virtual bool loadIndependentCopy(XojPdfDocumentInterface* doc, GError** error) = 0;
+
     virtual XojPdfPageSPtr getPage(size_t page) const = 0;
     virtual size_t getPageCount() const = 0;
     virtual XojPdfBookmarkIterator* getContentsIter() const = 0;
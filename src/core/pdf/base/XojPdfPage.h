@@ -75,6 +75,12 @@ public:
     virtual void render(cairo_t* cr) const = 0;
     virtual void renderForPrinting(cairo_t* cr) const = 0;
 
+    /**
+     * Renders the part of the page inside the given rectangle (in page coordinates), like render() does.
+     * The rest of the cairo context is left untouched, so that the context can be a surface covering only this part.
+     */
+    virtual void renderRegion(cairo_t* cr, const XojPdfRectangle& region) const = 0;
+
     virtual std::vector<XojPdfRectangle> findText(const std::string& text) = 0;
 
     /// Retrieve the text contained in the provided rectangle using the given
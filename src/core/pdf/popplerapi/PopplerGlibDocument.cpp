@@ -2,6 +2,7 @@
 
 #include <memory>    // for make_shared
 #include <optional>  // for optional
+#include <utility>   // for move
 
 #include <poppler-document.h>  // for poppler_document_get_n_...
 
@@ -17,7 +18,8 @@ using std::string;
 
 PopplerGlibDocument::PopplerGlibDocument() = default;
 
-PopplerGlibDocument::PopplerGlibDocument(const PopplerGlibDocument& doc): document(doc.document) {
+PopplerGlibDocument::PopplerGlibDocument(const PopplerGlibDocument& doc):
+        document(doc.document), filepath(doc.filepath), data(doc.data), password(doc.password) {
     if (document) {
         g_object_ref(document);
     }
@@ -35,10 +37,14 @@ void PopplerGlibDocument::assign(XojPdfDocumentInterface* doc) {
         g_object_unref(document);
     }
 
-    document = (dynamic_cast<PopplerGlibDocument*>(doc))->document;
+    auto* other = dynamic_cast<PopplerGlibDocument*>(doc);
+    document = other->document;
     if (document) {
         g_object_ref(document);
     }
+    filepath = other->filepath;
+    data = other->data;
+    password = other->password;
 }
 
 auto PopplerGlibDocument::equals(XojPdfDocumentInterface* doc) const -> bool {
@@ -69,6 +75,9 @@ auto PopplerGlibDocument::load(fs::path const& file, string password, GError** e
     }
 
     this->document = poppler_document_new_from_file(uri->c_str(), password.c_str(), error);
+    this->filepath = file;
+    this->data.reset();
+    this->password = std::move(password);
     return this->document != nullptr;
 }
 
@@ -77,8 +86,40 @@ auto PopplerGlibDocument::load(gpointer data, gsize length, string password, GEr
         g_object_unref(document);
     }
 
-    this->document =
-            poppler_document_new_from_data(static_cast<char*>(data), static_cast<int>(length), password.c_str(), error);
+    // Keep the data alive for the copies of the document
+    this->data = std::make_shared<std::string>(static_cast<char*>(data), length);
+    this->filepath.clear();
+    this->password = std::move(password);
+    this->document = poppler_document_new_from_data(this->data->data(), static_cast<int>(length),
+                                                    this->password.c_str(), error);
+    return this->document != nullptr;
+}
+
+auto PopplerGlibDocument::loadIndependentCopy(XojPdfDocumentInterface* doc, GError** error) -> bool {
+    auto* other = dynamic_cast<PopplerGlibDocument*>(doc);
+    if (other == nullptr || other->document == nullptr) {
+        return false;
+    }
+
+    if (document) {
+        g_object_unref(document);
+        document = nullptr;
+    }
+
+    this->filepath = other->filepath;
+    this->data = other->data;
+    this->password = other->password;
+
+    if (this->data) {
+        this->document = poppler_document_new_from_data(this->data->data(), static_cast<int>(this->data->size()),
+                                                        this->password.c_str(), error);
+    } else {
+        auto uri = Util::toUri(this->filepath);
+        if (!uri) {
+            return false;
+        }
+        this->document = poppler_document_new_from_file(uri->c_str(), this->password.c_str(), error);
+    }
     return this->document != nullptr;
 }
 
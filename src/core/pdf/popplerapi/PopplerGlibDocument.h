@@ -17,6 +17,9 @@
 #include <glib.h>     // for GError, gpointer, gsize
 #include <poppler.h>  // for PopplerDocument
 
+#include <memory>  // for shared_ptr
+#include <string>  // for string
+
 #include "pdf/base/XojPdfDocumentInterface.h"  // for XojPdfDocumentInterface
 #include "pdf/base/XojPdfPage.h"               // for XojPdfPageSPtr
 
@@ -40,6 +43,7 @@ public:
     bool load(gpointer data, gsize length, std::string password, GError** error) override;
     bool isLoaded() const override;
     void reset() override;
+    bool loadIndependentCopy(XojPdfDocumentInterface* doc, GError** error) override;
 
     XojPdfPageSPtr getPage(size_t page) const override;
     size_t getPageCount() const override;
@@ -47,4 +51,12 @@ public:
 
 private:
     PopplerDocument* document = nullptr;
+
+    /**
+     * Where the document was loaded from, to load independent copies of it. A PopplerDocument cannot be used by
+     * several threads at once.
+     */
+    fs::path filepath;
+    std::shared_ptr<std::string> data;
+    std::string password;
 };
@@ -82,6 +82,16 @@ void PopplerGlibPage::render(cairo_t* cr) const {
 
 void PopplerGlibPage::renderForPrinting(cairo_t* cr) const { poppler_page_render_for_printing(page, cr); }
 
+void PopplerGlibPage::renderRegion(cairo_t* cr, const XojPdfRectangle& region) const {
+    cairo_save(cr);
+    cairo_rectangle(cr, region.x1, region.y1, region.x2 - region.x1, region.y2 - region.y1);
+    cairo_clip(cr);
+    cairo_set_source_rgb(cr, 1., 1., 1.);
+    cairo_paint(cr);
+    poppler_page_render(page, cr);
+    cairo_restore(cr);
+}
+
 auto PopplerGlibPage::getPageId() const -> int { return poppler_page_get_index(page); }
 
 auto PopplerGlibPage::findText(const std::string& text) -> std::vector<XojPdfRectangle> {
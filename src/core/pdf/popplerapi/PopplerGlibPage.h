@@ -33,6 +33,7 @@ public:
 
     void render(cairo_t* cr) const override;
     void renderForPrinting(cairo_t* cr) const override;
+    void renderRegion(cairo_t* cr, const XojPdfRectangle& region) const override;
 
     std::vector<XojPdfRectangle> findText(const std::string& text) override;
 
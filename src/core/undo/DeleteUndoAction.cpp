@@ -1,6 +1,7 @@
 #include "DeleteUndoAction.h"
 
 #include <memory>  // for __shared_ptr_access, __shared_pt...
+#include <vector>  // for vector
 
 #include <glib.h>  // for g_warning
 
@@ -56,6 +57,16 @@ auto DeleteUndoAction::redo(Control*) -> bool {
     return true;
 }
 
+auto DeleteUndoAction::getDetachedElements() const -> std::vector<Element*> {
+    std::vector<Element*> res;
+    if (!this->undone) {
+        for (const auto& elem: elements) {
+            res.push_back(elem.element);
+        }
+    }
+    return res;
+}
+
 auto DeleteUndoAction::getText() -> std::string {
     if (eraser) {
         return _("Erase stroke");
@@ -13,6 +13,7 @@
 
 #include <set>     // for multiset
 #include <string>  // for string
+#include <vector>  // for vector
 
 #include "model/Element.h"  // for Element, Element::Index
 #include "model/PageRef.h"  // for PageRef
@@ -35,6 +36,8 @@ public:
 
     std::string getText() override;
 
+    std::vector<Element*> getDetachedElements() const override;
+
 private:
     std::multiset<PageLayerPosEntry<Element>> elements{};
     bool eraser = true;
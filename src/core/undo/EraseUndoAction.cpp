@@ -57,6 +57,18 @@ void EraseUndoAction::finalize() {
     this->page->firePageChanged();
 }
 
+auto EraseUndoAction::getDetachedElements() const -> std::vector<Element*> {
+    std::vector<Element*> res;
+    for (auto const& entry: this->undone ? edited : original) {
+        if (!this->undone && entry.element->getPointCount() == 0) {
+            // Left in its layer by finalize()
+            continue;
+        }
+        res.push_back(entry.element);
+    }
+    return res;
+}
+
 auto EraseUndoAction::getText() -> std::string { return _("Erase stroke"); }
 
 auto EraseUndoAction::undo(Control* control) -> bool {
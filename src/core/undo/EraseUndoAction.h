@@ -13,6 +13,7 @@
 
 #include <set>     // for multiset
 #include <string>  // for string
+#include <vector>  // for vector
 
 #include "model/PageRef.h"  // for PageRef
 #include "model/Stroke.h"   // for Stroke
@@ -39,6 +40,8 @@ public:
 
     std::string getText() override;
 
+    std::vector<Element*> getDetachedElements() const override;
+
 private:
     std::multiset<PageLayerPosEntry<Stroke>> edited{};
     std::multiset<PageLayerPosEntry<Stroke>> original{};
@@ -68,10 +68,10 @@ void MergeLayerDownUndoAction::triggerUIUpdate(Control* control) {
      *     When this implementation is called by the `UndoRedoHandler` the
      *     document is locked. Calling `layerChanged` adds a render job which
      *     can only be processed when the document is unlocked again, but might
-     *     have already claimed `Scheduler::jobRunningMutex`.
-     *     `fireRebuildLayerMenu` will wait for `jobRunningMutex` to be free,
-     *     so calling `fireRebuildLayerMenu` AFTER `layerChanged` will likely
-     *     result in a DEADLOCK.
+     *     already be running on a scheduler worker.
+     *     `fireRebuildLayerMenu` will wait for the running jobs of the removed
+     *     sidebar previews to finish, so calling `fireRebuildLayerMenu` AFTER
+     *     `layerChanged` will likely result in a DEADLOCK.
      */
 
     /*
@@ -3,6 +3,8 @@
 #include <memory>   // for __shared_ptr_access, allocator
 #include <utility>  // for move
 
+#include <gdk-pixbuf/gdk-pixbuf.h>  // for gdk_pixbuf_get_byte_length
+
 #include "control/Control.h"  // for Control
 #include "model/Document.h"   // for Document
 #include "model/XojPage.h"    // for XojPage
@@ -82,3 +84,12 @@ auto PageBackgroundChangedUndoAction::redo(Control* control) -> bool {
 }
 
 auto PageBackgroundChangedUndoAction::getText() -> std::string { return _("Page background changed"); }
+
+auto PageBackgroundChangedUndoAction::getMemoryUsage() const -> size_t {
+    size_t bytes = sizeof(PageBackgroundChangedUndoAction);
+    // Does not depend on the current background of the page: the usage must not change while the action is counted
+    if (GdkPixbuf* pixbuf = this->origType.isImagePage() ? this->origBackgroundImage.getPixbuf() : nullptr) {
+        bytes += gdk_pixbuf_get_byte_length(pixbuf);
+    }
+    return bytes;
+}
@@ -11,7 +11,8 @@
 
 #pragma once
 
-#include <string>  // for string
+#include <cstddef>  // for size_t
+#include <string>   // for string
 
 #include "model/BackgroundImage.h"  // for BackgroundImage
 #include "model/PageRef.h"          // for PageRef
@@ -34,6 +35,11 @@ public:
 
     std::string getText() override;
 
+    /**
+     * Counts the background image replaced by the change, which is kept by this action (and possibly by other pages)
+     */
+    size_t getMemoryUsage() const override;
+
 private:
     PageType origType;
     int origPdfPage;
@@ -2,6 +2,11 @@
 
 #include <utility>  // for move
 
+#include "model/Element.h"  // for Element, ELEMENT_IMAGE, ELEMENT_STROKE
+#include "model/Image.h"    // for Image
+#include "model/Point.h"    // for Point
+#include "model/Stroke.h"   // for Stroke
+
 UndoAction::UndoAction(std::string className): className(std::move(className)) {}
 
 auto UndoAction::getPages() -> std::vector<PageRef> {
@@ -11,3 +16,37 @@ auto UndoAction::getPages() -> std::vector<PageRef> {
 }
 
 auto UndoAction::getClassName() const -> std::string const& { return this->className; }
+
+auto UndoAction::getDetachedElements() const -> std::vector<Element*> { return {}; }
+
+/**
+ * The memory of the points of the stroke, which are moved to the spill file when the action is spilled
+ */
+static auto getPointsMemoryUsage(const Stroke* s) -> size_t {
+    size_t pointSize = s->getPointVector().hasPressureChannel() ? sizeof(Point) : 2 * sizeof(double);
+    return static_cast<size_t>(s->getPointCount()) * pointSize;
+}
+
+auto UndoAction::getMemoryUsage() const -> size_t {
+    size_t bytes = sizeof(UndoAction);
+    for (const Element* e: getDetachedElements()) {
+        if (e->getType() == ELEMENT_STROKE) {
+            bytes += sizeof(Stroke) + getPointsMemoryUsage(static_cast<const Stroke*>(e));
+        } else if (e->getType() == ELEMENT_IMAGE) {
+            bytes += sizeof(Image) + static_cast<const Image*>(e)->getRawDataLength();
+        } else {
+            bytes += sizeof(Element);
+        }
+    }
+    return bytes;
+}
+
+auto UndoAction::getSpillableMemoryUsage() const -> size_t {
+    size_t bytes = 0;
+    for (const Element* e: getDetachedElements()) {
+        if (e->getType() == ELEMENT_STROKE) {
+            bytes += getPointsMemoryUsage(static_cast<const Stroke*>(e));
+        }
+    }
+    return bytes;
+}
@@ -11,13 +11,15 @@
 
 #pragma once
 
-#include <memory>  // for unique_ptr
-#include <string>  // for string
-#include <vector>  // for vector
+#include <cstddef>  // for size_t
+#include <memory>   // for unique_ptr
+#include <string>   // for string
+#include <vector>   // for vector
 
 #include "model/PageRef.h"  // for PageRef
 
 class Control;
+class Element;
 
 class UndoAction {
 public:
@@ -35,6 +37,23 @@ public:
      */
     virtual std::vector<PageRef> getPages();
 
+    /**
+     * Get the elements which are only kept alive by this action (e.g. the deleted strokes), i.e. which are in no layer
+     * as long as the action is not undone
+     */
+    virtual std::vector<Element*> getDetachedElements() const;
+
+    /**
+     * An estimate of the memory (in bytes) held by this action
+     */
+    virtual size_t getMemoryUsage() const;
+
+    /**
+     * The part of getMemoryUsage() which is freed by spilling the action (see UndoSpillFile), i.e. the points of the
+     * detached strokes. 0 once the action is spilled.
+     */
+    size_t getSpillableMemoryUsage() const;
+
     auto getClassName() const -> std::string const&;
 
 protected:
@@ -1,13 +1,13 @@
 #include "UndoRedoHandler.h"
 
-#include <algorithm>  // for find_if
+#include <algorithm>  // for find_if, min
 #include <cinttypes>  // for PRIu64
 #include <cstdint>    // for uint64_t
 #include <iterator>   // for end, begin
 #include <memory>     // for unique_ptr, allocator_traits<>::value_type
 #include <utility>    // for move
 
-#include <glib.h>  // for g_message, g_assert_true
+#include <glib.h>  // for g_message, g_assert_true, g_warning
 
 #include "control/Control.h"  // for Control
 #include "model/Document.h"   // for Document
@@ -80,6 +80,11 @@ void UndoRedoHandler::clearContents() {
     undoList.clear();
     clearRedo();
 
+    this->spillFile.clear();
+    this->spilledCount = 0;
+    this->memoryUsage = 0;
+    this->spillableMemoryUsage = 0;
+
     this->savedUndo = nullptr;
     this->autosavedUndo = nullptr;
 
@@ -104,11 +109,19 @@ void UndoRedoHandler::undo() {
     g_assert_true(this->undoList.back());
 
     auto& undoAction = *this->undoList.back();
+    bool spilled = this->undoList.size() <= this->spilledCount;
     this->redoList.emplace_back(std::move(this->undoList.back()));
     this->undoList.pop_back();
+    if (spilled) {
+        this->spilledCount = this->undoList.size();
+    }
+    uncountMemoryOfLastAction();
 
     Document* doc = control->getDocument();
     doc->lock();
+    if (spilled && !this->spillFile.restore(&undoAction)) {
+        g_warning("Some strokes of \"%s\" could not be restored", undoAction.getText().c_str());
+    }
     bool undoResult = undoAction.undo(this->control);
     doc->unlock();
 
@@ -133,6 +146,7 @@ void UndoRedoHandler::redo() {
 
     UndoAction& redoAction = *this->redoList.back();
 
+    countMemoryOfLastAction();
     this->undoList.emplace_back(std::move(this->redoList.back()));
     this->redoList.pop_back();
 
@@ -148,6 +162,8 @@ void UndoRedoHandler::redo() {
         XojMsgBox::showErrorToUser(control->getGtkWindow(), msg);
     }
 
+    enforceMemoryBudget();
+
     fireUpdateUndoRedoButtons(redoAction.getPages());
 
     printContents();
@@ -165,8 +181,10 @@ void UndoRedoHandler::addUndoAction(UndoActionPtr action) {
         return;
     }
 
+    countMemoryOfLastAction();
     this->undoList.emplace_back(std::move(action));
     clearRedo();
+    enforceMemoryBudget();
     fireUpdateUndoRedoButtons(this->undoList.back()->getPages());
 
     printContents();
@@ -232,3 +250,50 @@ void UndoRedoHandler::documentAutosaved() {
 void UndoRedoHandler::documentSaved() {
     this->savedUndo = this->undoList.empty() ? nullptr : this->undoList.back().get();
 }
+
+void UndoRedoHandler::setMemoryBudget(size_t bytes) {
+    this->memoryBudget = bytes;
+    enforceMemoryBudget();
+}
+
+void UndoRedoHandler::countMemoryOfLastAction() {
+    if (!this->undoList.empty()) {
+        this->memoryUsage += this->undoList.back()->getMemoryUsage();
+        this->spillableMemoryUsage += this->undoList.back()->getSpillableMemoryUsage();
+    }
+}
+
+void UndoRedoHandler::uncountMemoryOfLastAction() {
+    if (!this->undoList.empty()) {
+        // A spilled action is uncounted before it is restored: it counts the same memory as after it was spilled
+        this->memoryUsage -= std::min(this->memoryUsage, this->undoList.back()->getMemoryUsage());
+        this->spillableMemoryUsage -=
+                std::min(this->spillableMemoryUsage, this->undoList.back()->getSpillableMemoryUsage());
+    }
+}
+
+void UndoRedoHandler::enforceMemoryBudget() {
+    if (this->memoryBudget == 0) {
+        return;
+    }
+
+    // Only the points of the strokes can be spilled: if the rest of the memory (e.g. images) exceeds the budget on its
+    // own, spilling cannot help, and the strokes stay in memory
+    if (this->memoryUsage - std::min(this->memoryUsage, this->spillableMemoryUsage) >= this->memoryBudget) {
+        return;
+    }
+
+    // Spill the oldest actions first, so that the spilled actions stay at the beginning of the list
+    while (this->memoryUsage > this->memoryBudget && this->spilledCount + 1 < this->undoList.size()) {
+        UndoAction* action = this->undoList[this->spilledCount].get();
+        size_t usage = action->getMemoryUsage();
+        size_t spillable = action->getSpillableMemoryUsage();
+        if (!this->spillFile.spill(action, action->getDetachedElements())) {
+            break;
+        }
+        // The rest of the memory of the action stays counted
+        this->memoryUsage -= std::min(this->memoryUsage, usage - std::min(usage, action->getMemoryUsage()));
+        this->spillableMemoryUsage -= std::min(this->spillableMemoryUsage, spillable);
+        this->spilledCount++;
+    }
+}
@@ -11,13 +11,15 @@
 
 #pragma once
 
-#include <deque>   // for deque
-#include <string>  // for string
-#include <vector>  // for vector
+#include <cstddef>  // for size_t
+#include <deque>    // for deque
+#include <string>   // for string
+#include <vector>   // for vector
 
 #include "model/PageRef.h"  // for PageRef
 
-#include "UndoAction.h"  // for UndoActionPtr
+#include "UndoAction.h"     // for UndoActionPtr
+#include "UndoSpillFile.h"  // for UndoSpillFile
 
 class Control;
 
@@ -55,10 +57,29 @@ public:
     void documentAutosaved();
     void documentSaved();
 
+    /**
+     * Set the memory (in bytes) the undo history may hold. Beyond it, the strokes of the oldest actions are moved to a
+     * temporary file until the actions are undone, as long as this can bring the memory under the budget (the rest,
+     * e.g. images, stays in memory). 0 means no limit.
+     */
+    void setMemoryBudget(size_t bytes);
+
 private:
     void clearRedo();
     void printContents();
 
+    /**
+     * Called once an action is put on top of the most recent action of the undo list
+     */
+    void countMemoryOfLastAction();
+
+    /**
+     * Called before the most recent action of the undo list is removed (undo)
+     */
+    void uncountMemoryOfLastAction();
+
+    void enforceMemoryBudget();
+
 private:
     std::deque<UndoActionPtr> undoList;
     std::deque<UndoActionPtr> redoList;
@@ -68,5 +89,24 @@ private:
 
     std::vector<UndoRedoListener*> listener;
 
+    size_t memoryBudget = 0;
+
+    /**
+     * The memory held by the actions of the undo list, except the most recent one: it may still be filled (e.g. by the
+     * eraser), so it is never spilled. The spilled actions only count the memory which could not be spilled.
+     */
+    size_t memoryUsage = 0;
+
+    /**
+     * The part of memoryUsage which spilling the actions would free (see UndoAction::getSpillableMemoryUsage())
+     */
+    size_t spillableMemoryUsage = 0;
+
+    /**
+     * The number of actions, at the beginning of the undo list, whose strokes are in the spill file
+     */
+    size_t spilledCount = 0;
+    UndoSpillFile spillFile;
+
     Control* control = nullptr;
 };
@@ -0,0 +1,138 @@
+#include "UndoSpillFile.h"
+
+#include <atomic>        // for atomic
+#include <string>        // for string, to_string
+#include <system_error>  // for error_code
+#include <utility>       // for move
+
+#include <glib.h>  // for g_warning, g_string_free
+
+#include "model/Element.h"                          // for Element, ELEMENT_STROKE
+#include "model/Stroke.h"                           // for Stroke
+#include "util/GzUtil.h"                            // for GzUtil
+#include "util/PathUtil.h"                          // for getTmpDirSubfolder
+#include "util/serializing/BinObjectEncoding.h"     // for BinObjectEncoding
+#include "util/serializing/InputStreamException.h"  // for InputStreamException
+#include "util/serializing/ObjectInputStream.h"     // for ObjectInputStream
+#include "util/serializing/ObjectOutputStream.h"    // for ObjectOutputStream
+
+UndoSpillFile::~UndoSpillFile() {
+    if (this->file.is_open()) {
+        this->file.close();
+    }
+    if (!this->path.empty()) {
+        std::error_code ec;
+        fs::remove(this->path, ec);
+    }
+}
+
+auto UndoSpillFile::open() -> bool {
+    if (this->file.is_open()) {
+        return true;
+    }
+    if (this->path.empty()) {
+        static std::atomic<unsigned int> fileCount{0};
+        this->path = Util::getTmpDirSubfolder("undo") / ("spill-" + std::to_string(fileCount++) + ".bin");
+    }
+    this->file.open(this->path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    this->fileSize = 0;
+    if (!this->file.is_open()) {
+        g_warning("Could not open the undo spill file \"%s\"", this->path.u8string().c_str());
+        return false;
+    }
+    return true;
+}
+
+auto UndoSpillFile::spill(const UndoAction* action, const std::vector<Element*>& elements) -> bool {
+    Entry entry;
+    for (Element* e: elements) {
+        if (e->getType() == ELEMENT_STROKE) {
+            entry.strokes.push_back(static_cast<Stroke*>(e));
+        }
+    }
+
+    if (!entry.strokes.empty()) {
+        ObjectOutputStream out(new BinObjectEncoding());
+        for (const Stroke* s: entry.strokes) {
+            s->serialize(out);
+        }
+        GString* data = out.getStr();
+        std::string member = GzUtil::compress(data->str, data->len);
+        g_string_free(data, true);
+
+        if (member.empty() || !open()) {
+            return false;
+        }
+        this->file.clear();
+        this->file.seekp(static_cast<std::streamoff>(this->fileSize));
+        this->file.write(member.data(), static_cast<std::streamsize>(member.size()));
+        if (!this->file.flush()) {
+            g_warning("Could not write to the undo spill file \"%s\"", this->path.u8string().c_str());
+            return false;
+        }
+
+        entry.offset = this->fileSize;
+        entry.length = member.size();
+        this->fileSize += member.size();
+
+        for (Stroke* s: entry.strokes) {
+            s->deletePointsFrom(0);
+            s->freeUnusedPointItems();
+        }
+    }
+
+    this->entries[action] = std::move(entry);
+    return true;
+}
+
+auto UndoSpillFile::restore(const UndoAction* action) -> bool {
+    auto it = this->entries.find(action);
+    if (it == this->entries.end()) {
+        return true;
+    }
+    Entry entry = std::move(it->second);
+    this->entries.erase(it);
+
+    bool success = true;
+    if (!entry.strokes.empty()) {
+        std::string member(entry.length, '\0');
+        this->file.clear();
+        this->file.seekg(static_cast<std::streamoff>(entry.offset));
+        this->file.read(member.data(), static_cast<std::streamsize>(member.size()));
+        std::string data = this->file ? GzUtil::decompress(member.data(), member.size()) : std::string();
+
+        try {
+            ObjectInputStream in;
+            if (data.empty() || !in.read(data.data(), static_cast<int>(data.size()))) {
+                throw InputStreamException("Could not read the spilled strokes", __FILE__, __LINE__);
+            }
+            for (Stroke* s: entry.strokes) {
+                s->readSerialized(in);
+            }
+        } catch (const InputStreamException& e) {
+            g_warning("Could not restore the undo data from \"%s\": %s", this->path.u8string().c_str(), e.what());
+            success = false;
+        }
+    }
+
+    if (this->entries.empty() && this->file.is_open()) {
+        // Nothing left in the file: start over at its beginning
+        this->file.close();
+        this->fileSize = 0;
+    }
+    return success;
+}
+
+auto UndoSpillFile::isSpilled(const UndoAction* action) const -> bool {
+    return this->entries.find(action) != this->entries.end();
+}
+
+void UndoSpillFile::clear() {
+    this->entries.clear();
+    if (this->file.is_open()) {
+        this->file.close();
+    }
+    this->fileSize = 0;
+}
+
+auto UndoSpillFile::getFileSize() const -> size_t { return this->fileSize; }
@@ -0,0 +1,86 @@
+/*
+ * Xournal++
+ *
+ * Temporary file holding the strokes of the old undo actions
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>        // for size_t
+#include <fstream>        // for fstream
+#include <unordered_map>  // for unordered_map
+#include <vector>         // for vector
+
+#include "filesystem.h"  // for path
+
+class Element;
+class Stroke;
+class UndoAction;
+
+/**
+ * Moves the points of the strokes only kept alive by old undo actions (the deleted and erased strokes) to a temporary
+ * file, compressed, and reads them back when the action is undone.
+ *
+ * The strokes are spilled in place: the Stroke objects stay in memory, since the undo actions refer to them by
+ * pointer, and only their serialized content goes to the file. A spilled stroke has no points until it is restored.
+ * The other elements (images, texts...) are not spilled.
+ */
+class UndoSpillFile {
+public:
+    UndoSpillFile() = default;
+    ~UndoSpillFile();
+    UndoSpillFile(const UndoSpillFile&) = delete;
+    UndoSpillFile& operator=(const UndoSpillFile&) = delete;
+
+    /**
+     * Spill the strokes among the elements, and mark the action as spilled
+     *
+     * @return false if the strokes could not be written, in which case they are left untouched
+     */
+    bool spill(const UndoAction* action, const std::vector<Element*>& elements);
+
+    /**
+     * Restore the strokes of the action, if it was spilled
+     *
+     * @return false if the strokes could not be read back
+     */
+    bool restore(const UndoAction* action);
+
+    bool isSpilled(const UndoAction* action) const;
+
+    /**
+     * Forget all the spilled actions, e.g. because they were deleted
+     */
+    void clear();
+
+    /**
+     * @return The size of the temporary file, in bytes
+     */
+    size_t getFileSize() const;
+
+private:
+    bool open();
+
+private:
+    struct Entry {
+        std::vector<Stroke*> strokes;
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    std::unordered_map<const UndoAction*, Entry> entries;
+
+    fs::path path;
+    std::fstream file;
+
+    /**
+     * The end of the data in the file. The space of the restored entries is only reclaimed once all entries are
+     * restored.
+     */
+    size_t fileSize = 0;
+};
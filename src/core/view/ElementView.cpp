@@ -1,6 +1,8 @@
 #include <cassert>  // for assert
 #include <memory>   // for make_unique, unique_ptr
 
+#include <cairo.h>  // for cairo_surface_get_type
+
 #include "model/Element.h"   // for Element, ELEMENT_IMAGE, ELEMENT_STROKE
 #include "model/Image.h"     // for Image
 #include "model/Stroke.h"    // for Stroke
@@ -11,7 +13,7 @@
 #include "StrokeView.h"    // for StrokeView
 #include "TexImageView.h"  // for TexImageView
 #include "TextView.h"      // for TextView
-#include "View.h"          // for ElementView, view
+#include "View.h"          // for ElementView, isVectorSurface
 
 using namespace xoj::view;
 
@@ -30,3 +32,16 @@ auto ElementView::createFromElement(const Element* e) -> std::unique_ptr<Element
             return nullptr;
     }
 }
+
+auto xoj::view::isVectorSurface(cairo_surface_t* surface) -> bool {
+    switch (cairo_surface_get_type(surface)) {
+        case CAIRO_SURFACE_TYPE_PDF:
+        case CAIRO_SURFACE_TYPE_PS:
+        case CAIRO_SURFACE_TYPE_SVG:
+        case CAIRO_SURFACE_TYPE_RECORDING:
+        case CAIRO_SURFACE_TYPE_SCRIPT:
+            return true;
+        default:
+            return false;
+    }
+}
@@ -1,9 +1,11 @@
 #include "ImageView.h"
 
+#include <cmath>  // for hypot
+
 #include <cairo.h>  // for cairo_image_surface_get_height, cairo_image...
 
 #include "model/Image.h"  // for Image
-#include "view/View.h"    // for Context, OPACITY_NO_AUDIO, view
+#include "view/View.h"    // for Context, OPACITY_NO_AUDIO, isVectorSurface
 
 using namespace xoj::view;
 
@@ -14,11 +16,27 @@ ImageView::~ImageView() = default;
 void ImageView::draw(const Context& ctx) const {
     cairo_t* cr = ctx.cr;
 
+    xoj::util::CairoSurfaceSPtr img;
+    if (cairo_surface_t* target = cairo_get_group_target(cr); isVectorSurface(target)) {
+        img = image->getImage();
+    } else {
+        // Use the level of the mipmap pyramid matching the number of device pixels the image covers
+        cairo_matrix_t matrix;
+        cairo_get_matrix(cr, &matrix);
+        double scaleX = 1.0;
+        double scaleY = 1.0;
+        cairo_surface_get_device_scale(target, &scaleX, &scaleY);
+        img = image->getImage(image->getElementWidth() * std::hypot(matrix.xx, matrix.yx) * scaleX,
+                              image->getElementHeight() * std::hypot(matrix.xy, matrix.yy) * scaleY);
+    }
+    if (!img) {
+        return;
+    }
+
     cairo_save(cr);
 
-    cairo_surface_t* img = image->getImage();
-    int width = cairo_image_surface_get_width(img);
-    int height = cairo_image_surface_get_height(img);
+    int width = cairo_image_surface_get_width(img.get());
+    int height = cairo_image_surface_get_height(img.get());
 
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
 
@@ -27,7 +45,7 @@ void ImageView::draw(const Context& ctx) const {
 
     cairo_scale(cr, xFactor, yFactor);
 
-    cairo_set_source_surface(cr, img, image->getX() / xFactor, image->getY() / yFactor);
+    cairo_set_source_surface(cr, img.get(), image->getX() / xFactor, image->getY() / yFactor);
     // make images translucent when highlighting elements with audio, as they can not have audio
     if (ctx.fadeOutNonAudio) {
         cairo_paint_with_alpha(cr, OPACITY_NO_AUDIO);
@@ -8,6 +8,7 @@
 
 #include "model/Element.h"  // for Element
 #include "model/Layer.h"    // for Layer
+#include "util/Range.h"     // for Range
 
 #include "DebugShowRepaintBounds.h"  // for IF_DEBUG_REPAINT
 #include "View.h"                    // for Context, ElementView
@@ -28,7 +29,7 @@ void LayerView::draw(const Context& ctx) const {
     double maxY;
     cairo_clip_extents(ctx.cr, &minX, &minY, &maxX, &maxY);
 
-    for (auto& e: layer->getElements()) {
+    for (auto& e: layer->getElementsInRange(Range(minX, minY, maxX, maxY))) {
 
         IF_DEBUG_REPAINT({
             auto cr = ctx.cr;
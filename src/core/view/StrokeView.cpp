@@ -100,7 +100,7 @@ void StrokeView::draw(const Context& ctx) const {
             ErasableStrokeView erasableStrokeView(*erasable);
             erasableStrokeView.drawFilling(cr);
         } else {
-            StrokeViewHelper::pathToCairo(cr, s->getPointVector());
+            StrokeViewHelper::pathToCairo(cr, *s);
             cairo_fill(cr);
         }
     }
@@ -133,9 +133,9 @@ void StrokeView::draw(const Context& ctx) const {
         ErasableStrokeView erasableStrokeView(*erasable);
         erasableStrokeView.draw(cr);
     } else if (s->hasPressure() && !highlighter) {
-        StrokeViewHelper::drawWithPressure(cr, s->getPointVector(), s->getLineStyle());
+        StrokeViewHelper::drawWithPressure(cr, *s);
     } else {
-        StrokeViewHelper::drawNoPressure(cr, s->getPointVector(), s->getWidth(), s->getLineStyle());
+        StrokeViewHelper::drawNoPressure(cr, *s);
     }
 
     if (useMask) {
@@ -1,12 +1,18 @@
 #include "StrokeViewHelper.h"
 
 #include <cassert>
+#include <cmath>
+#include <memory>
+#include <utility>
 
+#include "model/CachedPath.h"
 #include "model/LineStyle.h"
 #include "model/Point.h"
+#include "model/Stroke.h"
+#include "model/StrokePoints.h"
 #include "util/LoopUtil.h"
-#include "util/PairView.h"
-#include "util/Util.h"  // for cairo_set_dash_from_vector
+#include "util/Util.h"                // for cairo_set_dash_from_vector
+#include "util/raii/CairoWrappers.h"  // for CairoSPtr
 
 void xoj::view::StrokeViewHelper::pathToCairo(cairo_t* cr, const std::vector<Point>& pts) {
     for_first_then_each(
@@ -28,11 +34,103 @@ void xoj::view::StrokeViewHelper::drawNoPressure(cairo_t* cr, const std::vector<
     cairo_stroke(cr);
 }
 
+double xoj::view::StrokeViewHelper::drawWithPressure(cairo_t* cr, const std::vector<Point>& pts,
+                                                     const LineStyle& lineStyle, double dashOffset) {
+    if (lineStyle.hasDashes()) {
+        return strokeSegmentsWithPressure(cr, pts, lineStyle, dashOffset);
+    }
+    fillPressureOutline(cr, pts);
+    return dashOffset;
+}
+
+/**
+ * Add to the path one end of the outline of a segment, from c + r * (uy, -ux) to c + r * (-uy, ux),
+ * where (ux, uy) is the outward unit vector along the segment.
+ */
+static void addSegmentEnd(cairo_t* cr, double cx, double cy, double ux, double uy, double r, cairo_line_cap_t cap) {
+    switch (cap) {
+        case CAIRO_LINE_CAP_ROUND: {
+            const double angle = std::atan2(uy, ux);
+            cairo_arc(cr, cx, cy, r, angle - M_PI_2, angle + M_PI_2);
+            break;
+        }
+        case CAIRO_LINE_CAP_SQUARE:
+            cairo_line_to(cr, cx + r * (uy + ux), cy + r * (uy - ux));
+            cairo_line_to(cr, cx + r * (ux - uy), cy + r * (ux + uy));
+            break;
+        case CAIRO_LINE_CAP_BUTT:
+        default:
+            cairo_line_to(cr, cx + r * uy, cy - r * ux);
+            cairo_line_to(cr, cx - r * uy, cy + r * ux);
+            break;
+    }
+}
+
+/**
+ * Add the outlines of the segments to the path (see fillPressureOutline())
+ * @param pts std::vector<Point> or StrokePoints
+ */
+template <typename Points>
+static void pressureOutlineToCairo(cairo_t* cr, const Points& pts, cairo_line_cap_t cap) {
+    if (pts.size() < 2) {
+        return;
+    }
+
+    /*
+     * All the outlines are traversed in the same direction (increasing angles), so that the nonzero winding rule
+     * fills their union without any seam between the segments.
+     */
+    const size_t last = pts.size() - 2;
+    for (size_t i = 0; i <= last; i++) {
+        const Point p = pts[i];
+        const Point q = pts[i + 1];
+        assert(p.z > 0.0);
+
+        const double r = p.z / 2;
+        const cairo_line_cap_t startCap = i == 0 ? cap : CAIRO_LINE_CAP_ROUND;
+        const cairo_line_cap_t endCap = i == last ? cap : CAIRO_LINE_CAP_ROUND;
+
+        cairo_new_sub_path(cr);
+
+        const double length = p.lineLengthTo(q);
+        if (length == 0.0) {
+            // cairo_stroke() only draws degenerate segments with round caps
+            if (startCap == CAIRO_LINE_CAP_ROUND || endCap == CAIRO_LINE_CAP_ROUND) {
+                cairo_arc(cr, p.x, p.y, r, 0, 2 * M_PI);
+                cairo_close_path(cr);
+            }
+            continue;
+        }
+
+        const double ux = (q.x - p.x) / length;
+        const double uy = (q.y - p.y) / length;
+        addSegmentEnd(cr, q.x, q.y, ux, uy, r, endCap);
+        addSegmentEnd(cr, p.x, p.y, -ux, -uy, r, startCap);
+        cairo_close_path(cr);
+    }
+}
+
+/**
+ * Fill the path with the nonzero winding rule, i.e. paint the union of its subpaths if they all have the same direction
+ */
+static void fillUnion(cairo_t* cr) {
+    const cairo_fill_rule_t fillRule = cairo_get_fill_rule(cr);
+    cairo_set_fill_rule(cr, CAIRO_FILL_RULE_WINDING);
+    cairo_fill(cr);
+    cairo_set_fill_rule(cr, fillRule);
+}
+
+void xoj::view::StrokeViewHelper::fillPressureOutline(cairo_t* cr, const std::vector<Point>& pts) {
+    pressureOutlineToCairo(cr, pts, cairo_get_line_cap(cr));
+    fillUnion(cr);
+}
+
 /**
  * Draw a stroke with pressure, for this multiple lines with different widths needs to be drawn
+ * @param pts std::vector<Point> or StrokePoints
  */
-double xoj::view::StrokeViewHelper::drawWithPressure(cairo_t* cr, const std::vector<Point>& pts,
-                                                     const LineStyle& lineStyle, double dashOffset) {
+template <typename Points>
+static double strokeSegments(cairo_t* cr, const Points& pts, const LineStyle& lineStyle, double dashOffset) {
     const auto& dashes = lineStyle.getDashes();
 
     /*
@@ -47,16 +145,106 @@ double xoj::view::StrokeViewHelper::drawWithPressure(cairo_t* cr, const std::vec
     };
 
     if (!dashes.empty()) {
-        for (const auto& [p, q]: PairView(pts)) {
+        for (size_t i = 1; i < pts.size(); i++) {
+            const Point p = pts[i - 1];
+            const Point q = pts[i];
             Util::cairo_set_dash_from_vector(cr, dashes, dashOffset);
             dashOffset += p.lineLengthTo(q);
             drawSegment(p, q);
         }
     } else {
         cairo_set_dash(cr, nullptr, 0, 0.0);
-        for (const auto& [p, q]: PairView(pts)) {
-            drawSegment(p, q);
+        for (size_t i = 1; i < pts.size(); i++) {
+            drawSegment(pts[i - 1], pts[i]);
         }
     }
     return dashOffset;
 }
+
+double xoj::view::StrokeViewHelper::strokeSegmentsWithPressure(cairo_t* cr, const std::vector<Point>& pts,
+                                                               const LineStyle& lineStyle, double dashOffset) {
+    return strokeSegments(cr, pts, lineStyle, dashOffset);
+}
+
+/**
+ * Build a path in page coordinates, on a context used for nothing else
+ */
+template <typename Fun>
+static auto makePath(Fun addToPath) -> std::shared_ptr<const cairo_path_t> {
+    /*
+     * Cairo stores the paths as fixed point numbers (24.8) in device space: the scaling keeps the cached paths
+     * accurate enough for high zoom levels, for pages up to 131072pt.
+     */
+    constexpr double SCRATCH_SCALE = 64.0;
+    thread_local xoj::util::CairoSPtr scratch = [] {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+        xoj::util::CairoSPtr cr(cairo_create(surface), xoj::util::adopt);
+        cairo_surface_destroy(surface);
+        cairo_scale(cr.get(), SCRATCH_SCALE, SCRATCH_SCALE);
+        return cr;
+    }();
+
+    cairo_new_path(scratch.get());
+    addToPath(scratch.get());
+    return std::shared_ptr<const cairo_path_t>(cairo_copy_path(scratch.get()), [](const cairo_path_t* path) {
+        cairo_path_destroy(const_cast<cairo_path_t*>(path));
+    });
+}
+
+static auto getPolyline(const Stroke& s) -> std::shared_ptr<const cairo_path_t> {
+    auto geometry = s.getCachedGeometry();
+    if (geometry && geometry->polyline) {
+        if (auto path = geometry->polyline->get()) {
+            return path;
+        }
+    }
+
+    auto path = makePath([&s](cairo_t* cr) {
+        // The polyline does not need the pressure values
+        for_first_then_each(
+                s.getPointVector().getCoordinates(), [cr](auto const& first) { cairo_move_to(cr, first.x, first.y); },
+                [cr](auto const& other) { cairo_line_to(cr, other.x, other.y); });
+    });
+    StrokeGeometry updated = geometry ? *geometry : StrokeGeometry();
+    updated.polyline = std::make_shared<const CachedPath>(path);
+    s.setCachedGeometry(std::make_shared<const StrokeGeometry>(std::move(updated)));
+    return path;
+}
+
+static auto getPressureOutline(const Stroke& s, cairo_line_cap_t cap) -> std::shared_ptr<const cairo_path_t> {
+    auto geometry = s.getCachedGeometry();
+    if (geometry && geometry->pressureOutline && geometry->pressureOutlineCap == cap) {
+        if (auto path = geometry->pressureOutline->get()) {
+            return path;
+        }
+    }
+
+    auto path = makePath([&s, cap](cairo_t* cr) { pressureOutlineToCairo(cr, s.getPointVector(), cap); });
+    StrokeGeometry updated = geometry ? *geometry : StrokeGeometry();
+    updated.pressureOutline = std::make_shared<const CachedPath>(path);
+    updated.pressureOutlineCap = cap;
+    s.setCachedGeometry(std::make_shared<const StrokeGeometry>(std::move(updated)));
+    return path;
+}
+
+void xoj::view::StrokeViewHelper::pathToCairo(cairo_t* cr, const Stroke& s) {
+    cairo_append_path(cr, getPolyline(s).get());
+}
+
+void xoj::view::StrokeViewHelper::drawNoPressure(cairo_t* cr, const Stroke& s) {
+    cairo_set_line_width(cr, s.getWidth());
+    Util::cairo_set_dash_from_vector(cr, s.getLineStyle().getDashes(), 0);
+
+    pathToCairo(cr, s);
+    cairo_stroke(cr);
+}
+
+void xoj::view::StrokeViewHelper::drawWithPressure(cairo_t* cr, const Stroke& s) {
+    if (s.getLineStyle().hasDashes()) {
+        strokeSegments(cr, s.getPointVector(), s.getLineStyle(), 0);
+        return;
+    }
+
+    cairo_append_path(cr, getPressureOutline(s, cairo_get_line_cap(cr)).get());
+    fillUnion(cr);
+}
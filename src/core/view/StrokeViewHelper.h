@@ -17,6 +17,7 @@
 
 class LineStyle;
 class Point;
+class Stroke;
 
 namespace xoj::view::StrokeViewHelper {
 
@@ -32,9 +33,33 @@ void drawNoPressure(cairo_t* cr, const std::vector<Point>& pts, const double str
                     double dashOffset = 0);
 
 /**
- * @brief Draw a stroke with pressure, for this multiple lines with different widths needs to be drawn.
+ * @brief Draw a stroke with pressure. The width of each segment is the pressure (z) of its first point.
+ *
+ * Solid strokes are filled at once (see fillPressureOutline()). Dashed strokes are drawn segment by segment.
  * @return New dash offset, if one wants to keep on drawing the same stroke.
  *      Effectively, the return value equals dashOffset + length of the path.
  */
 double drawWithPressure(cairo_t* cr, const std::vector<Point>& pts, const LineStyle& lineStyle, double dashOffset = 0);
+
+/**
+ * @brief Draw a solid stroke with pressure with a single cairo_fill(): the outline of each segment is added to the
+ * path, and the path is filled with the nonzero winding rule, i.e. the union of the outlines is painted.
+ *
+ * The joins are round. The caps at both ends of the stroke follow the line cap of the cairo context.
+ */
+void fillPressureOutline(cairo_t* cr, const std::vector<Point>& pts);
+
+/**
+ * @brief Draw a stroke with pressure with one cairo_stroke() per segment
+ * @return New dash offset (see drawWithPressure())
+ */
+double strokeSegmentsWithPressure(cairo_t* cr, const std::vector<Point>& pts, const LineStyle& lineStyle,
+                                  double dashOffset = 0);
+
+/**
+ * The overloads below draw a whole stroke. They reuse the geometry cached in the stroke, or compute and cache it.
+ */
+void pathToCairo(cairo_t* cr, const Stroke& s);
+void drawNoPressure(cairo_t* cr, const Stroke& s);
+void drawWithPressure(cairo_t* cr, const Stroke& s);
 };  // namespace xoj::view::StrokeViewHelper
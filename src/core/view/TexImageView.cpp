@@ -1,13 +1,15 @@
 #include "TexImageView.h"
 
+#include <cmath>   // for hypot
 #include <string>  // for string
 
 #include <cairo.h>             // for cairo_paint_with_alpha, cairo_scale
 #include <glib.h>              // for g_warning
-#include <poppler.h>           // for PopplerPage, PopplerDocument, g_clear_...
+#include <poppler.h>           // for PopplerDocument, poppler_document_get_n...
 
-#include "model/TexImage.h"  // for TexImage
-#include "view/View.h"       // for Context, OPACITY_NO_AUDIO, view
+#include "model/TexImage.h"           // for TexImage
+#include "util/raii/CairoWrappers.h"  // for CairoSurfaceSPtr
+#include "view/View.h"                // for Context, OPACITY_NO_AUDIO, isVectorSurface
 
 using namespace xoj::view;
 
@@ -26,21 +28,38 @@ void TexImageView::draw(const Context& ctx) const {
     if (pdf != nullptr) {
         if (poppler_document_get_n_pages(pdf) < 1) {
             g_warning("Got latex PDF without pages!: %s", texImage->getText().c_str());
+            cairo_restore(cr);
             return;
         }
 
-        PopplerPage* page = poppler_document_get_page(pdf, 0);
-
-        double pageWidth = 0;
-        double pageHeight = 0;
-        poppler_page_get_size(page, &pageWidth, &pageHeight);
-
-        double xFactor = texImage->getElementWidth() / pageWidth;
-        double yFactor = texImage->getElementHeight() / pageHeight;
+        // On screen, paint a cached raster instead of rendering the PDF again. Exports and prints stay vectorial.
+        if (cairo_surface_t* target = cairo_get_group_target(cr); !isVectorSurface(target)) {
+            cairo_matrix_t matrix;
+            cairo_get_matrix(cr, &matrix);
+            double scaleX = 1.0;
+            double scaleY = 1.0;
+            cairo_surface_get_device_scale(target, &scaleX, &scaleY);
+            xoj::util::CairoSurfaceSPtr raster =
+                    texImage->getRaster(texImage->getElementWidth() * std::hypot(matrix.xx, matrix.yx) * scaleX,
+                                        texImage->getElementHeight() * std::hypot(matrix.xy, matrix.yy) * scaleY);
+            if (raster) {
+                cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+                cairo_translate(cr, texImage->getX(), texImage->getY());
+                cairo_scale(cr, texImage->getElementWidth() / cairo_image_surface_get_width(raster.get()),
+                            texImage->getElementHeight() / cairo_image_surface_get_height(raster.get()));
+                cairo_set_source_surface(cr, raster.get(), 0, 0);
+                // Make TeX images translucent when highlighting audio strokes as they can not have audio
+                if (ctx.fadeOutNonAudio) {
+                    cairo_paint_with_alpha(cr, OPACITY_NO_AUDIO);
+                } else {
+                    cairo_paint(cr);
+                }
+                cairo_restore(cr);
+                return;
+            }
+        }
 
         cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-        cairo_translate(cr, texImage->getX(), texImage->getY());
-        cairo_scale(cr, xFactor, yFactor);
 
         // Make TeX images translucent when highlighting audio strokes as they can not have audio
         if (ctx.fadeOutNonAudio) {
@@ -49,16 +68,14 @@ void TexImageView::draw(const Context& ctx) const {
              * This sets the current pattern to the temporary surface.
              */
             cairo_push_group(cr);
-            poppler_page_render(page, cr);
+            texImage->drawPdf(cr);
             cairo_pop_group_to_source(cr);
 
             // paint the temporary surface with opacity level
             cairo_paint_with_alpha(cr, OPACITY_NO_AUDIO);
         } else {
-            poppler_page_render(page, cr);
+            texImage->drawPdf(cr);
         }
-
-        g_clear_object(&page);
     } else if (img != nullptr) {
         int width = cairo_image_surface_get_width(img);
         int height = cairo_image_surface_get_height(img);
@@ -45,9 +45,28 @@ void TextView::draw(const Context& ctx) const {
 
     cairo_translate(ctx.cr, text->getX(), text->getY());
 
-    auto layout = initPango(ctx.cr, text);
-    const std::string& content = text->getText();
-    pango_layout_set_text(layout.get(), content.c_str(), static_cast<int>(content.length()));
+    text->withPangoLayout([cr = ctx.cr](PangoLayout* layout) {
+        updateFontOptions(cr, layout);
+        pango_cairo_show_layout(cr, layout);
+    });
+}
+
+void TextView::updateFontOptions(cairo_t* cr, PangoLayout* layout) {
+    /*
+     * Like pango_cairo_update_layout(), but leaves the matrix alone: changing the context forces the layout to be
+     * shaped again, which should only happen if the target needs other font options (e.g. on export).
+     */
+    cairo_font_options_t* options = cairo_font_options_create();
+    cairo_surface_get_font_options(cairo_get_target(cr), options);
+    cairo_font_options_t* crOptions = cairo_font_options_create();
+    cairo_get_font_options(cr, crOptions);
+    cairo_font_options_merge(options, crOptions);
+    cairo_font_options_destroy(crOptions);
 
-    pango_cairo_show_layout(ctx.cr, layout.get());
+    PangoContext* context = pango_layout_get_context(layout);
+    const cairo_font_options_t* current = pango_cairo_context_get_font_options(context);
+    if (current == nullptr || !cairo_font_options_equal(current, options)) {
+        pango_cairo_context_set_font_options(context, options);
+    }
+    cairo_font_options_destroy(options);
 }
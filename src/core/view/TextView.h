@@ -37,6 +37,12 @@ public:
      */
     static xoj::util::GObjectSPtr<PangoLayout> initPango(cairo_t* cr, const Text* t);
 
+private:
+    /**
+     * Set the font options of the target of cr to the context of the layout, if they differ
+     */
+    static void updateFontOptions(cairo_t* cr, PangoLayout* layout);
+
 private:
     const Text* text;
 };
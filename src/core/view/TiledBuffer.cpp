@@ -0,0 +1,221 @@
+#include "TiledBuffer.h"
+
+#include <algorithm>  // for all_of, clamp, copy_if, max, min
+#include <cmath>      // for floor, ceil
+#include <iterator>   // for back_inserter
+
+#include "util/raii/CairoWrappers.h"  // for CairoSaveGuard
+
+using namespace xoj::view;
+
+std::atomic<size_t> TiledBuffer::totalMemoryUsage{0};
+
+TiledBuffer::~TiledBuffer() { releaseAllUnlocked(); }
+
+void TiledBuffer::setPageSize(double width, double height) {
+    std::lock_guard lock(this->mutex);
+    if (this->pageWidth != width || this->pageHeight != height) {
+        releaseAllUnlocked();
+        this->zoom = 0;
+    }
+    this->pageWidth = width;
+    this->pageHeight = height;
+}
+
+bool TiledBuffer::isInitialized() const {
+    std::lock_guard lock(this->mutex);
+    return this->zoom > 0;
+}
+
+double TiledBuffer::getZoom() const {
+    std::lock_guard lock(this->mutex);
+    return this->zoom;
+}
+
+auto TiledBuffer::getTilesIn(const Range& rg, double zoom) const -> std::vector<TileIndex> {
+    std::vector<TileIndex> res;
+    if (rg.empty() || zoom <= 0.0) {
+        return res;
+    }
+
+    const int lastCol = std::max(0, static_cast<int>(std::ceil(this->pageWidth * zoom / TILE_SIZE)) - 1);
+    const int lastRow = std::max(0, static_cast<int>(std::ceil(this->pageHeight * zoom / TILE_SIZE)) - 1);
+
+    const int firstCol = std::clamp(static_cast<int>(std::floor(rg.minX * zoom / TILE_SIZE)), 0, lastCol);
+    const int firstRow = std::clamp(static_cast<int>(std::floor(rg.minY * zoom / TILE_SIZE)), 0, lastRow);
+    const int endCol = std::clamp(static_cast<int>(std::floor(rg.maxX * zoom / TILE_SIZE)), 0, lastCol);
+    const int endRow = std::clamp(static_cast<int>(std::floor(rg.maxY * zoom / TILE_SIZE)), 0, lastRow);
+
+    res.reserve(static_cast<size_t>((endCol - firstCol + 1) * (endRow - firstRow + 1)));
+    for (int row = firstRow; row <= endRow; row++) {
+        for (int col = firstCol; col <= endCol; col++) { res.push_back({col, row}); }
+    }
+    return res;
+}
+
+auto TiledBuffer::getTileExtent(const TileIndex& index, double zoom) const -> Range {
+    const double size = TILE_SIZE / zoom;
+    return Range(index.col * size, index.row * size, std::min((index.col + 1) * size, this->pageWidth),
+                 std::min((index.row + 1) * size, this->pageHeight));
+}
+
+auto TiledBuffer::createTileMask(const TileIndex& index, int dpiScaling, double zoom) const -> Mask {
+    return Mask(dpiScaling, getTileExtent(index, zoom), zoom, CAIRO_CONTENT_COLOR_ALPHA);
+}
+
+void TiledBuffer::replaceAll(double zoom, std::vector<std::pair<TileIndex, Mask>> newTiles) {
+    std::map<TileIndex, Mask> oldTiles;  // Destroyed after the mutex is released
+    {
+        std::lock_guard lock(this->mutex);
+        std::swap(oldTiles, this->tiles);
+        totalMemoryUsage -= this->memoryUsage;
+        this->memoryUsage = 0;
+        this->zoom = zoom;
+        for (auto&& [index, tile]: newTiles) {
+            size_t size = getTileMemorySize(tile);
+            this->memoryUsage += size;
+            totalMemoryUsage += size;
+            this->tiles.insert_or_assign(index, std::move(tile));
+        }
+    }
+}
+
+void TiledBuffer::addTile(double zoom, const TileIndex& index, Mask&& tile) {
+    std::lock_guard lock(this->mutex);
+    if (this->zoom != zoom) {
+        return;
+    }
+
+    if (auto it = this->tiles.find(index); it != this->tiles.end()) {
+        size_t size = getTileMemorySize(it->second);
+        this->memoryUsage -= size;
+        totalMemoryUsage -= size;
+        this->tiles.erase(it);
+    }
+
+    size_t size = getTileMemorySize(tile);
+    this->memoryUsage += size;
+    totalMemoryUsage += size;
+    this->tiles.emplace(index, std::move(tile));
+}
+
+auto TiledBuffer::getMissingTiles(const std::vector<TileIndex>& list, double zoom) const -> std::vector<TileIndex> {
+    std::lock_guard lock(this->mutex);
+    if (this->zoom != zoom) {
+        return list;
+    }
+
+    std::vector<TileIndex> res;
+    std::copy_if(list.begin(), list.end(), std::back_inserter(res),
+                 [&](const TileIndex& index) { return this->tiles.count(index) == 0; });
+    return res;
+}
+
+bool TiledBuffer::coversPage() const {
+    std::lock_guard lock(this->mutex);
+    if (this->zoom <= 0.0) {
+        return false;
+    }
+    auto all = getTilesIn(Range(0, 0, this->pageWidth, this->pageHeight), this->zoom);
+    return std::all_of(all.begin(), all.end(), [&](const TileIndex& index) { return this->tiles.count(index) != 0; });
+}
+
+auto TiledBuffer::getAllocatedExtent() const -> Range {
+    std::lock_guard lock(this->mutex);
+    Range res;
+    for (auto&& [index, tile]: this->tiles) { res = res.unite(getTileExtent(index, this->zoom)); }
+    return res;
+}
+
+void TiledBuffer::paintOnTiles(const Mask& mask, const Range& extent) {
+    std::lock_guard lock(this->mutex);
+    if (this->zoom != mask.getZoom()) {
+        return;
+    }
+    for (auto&& [index, tile]: this->tiles) {
+        if (!getTileExtent(index, this->zoom).intersect(extent).empty()) {
+            mask.paintTo(tile.get());
+        }
+    }
+}
+
+void TiledBuffer::drawOnTiles(const Range& rg, const std::function<void(cairo_t*)>& draw) {
+    std::lock_guard lock(this->mutex);
+    for (auto&& [index, tile]: this->tiles) {
+        if (rg.empty() || !getTileExtent(index, this->zoom).intersect(rg).empty()) {
+            xoj::util::CairoSaveGuard guard(tile.get());
+            draw(tile.get());
+        }
+    }
+}
+
+bool TiledBuffer::paintTo(cairo_t* cr) const {
+    std::lock_guard lock(this->mutex);
+    if (this->zoom <= 0) {
+        return false;
+    }
+
+    double x1 = 0;
+    double y1 = 0;
+    double x2 = 0;
+    double y2 = 0;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+
+    bool complete = true;
+    for (auto&& index: getTilesIn(Range(x1, y1, x2, y2).intersect(Range(0, 0, pageWidth, pageHeight)), this->zoom)) {
+        if (auto it = this->tiles.find(index); it != this->tiles.end()) {
+            it->second.paintTo(cr);
+        } else {
+            complete = false;
+            Range extent = getTileExtent(index, this->zoom);
+            xoj::util::CairoSaveGuard guard(cr);
+            cairo_set_source_rgb(cr, 1, 1, 1);
+            cairo_rectangle(cr, extent.minX, extent.minY, extent.getWidth(), extent.getHeight());
+            cairo_fill(cr);
+        }
+    }
+    return complete;
+}
+
+void TiledBuffer::evictOutside(const Range& keep) {
+    std::lock_guard lock(this->mutex);
+    for (auto it = this->tiles.begin(); it != this->tiles.end();) {
+        if (keep.empty() || getTileExtent(it->first, this->zoom).intersect(keep).empty()) {
+            size_t size = getTileMemorySize(it->second);
+            this->memoryUsage -= size;
+            totalMemoryUsage -= size;
+            it = this->tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void TiledBuffer::reset() {
+    std::lock_guard lock(this->mutex);
+    releaseAllUnlocked();
+    this->zoom = 0;
+}
+
+size_t TiledBuffer::getMemoryUsage() const {
+    std::lock_guard lock(this->mutex);
+    return this->memoryUsage;
+}
+
+size_t TiledBuffer::getTotalMemoryUsage() { return totalMemoryUsage; }
+
+size_t TiledBuffer::getTileMemorySize(const Mask& tile) {
+    cairo_surface_t* surface = cairo_get_target(const_cast<Mask&>(tile).get());
+    if (cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE) {
+        // Rough estimate for non image surfaces
+        return static_cast<size_t>(TILE_SIZE) * TILE_SIZE * 4;
+    }
+    return static_cast<size_t>(cairo_image_surface_get_stride(surface)) *
+           static_cast<size_t>(cairo_image_surface_get_height(surface));
+}
+
+void TiledBuffer::releaseAllUnlocked() {
+    totalMemoryUsage -= this->memoryUsage;
+    this->memoryUsage = 0;
+    this->tiles.clear();
+}
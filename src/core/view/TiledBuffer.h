@@ -0,0 +1,170 @@
+/*
+ * Xournal++
+ *
+ * A page backbuffer split into tiles
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>      // for atomic
+#include <cstddef>     // for size_t
+#include <functional>  // for function
+#include <map>         // for map
+#include <mutex>       // for mutex
+#include <utility>     // for pair
+#include <vector>      // for vector
+
+#include <cairo.h>  // for cairo_t
+
+#include "util/Range.h"  // for Range
+
+#include "Mask.h"  // for Mask
+
+namespace xoj::view {
+
+/**
+ * @brief Backbuffer of a page, split into square tiles of fixed size (in device space).
+ *
+ * Only the tiles which have been rendered are allocated, so at high zoom levels only the visible part of the page (and
+ * a small margin around it) costs memory. All the tiles of a TiledBuffer have been rendered with the same zoom.
+ *
+ * All methods are thread safe.
+ */
+class TiledBuffer {
+public:
+    /**
+     * Width and height of a tile, in device pixels (before DPI scaling)
+     */
+    static constexpr int TILE_SIZE = 512;
+
+    struct TileIndex {
+        int col;
+        int row;
+
+        bool operator<(const TileIndex& o) const { return row < o.row || (row == o.row && col < o.col); }
+    };
+
+    TiledBuffer() = default;
+    TiledBuffer(const TiledBuffer&) = delete;
+    TiledBuffer& operator=(const TiledBuffer&) = delete;
+    ~TiledBuffer();
+
+    /**
+     * @brief Set the page dimensions. Must be called before any tile is added.
+     */
+    void setPageSize(double width, double height);
+
+    /**
+     * @return true if some content has been rendered (possibly at another zoom)
+     */
+    bool isInitialized() const;
+
+    /**
+     * @return The zoom at which the current tiles have been rendered
+     */
+    double getZoom() const;
+
+    /**
+     * @brief The tiles covering the given range (in page coordinates), at the given zoom level
+     */
+    std::vector<TileIndex> getTilesIn(const Range& rg, double zoom) const;
+
+    /**
+     * @brief The extent of a tile, in page coordinates
+     */
+    Range getTileExtent(const TileIndex& index, double zoom) const;
+
+    /**
+     * @brief Create an empty mask for the given tile, ready to be rendered to
+     */
+    Mask createTileMask(const TileIndex& index, int dpiScaling, double zoom) const;
+
+    /**
+     * @brief Replace the entire content of the buffer by the given tiles, rendered at the given zoom
+     */
+    void replaceAll(double zoom, std::vector<std::pair<TileIndex, Mask>> tiles);
+
+    /**
+     * @brief Add a tile. The tile is dropped if the buffer's zoom has changed since it was rendered.
+     */
+    void addTile(double zoom, const TileIndex& index, Mask&& tile);
+
+    /**
+     * @brief Filter out the tiles that are already present
+     */
+    std::vector<TileIndex> getMissingTiles(const std::vector<TileIndex>& tiles, double zoom) const;
+
+    /**
+     * @brief The union of the extents of the allocated tiles
+     */
+    Range getAllocatedExtent() const;
+
+    /**
+     * @return true if all the tiles of the page are allocated
+     */
+    bool coversPage() const;
+
+    /**
+     * @brief Paint the mask onto every allocated tile it overlaps. Used to update parts of the page.
+     */
+    void paintOnTiles(const Mask& mask, const Range& extent);
+
+    /**
+     * @brief Call `draw` on the cairo context of every allocated tile intersecting rg (all tiles if rg is empty)
+     */
+    void drawOnTiles(const Range& rg, const std::function<void(cairo_t*)>& draw);
+
+    /**
+     * @brief Paint the tiles intersecting the clip region of cr. cr must be in page coordinates.
+     *  Missing tiles are filled in white.
+     * @return true if all the tiles in the clip region were available
+     */
+    bool paintTo(cairo_t* cr) const;
+
+    /**
+     * @brief Free all the tiles which do not intersect `keep`
+     */
+    void evictOutside(const Range& keep);
+
+    /**
+     * @brief Free all the tiles
+     */
+    void reset();
+
+    /**
+     * @return The memory (in bytes) used by the tiles of this buffer
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * @return The memory (in bytes) used by the tiles of all the buffers
+     */
+    static size_t getTotalMemoryUsage();
+
+private:
+    static size_t getTileMemorySize(const Mask& tile);
+    void releaseAllUnlocked();
+
+private:
+    mutable std::mutex mutex;
+
+    double pageWidth = 0;
+    double pageHeight = 0;
+
+    /**
+     * The zoom of the tiles. 0 if the buffer has never been rendered
+     */
+    double zoom = 0;
+
+    std::map<TileIndex, Mask> tiles;
+
+    size_t memoryUsage = 0;
+
+    static std::atomic<size_t> totalMemoryUsage;
+};
+};  // namespace xoj::view
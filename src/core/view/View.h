@@ -48,5 +48,11 @@ class StrokeView;
 class TextView;
 
 constexpr double OPACITY_NO_AUDIO = 0.3;
+
+/**
+ * Whether the surface is a vector surface (PDF/SVG export, printing...), on which elements are drawn at full resolution
+ * instead of using cached rasters
+ */
+bool isVectorSurface(cairo_surface_t* surface);
 };  // namespace view
 };  // namespace xoj
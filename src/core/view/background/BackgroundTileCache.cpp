@@ -0,0 +1,97 @@
+#include "BackgroundTileCache.h"
+
+#include <cstddef>  // for size_t
+#include <list>     // for list
+#include <mutex>    // for mutex, lock_guard
+#include <utility>  // for move
+
+#include "util/raii/CairoWrappers.h"  // for CairoSurfaceSPtr
+#include "util/safe_casts.h"          // for ceil_cast
+#include "view/View.h"                // for isVectorSurface
+
+using namespace xoj::view;
+using xoj::util::CairoSurfaceSPtr;
+
+namespace {
+/// Larger tiles would mean very few periods on screen, which are cheaper to draw directly
+constexpr int MAX_TILE_SIZE = 512;
+
+/// Number of tiles kept: a few zoom levels of each pattern in use
+constexpr size_t MAX_TILES = 32;
+
+struct Tile {
+    PageTypeFormat format;
+    double periodX;
+    double periodY;
+    double lineWidth;
+    int width;
+    int height;
+    CairoSurfaceSPtr surface;
+};
+
+std::mutex tilesMutex;
+std::list<Tile> tiles;  ///< From the most to the least recently used
+
+auto getTile(const BackgroundTileCache::Pattern& pattern, int width, int height) -> CairoSurfaceSPtr {
+    std::lock_guard<std::mutex> lock(tilesMutex);
+    for (auto it = tiles.begin(); it != tiles.end(); ++it) {
+        if (it->format == pattern.format && it->periodX == pattern.periodX && it->periodY == pattern.periodY &&
+            it->lineWidth == pattern.lineWidth && it->width == width && it->height == height) {
+            tiles.splice(tiles.begin(), tiles, it);
+            return it->surface;
+        }
+    }
+
+    CairoSurfaceSPtr surface(cairo_image_surface_create(CAIRO_FORMAT_A8, width, height), xoj::util::adopt);
+    cairo_t* cr = cairo_create(surface.get());
+    cairo_scale(cr, width / pattern.periodX, height / pattern.periodY);
+    pattern.drawPeriod(cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(surface.get());
+
+    tiles.push_front({pattern.format, pattern.periodX, pattern.periodY, pattern.lineWidth, width, height, surface});
+    if (tiles.size() > MAX_TILES) {
+        tiles.pop_back();
+    }
+    return surface;
+}
+}  // namespace
+
+auto BackgroundTileCache::paint(cairo_t* cr, const Pattern& pattern, double originX, double originY,
+                                const xoj::util::Rectangle<double>& area, Color color) -> bool {
+    cairo_surface_t* target = cairo_get_group_target(cr);
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    if (isVectorSurface(target) || matrix.xy != 0.0 || matrix.yx != 0.0 || matrix.xx <= 0.0 || matrix.yy <= 0.0) {
+        return false;
+    }
+
+    // The size of a period, in device pixels
+    double deviceScaleX = 1.0;
+    double deviceScaleY = 1.0;
+    cairo_surface_get_device_scale(target, &deviceScaleX, &deviceScaleY);
+    const int width = ceil_cast<int>(pattern.periodX * matrix.xx * deviceScaleX);
+    const int height = ceil_cast<int>(pattern.periodY * matrix.yy * deviceScaleY);
+    if (width <= 0 || height <= 0 || width > MAX_TILE_SIZE || height > MAX_TILE_SIZE) {
+        return false;
+    }
+
+    CairoSurfaceSPtr tile = getTile(pattern, width, height);
+
+    cairo_pattern_t* mask = cairo_pattern_create_for_surface(tile.get());
+    cairo_pattern_set_extend(mask, CAIRO_EXTEND_REPEAT);
+    cairo_matrix_t tileMatrix;  // From page coordinates to tile pixels
+    cairo_matrix_init_scale(&tileMatrix, width / pattern.periodX, height / pattern.periodY);
+    cairo_matrix_translate(&tileMatrix, -originX, -originY);
+    cairo_pattern_set_matrix(mask, &tileMatrix);
+
+    cairo_save(cr);
+    cairo_rectangle(cr, area.x, area.y, area.width, area.height);
+    cairo_clip(cr);
+    Util::cairo_set_source_rgbi(cr, color);
+    cairo_mask(cr, mask);
+    cairo_restore(cr);
+
+    cairo_pattern_destroy(mask);
+    return true;
+}
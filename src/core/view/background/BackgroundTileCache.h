@@ -0,0 +1,54 @@
+/*
+ * Xournal++
+ *
+ * Pre-rendered tiles of periodic background patterns
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <functional>  // for function
+
+#include <cairo.h>  // for cairo_t
+
+#include "model/PageType.h"  // for PageTypeFormat
+#include "util/Color.h"      // for Color
+#include "util/Rectangle.h"  // for Rectangle
+
+namespace xoj::view {
+/**
+ * @brief Paints periodic patterns (like the dots of dotted backgrounds) by repeating a tile rendered once per zoom
+ * level, instead of drawing every period again on each repaint.
+ *
+ * The tiles are alpha masks: backgrounds with the same pattern share a tile, whatever their page or color.
+ */
+class BackgroundTileCache {
+public:
+    /**
+     * @brief Describes one period of a pattern
+     */
+    struct Pattern {
+        PageTypeFormat format;
+        double periodX;
+        double periodY;
+        double lineWidth;
+
+        /// Draws the pattern in [0, periodX] x [0, periodY] (in page coordinates), in any opaque color. Nothing drawn
+        /// may cross the borders of the period.
+        std::function<void(cairo_t*)> drawPeriod;
+    };
+
+    /**
+     * @brief Paints the pattern repeated over `area` (in page coordinates, further restricted by the clip of cr)
+     * @param originX, originY Where the top left corner of a period lies, in page coordinates
+     * @return false if the pattern cannot be tiled on this target (vector surfaces, rotations, huge zooms...). Nothing
+     * has been painted then, and the caller must draw the pattern itself.
+     */
+    static bool paint(cairo_t* cr, const Pattern& pattern, double originX, double originY,
+                      const xoj::util::Rectangle<double>& area, Color color);
+};
+};  // namespace xoj::view
@@ -23,6 +23,10 @@ void BaseIsometricBackgroundView::draw(cairo_t* cr) const {
     // Paint the background color
     PlainBackgroundView::draw(cr);
 
+    drawGrid(cr);
+}
+
+auto BaseIsometricBackgroundView::getPageGrid() const -> Grid {
     const double xstep = std::sqrt(3.0) / 2.0 * triangleSize;
     const double ystep = triangleSize / 2.0;
 
@@ -32,10 +36,13 @@ void BaseIsometricBackgroundView::draw(cairo_t* cr) const {
     int rows = static_cast<int>(std::floor((pageHeight - 2 * margin) / ystep));
 
     // Center the grid on the page
+    return {cols, rows, xstep, ystep, (pageWidth - cols * xstep) / 2, (pageHeight - rows * ystep) / 2};
+}
+
+void BaseIsometricBackgroundView::drawGrid(cairo_t* cr) const {
+    auto [cols, rows, xstep, ystep, contentXOffset, contentYOffset] = getPageGrid();
     const double contentWidth = cols * xstep;
     const double contentHeight = rows * ystep;
-    double contentXOffset = (pageWidth - contentWidth) / 2;
-    double contentYOffset = (pageHeight - contentHeight) / 2;
 
     // Get the bounds of the mask, in page coordinates
     double minX;
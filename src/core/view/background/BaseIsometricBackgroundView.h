@@ -29,6 +29,24 @@ public:
     virtual void draw(cairo_t* cr) const override;
 
 protected:
+    /**
+     * @brief The grid of the whole page: cols x rows steps, centered on the page
+     */
+    struct Grid {
+        int cols;
+        int rows;
+        double xstep;
+        double ystep;
+        double xOffset;
+        double yOffset;
+    };
+    Grid getPageGrid() const;
+
+    /**
+     * @brief Draws the part of the grid visible in the mask represented by cr, without the background color
+     */
+    void drawGrid(cairo_t* cr) const;
+
     virtual void paintGrid(cairo_t* cr, int cols, int rows, double xstep, double ystep, double xOffset,
                            double yOffset) const = 0;
 
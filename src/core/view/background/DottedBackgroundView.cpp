@@ -3,10 +3,14 @@
 #include <memory>  // for allocator
 
 #include "model/BackgroundConfig.h"                  // for BackgroundConfig
+#include "model/PageType.h"                          // for PageTypeFormat
+#include "util/Rectangle.h"                          // for Rectangle
 #include "view/background/BackgroundView.h"          // for view
 #include "view/background/OneColorBackgroundView.h"  // for OneColorBackgrou...
 #include "view/background/PlainBackgroundView.h"     // for PlainBackgroundView
 
+#include "BackgroundTileCache.h"  // for BackgroundTileCache
+
 using namespace background_config_strings;
 using namespace xoj::view;
 
@@ -37,6 +41,30 @@ void DottedBackgroundView::draw(cairo_t* cr) const {
     auto [indexMinY, indexMaxY] =
             getIndexBounds(minY - halfLineWidth, maxY + halfLineWidth, squareSize, squareSize, pageHeight);
 
+    if (indexMinX > indexMaxX || indexMinY > indexMaxY) {
+        return;
+    }
+
+    // The dots are at the center of the tiles, which are never smaller than them
+    if (lineWidth < squareSize) {
+        const double s = squareSize;
+        auto drawDot = [s, lw = lineWidth](cairo_t* cr) {
+            cairo_set_line_width(cr, lw);
+            cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+            cairo_move_to(cr, 0.5 * s, 0.5 * s);
+            cairo_line_to(cr, 0.5 * s, 0.5 * s);
+            cairo_stroke(cr);
+        };
+        BackgroundTileCache::Pattern pattern{PageTypeFormat::Dotted, s, s, lineWidth, drawDot};
+        // Only the dots selected above lie within this area: the next ones are a whole period away
+        xoj::util::Rectangle<double> area(indexMinX * s - halfLineWidth, indexMinY * s - halfLineWidth,
+                                          (indexMaxX - indexMinX) * s + lineWidth,
+                                          (indexMaxY - indexMinY) * s + lineWidth);
+        if (BackgroundTileCache::paint(cr, pattern, -0.5 * s, -0.5 * s, area, foregroundColor)) {
+            return;
+        }
+    }
+
     for (int i = indexMinX; i <= indexMaxX; ++i) {
         double x = i * squareSize;
         for (int j = indexMinY; j <= indexMaxY; ++j) {
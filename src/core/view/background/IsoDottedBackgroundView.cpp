@@ -1,8 +1,15 @@
 #include "IsoDottedBackgroundView.h"
 
+#include <algorithm>  // for min
+
 #include "model/BackgroundConfig.h"                       // for BackgroundC...
+#include "model/PageType.h"                               // for PageTypeFormat
+#include "util/Rectangle.h"                               // for Rectangle
 #include "view/background/BackgroundView.h"               // for view
 #include "view/background/BaseIsometricBackgroundView.h"  // for BaseIsometr...
+#include "view/background/PlainBackgroundView.h"          // for PlainBackgroundView
+
+#include "BackgroundTileCache.h"  // for BackgroundTileCache
 
 using namespace xoj::view;
 
@@ -10,6 +17,41 @@ IsoDottedBackgroundView::IsoDottedBackgroundView(double pageWidth, double pageHe
                                                  const BackgroundConfig& config):
         BaseIsometricBackgroundView(pageWidth, pageHeight, backgroundColor, config, DEFAULT_LINE_WIDTH) {}
 
+void IsoDottedBackgroundView::draw(cairo_t* cr) const {
+    // Paint the background color
+    PlainBackgroundView::draw(cr);
+
+    const Grid grid = getPageGrid();
+    if (lineWidth < std::min(grid.xstep, grid.ystep) && grid.cols >= 0 && grid.rows >= 0) {
+        /*
+         * The dots are at (col * xstep, row * ystep) from the grid offset, for col + row odd. A period spans two steps
+         * each way and holds the dots (1, 0) and (0, 1). It starts half a step earlier, so that no dot crosses its
+         * borders.
+         */
+        auto drawDots = [xstep = grid.xstep, ystep = grid.ystep, lw = lineWidth](cairo_t* cr) {
+            cairo_set_line_width(cr, lw);
+            cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+            cairo_move_to(cr, 1.5 * xstep, 0.5 * ystep);
+            cairo_line_to(cr, 1.5 * xstep, 0.5 * ystep);
+            cairo_move_to(cr, 0.5 * xstep, 1.5 * ystep);
+            cairo_line_to(cr, 0.5 * xstep, 1.5 * ystep);
+            cairo_stroke(cr);
+        };
+        BackgroundTileCache::Pattern pattern{PageTypeFormat::IsoDotted, 2 * grid.xstep, 2 * grid.ystep, lineWidth,
+                                             drawDots};
+        // Only the dots of the grid lie within this area: the next ones are a whole step away
+        const double halfLineWidth = 0.5 * lineWidth;
+        xoj::util::Rectangle<double> area(grid.xOffset - halfLineWidth, grid.yOffset - halfLineWidth,
+                                          grid.cols * grid.xstep + lineWidth, grid.rows * grid.ystep + lineWidth);
+        if (BackgroundTileCache::paint(cr, pattern, grid.xOffset - 0.5 * grid.xstep, grid.yOffset - 0.5 * grid.ystep,
+                                       area, foregroundColor)) {
+            return;
+        }
+    }
+
+    drawGrid(cr);
+}
+
 
 void IsoDottedBackgroundView::paintGrid(cairo_t* cr, int cols, int rows, double xstep, double ystep, double xOffset,
                                         double yOffset) const {
@@ -25,6 +25,8 @@ public:
     IsoDottedBackgroundView(double pageWidth, double pageHeight, Color backgroundColor, const BackgroundConfig& config);
     virtual ~IsoDottedBackgroundView() = default;
 
+    virtual void draw(cairo_t* cr) const override;
+
 protected:
     virtual void paintGrid(cairo_t* cr, int cols, int rows, double xstep, double ystep, double xOffset,
                            double yOffset) const override;
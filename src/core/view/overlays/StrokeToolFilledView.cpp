@@ -11,7 +11,7 @@
 
 using namespace xoj::view;
 
-static const Point& setupFirstPoint(const Stroke& s) {
+static Point setupFirstPoint(const Stroke& s) {
     const auto& pts = s.getPointVector();
     assert(!pts.empty());
     return pts.front();
@@ -18,7 +18,9 @@
 using namespace xoj::view;
 
 StrokeToolView::StrokeToolView(const StrokeHandler* strokeHandler, const Stroke& stroke, Repaintable* parent):
-        BaseStrokeToolView(parent, stroke), strokeHandler(strokeHandler), pointBuffer(stroke.getPointVector()) {
+        BaseStrokeToolView(parent, stroke),
+        strokeHandler(strokeHandler),
+        pointBuffer(stroke.getPointVector().toVector()) {
     this->registerToPool(strokeHandler->getViewPool());
     parent->flagDirtyRegion(Range(stroke.boundingRect()));
 }
@@ -107,7 +109,7 @@ void StrokeToolView::on(StrokeToolView::StrokeReplacementRequest, const Stroke&
         // only wipe mask it actually exists (the view has already been drawn at least once)
         this->mask.wipe();
     }
-    this->pointBuffer = newStroke.getPointVector();
+    this->pointBuffer = newStroke.getPointVector().toVector();
     this->dashOffset = 0;
     this->strokeWidth = newStroke.getWidth();
     assert(this->strokeColor == strokeColorWithAlpha(newStroke));
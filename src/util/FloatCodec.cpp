@@ -0,0 +1,232 @@
+#include "util/FloatCodec.h"
+
+#include <cmath>    // for floor, isfinite, signbit, abs
+#include <cstdint>  // for uint64_t
+#include <cstring>  // for strlen
+
+#include "util/Util.h"  // for PRECISION_FORMAT_STRING
+
+namespace {
+
+/**
+ * Number of significant digits of PRECISION_FORMAT_STRING
+ */
+constexpr int SIGNIFICANT_DIGITS = 8;
+
+/**
+ * The powers of ten which are exactly representable as doubles
+ */
+constexpr double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+constexpr int MAX_EXACT_POW10 = 22;
+
+/**
+ * Largest integer below which all integers are exactly representable as doubles
+ */
+constexpr uint64_t MAX_EXACT_INT = uint64_t(1) << 53U;
+
+auto formatFallback(char* buffer, double value) -> size_t {
+    g_ascii_formatd(buffer, Util::FORMAT_DOUBLE_BUF_SIZE, Util::PRECISION_FORMAT_STRING, value);
+    return std::strlen(buffer);
+}
+
+auto parseFallback(const char* str, char** endptr) -> double { return g_ascii_strtod(str, endptr); }
+
+inline auto isDigit(char c) -> bool { return c >= '0' && c <= '9'; }
+
+}  // namespace
+
+auto Util::formatDouble(char* buffer, double value) -> size_t {
+    static_assert(SIGNIFICANT_DIGITS == 8, "The fast path below assumes PRECISION_FORMAT_STRING is \"%.8g\"");
+
+    if (value == 0.0) {
+        char* p = buffer;
+        if (std::signbit(value)) {
+            *p++ = '-';
+        }
+        *p++ = '0';
+        *p = 0;
+        return static_cast<size_t>(p - buffer);
+    }
+
+    const double a = std::abs(value);
+    // Outside this range, the scaling below would not be exact enough: leave it to the C library
+    if (!std::isfinite(value) || a < 1e-5 || a >= 1e15) {
+        return formatFallback(buffer, value);
+    }
+
+    // Decimal exponent, such that 10^exp10 <= a < 10^(exp10+1) (up to rounding errors, corrected below)
+    int exp10 = 0;
+    if (a >= 1.0) {
+        while (exp10 < 14 && a >= POW10[exp10 + 1]) { exp10++; }
+    } else {
+        constexpr double NEG_POW10[] = {1e0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5};
+        exp10 = -1;
+        while (exp10 > -5 && a < NEG_POW10[-exp10]) { exp10--; }
+    }
+
+    // Scale a to [10^7, 10^8). As the power of ten is exact, this is a single correctly rounded operation: the
+    // absolute error is below 1e-8.
+    auto scale = [a](int e) {
+        int k = SIGNIFICANT_DIGITS - 1 - e;
+        return k >= 0 ? a * POW10[k] : a / POW10[-k];
+    };
+    double scaled = scale(exp10);
+    if (scaled < 1e7) {
+        scaled = scale(--exp10);
+    } else if (scaled >= 1e8) {
+        scaled = scale(++exp10);
+    }
+
+    const double integral = std::floor(scaled);
+    const double frac = scaled - integral;
+    if (std::abs(frac - 0.5) < 1e-7) {
+        // Too close to a tie to know the correctly rounded result
+        return formatFallback(buffer, value);
+    }
+
+    auto n = static_cast<uint64_t>(integral) + (frac > 0.5 ? 1U : 0U);
+    if (n == 100000000U) {
+        // Rounding up carried to a new digit
+        n = 10000000U;
+        exp10++;
+    }
+    if (n < 10000000U || n >= 100000000U) {
+        return formatFallback(buffer, value);
+    }
+
+    char digits[SIGNIFICANT_DIGITS];
+    for (int i = SIGNIFICANT_DIGITS - 1; i >= 0; i--) {
+        digits[i] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    }
+    // %g strips the trailing zeros of the fractional part
+    int nDigits = SIGNIFICANT_DIGITS;
+    while (nDigits > 1 && digits[nDigits - 1] == '0') { nDigits--; }
+
+    char* p = buffer;
+    if (std::signbit(value)) {
+        *p++ = '-';
+    }
+
+    if (exp10 < -4 || exp10 >= SIGNIFICANT_DIGITS) {
+        // Scientific notation: d.ddde+XX
+        *p++ = digits[0];
+        if (nDigits > 1) {
+            *p++ = '.';
+            for (int i = 1; i < nDigits; i++) { *p++ = digits[i]; }
+        }
+        *p++ = 'e';
+        *p++ = exp10 < 0 ? '-' : '+';
+        int absExp = std::abs(exp10);
+        *p++ = static_cast<char>('0' + absExp / 10);
+        *p++ = static_cast<char>('0' + absExp % 10);
+    } else if (exp10 >= 0) {
+        for (int i = 0; i <= exp10; i++) { *p++ = digits[i]; }
+        if (nDigits > exp10 + 1) {
+            *p++ = '.';
+            for (int i = exp10 + 1; i < nDigits; i++) { *p++ = digits[i]; }
+        }
+    } else {
+        *p++ = '0';
+        *p++ = '.';
+        for (int i = -1; i > exp10; i--) { *p++ = '0'; }
+        for (int i = 0; i < nDigits; i++) { *p++ = digits[i]; }
+    }
+
+    *p = 0;
+    return static_cast<size_t>(p - buffer);
+}
+
+auto Util::parseDouble(const char* str, char** endptr) -> double {
+    const char* p = str;
+    while (g_ascii_isspace(*p)) { p++; }
+
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int mantissaDigits = 0;
+    int exp10 = 0;
+    bool anyDigit = false;
+
+    while (*p == '0') {
+        p++;
+        anyDigit = true;
+    }
+    for (; isDigit(*p); p++) {
+        if (mantissaDigits >= 19) {
+            return parseFallback(str, endptr);
+        }
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        mantissaDigits++;
+        anyDigit = true;
+    }
+
+    if (*p == '.') {
+        p++;
+        if (mantissa == 0) {
+            for (; *p == '0'; p++) {
+                exp10--;
+                anyDigit = true;
+            }
+        }
+        for (; isDigit(*p); p++) {
+            if (mantissaDigits >= 19) {
+                return parseFallback(str, endptr);
+            }
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            mantissaDigits++;
+            exp10--;
+            anyDigit = true;
+        }
+    }
+
+    if (!anyDigit) {
+        // Empty, or special values (inf, nan...)
+        return parseFallback(str, endptr);
+    }
+
+    if (*p == 'e' || *p == 'E') {
+        const char* e = p + 1;
+        bool negativeExp = false;
+        if (*e == '-' || *e == '+') {
+            negativeExp = *e == '-';
+            e++;
+        }
+        if (isDigit(*e)) {
+            int exp = 0;
+            for (; isDigit(*e); e++) {
+                if (exp > 10000) {
+                    return parseFallback(str, endptr);
+                }
+                exp = exp * 10 + (*e - '0');
+            }
+            exp10 += negativeExp ? -exp : exp;
+            p = e;
+        }
+    }
+
+    // Hexadecimal numbers, unusual endings etc. are left to the C library
+    if (g_ascii_isalnum(*p) || *p == '.') {
+        return parseFallback(str, endptr);
+    }
+
+    double value = 0.0;
+    if (mantissa != 0) {
+        if (mantissa > MAX_EXACT_INT || exp10 < -MAX_EXACT_POW10 || exp10 > MAX_EXACT_POW10) {
+            return parseFallback(str, endptr);
+        }
+        // Both operands are exact, so the result is correctly rounded, as the one of strtod
+        value = static_cast<double>(mantissa);
+        value = exp10 >= 0 ? value * POW10[exp10] : value / POW10[-exp10];
+    }
+
+    if (endptr) {
+        *endptr = const_cast<char*>(p);
+    }
+    return negative ? -value : value;
+}
@@ -1,5 +1,10 @@
 #include "util/GzUtil.h"
 
+#include <array>    // for array
+#include <cstring>  // for memset
+
+#include "util/safe_casts.h"  // for strict_cast
+
 auto GzUtil::openPath(const fs::path& path, const std::string& flags) -> gzFile {
 #ifdef _WIN32
     gzFile fp = gzopen_w(path.c_str(), flags.c_str());
@@ -9,3 +14,46 @@ auto GzUtil::openPath(const fs::path& path, const std::string& flags) -> gzFile
     return gzopen(path.c_str(), flags.c_str());
 #endif
 }
+
+auto GzUtil::compress(const char* data, size_t len) -> std::string {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    // 16 + the default window bits: write a gzip header and trailer
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+
+    std::string member(deflateBound(&stream, strict_cast<uLong>(len)), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = strict_cast<uInt>(len);
+    stream.next_out = reinterpret_cast<Bytef*>(member.data());
+    stream.avail_out = strict_cast<uInt>(member.size());
+
+    int result = deflate(&stream, Z_FINISH);
+    member.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END ? member : std::string();
+}
+
+auto GzUtil::decompress(const char* data, size_t len) -> std::string {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        return {};
+    }
+
+    std::string res;
+    std::array<char, 16384> buffer{};
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = strict_cast<uInt>(len);
+
+    int result = Z_OK;
+    while (result == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+        stream.avail_out = strict_cast<uInt>(buffer.size());
+        result = inflate(&stream, Z_NO_FLUSH);
+        res.append(buffer.data(), buffer.size() - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    return result == Z_STREAM_END ? res : std::string();
+}
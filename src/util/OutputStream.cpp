@@ -21,8 +21,9 @@ void OutputStream::write(const char* str) { write(str, std::strlen(str)); }
 /// GzOutputStream /////////////////////////////////////
 ////////////////////////////////////////////////////////
 
-GzOutputStream::GzOutputStream(fs::path file): file(std::move(file)) {
-    this->fp = GzUtil::openPath(this->file, "w");
+GzOutputStream::GzOutputStream(fs::path file, bool compress): file(std::move(file)) {
+    // "T": transparent write, without compression
+    this->fp = GzUtil::openPath(this->file, compress ? "w" : "wT");
     if (this->fp == nullptr) {
         this->error = FS(_F("Error opening file: \"{1}\"") % this->file.u8string());
         this->error = this->error + "\n" + std::strerror(errno);
@@ -74,3 +75,52 @@ void GzOutputStream::close() {
         }
     }
 }
+
+////////////////////////////////////////////////////////
+/// GzMemberOutputStream ///////////////////////////////
+////////////////////////////////////////////////////////
+
+GzMemberOutputStream::GzMemberOutputStream(fs::path file): out(std::move(file), false) {}
+
+void GzMemberOutputStream::write(const char* data, size_t len) { this->pending.append(data, len); }
+
+void GzMemberOutputStream::writeMember(const std::string& member) {
+    flush();
+    if (!member.empty()) {
+        this->out.write(member.data(), member.size());
+    }
+}
+
+void GzMemberOutputStream::flush() {
+    if (this->pending.empty()) {
+        return;
+    }
+    std::string member = GzUtil::compress(this->pending.data(), this->pending.size());
+    if (member.empty()) {
+        this->error = _("Error compressing data");
+    } else {
+        this->out.write(member.data(), member.size());
+    }
+    this->pending.clear();
+}
+
+void GzMemberOutputStream::close() {
+    flush();
+    this->out.close();
+}
+
+auto GzMemberOutputStream::getLastError() const -> const std::string& {
+    return this->error.empty() ? this->out.getLastError() : this->error;
+}
+
+////////////////////////////////////////////////////////
+/// StringOutputStream /////////////////////////////////
+////////////////////////////////////////////////////////
+
+void StringOutputStream::write(const char* data, size_t len) { this->str.append(data, len); }
+
+void StringOutputStream::close() {}
+
+auto StringOutputStream::getString() const -> const std::string& { return this->str; }
+
+void StringOutputStream::clear() { this->str.clear(); }
@@ -9,6 +9,7 @@
 #include <gdk/gdk.h>  // for gdk_cairo_set_source_rgba, gdk_t...
 
 #include "util/Color.h"              // for argb_to_GdkRGBA, rgb_to_GdkRGBA
+#include "util/FloatCodec.h"         // for formatDouble, FORMAT_DOUBLE_BUF_SIZE
 #include "util/OutputStream.h"       // for OutputStream
 #include "util/PlaceholderString.h"  // for PlaceholderString
 #include "util/XojMsgBox.h"          // for XojMsgBox
@@ -63,12 +64,11 @@ void Util::cairo_set_dash_from_vector(cairo_t* cr, const std::vector<double>& da
 }
 
 void Util::writeCoordinateString(OutputStream* out, double xVal, double yVal) {
-    std::array<char, G_ASCII_DTOSTR_BUF_SIZE> coordString{};
-    g_ascii_formatd(coordString.data(), G_ASCII_DTOSTR_BUF_SIZE, Util::PRECISION_FORMAT_STRING, xVal);
-    out->write(coordString.data());
-    out->write(" ");
-    g_ascii_formatd(coordString.data(), G_ASCII_DTOSTR_BUF_SIZE, Util::PRECISION_FORMAT_STRING, yVal);
-    out->write(coordString.data());
+    std::array<char, 2 * FORMAT_DOUBLE_BUF_SIZE> coordString{};
+    size_t len = formatDouble(coordString.data(), xVal);
+    coordString[len++] = ' ';
+    len += formatDouble(coordString.data() + len, yVal);
+    out->write(coordString.data(), len);
 }
 
 void Util::systemWithMessage(const char* command) {
@@ -0,0 +1,40 @@
+/*
+ * Xournal++
+ *
+ * Fast, locale independent conversions between doubles and text
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>  // for size_t
+
+#include <glib.h>  // for G_ASCII_DTOSTR_BUF_SIZE
+
+namespace Util {
+
+/**
+ * Minimal size of the buffers given to formatDouble()
+ */
+constexpr size_t FORMAT_DOUBLE_BUF_SIZE = G_ASCII_DTOSTR_BUF_SIZE;
+
+/**
+ * Format a double exactly like g_ascii_formatd(buffer, size, PRECISION_FORMAT_STRING, value) does, but much faster
+ * for the values found in documents (coordinates, widths, pressures).
+ *
+ * @param buffer Must hold at least FORMAT_DOUBLE_BUF_SIZE chars. The result is null terminated.
+ * @return The length of the result
+ */
+size_t formatDouble(char* buffer, double value);
+
+/**
+ * Parse a double exactly like g_ascii_strtod() does (same result, same end pointer), but much faster for the usual
+ * decimal numbers.
+ */
+double parseDouble(const char* str, char** endptr);
+
+}  // namespace Util
@@ -11,7 +11,8 @@
 
 #pragma once
 
-#include <string>  // for string
+#include <cstddef>  // for size_t
+#include <string>   // for string
 
 #include <zlib.h>  // for gzFile
 
@@ -24,4 +25,15 @@ private:
 
 public:
     static gzFile openPath(const fs::path& path, const std::string& flags);
+
+    /**
+     * Compress the data into a complete gzip member. Concatenated members are read by gzread() as one stream.
+     * Returns an empty string on error.
+     */
+    static std::string compress(const char* data, size_t len);
+
+    /**
+     * Decompress a complete gzip member, as written by compress(). Returns an empty string on error.
+     */
+    static std::string decompress(const char* data, size_t len);
 };
@@ -0,0 +1,122 @@
+/*
+ * Xournal++
+ *
+ * LRU cache bounded by memory
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <iterator>  // for prev
+#include <limits>    // for numeric_limits
+#include <list>      // for list
+#include <map>       // for map
+#include <mutex>     // for mutex, lock_guard
+#include <utility>   // for move, pair
+
+namespace xoj::util {
+
+/**
+ * Values computed for several owners at several levels (e.g. the levels of a mipmap pyramid), sharing a memory
+ * budget: the least recently used values are dropped first. Thread safe.
+ *
+ * @tparam Value A nullable handle (e.g. a shared pointer), returned empty when the value is not cached
+ * @tparam SizeOf Function object returning the memory (in bytes) used by a value
+ */
+template <class Owner, class Value, class SizeOf>
+class LruCache {
+public:
+    explicit LruCache(size_t memoryBudget): memoryBudget(memoryBudget) {}
+
+    Value get(const Owner* owner, int level) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->index.find({owner, level});
+        if (it == this->index.end()) {
+            return {};
+        }
+        this->entries.splice(this->entries.begin(), this->entries, it->second);
+        return it->second->value;
+    }
+
+    /// Returns the cached level of the owner closest to (and lower than) the given level, or -1 and an empty value
+    std::pair<int, Value> getClosestLower(const Owner* owner, int level) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->index.lower_bound({owner, level});
+        if (it == this->index.begin() || std::prev(it)->first.first != owner) {
+            return {-1, {}};
+        }
+        --it;
+        return {it->first.second, it->second->value};
+    }
+
+    void put(const Owner* owner, int level, Value value) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        eraseEntry(this->index.find({owner, level}));
+
+        size_t bytes = SizeOf()(value);
+        this->entries.push_front({owner, level, std::move(value), bytes});
+        this->index[{owner, level}] = this->entries.begin();
+        this->memoryUsed += bytes;
+        evict();
+    }
+
+    /// Drops all the levels of the owner
+    void remove(const Owner* owner) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->index.lower_bound({owner, std::numeric_limits<int>::min()});
+        while (it != this->index.end() && it->first.first == owner) {
+            eraseEntry(it++);
+        }
+    }
+
+    void setMemoryBudget(size_t bytes) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->memoryBudget = bytes;
+        evict();
+    }
+
+    size_t getMemoryBudget() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->memoryBudget;
+    }
+
+private:
+    struct Entry {
+        const Owner* owner;
+        int level;
+        Value value;
+        size_t bytes;
+    };
+    using Key = std::pair<const Owner*, int>;
+    using Index = std::map<Key, typename std::list<Entry>::iterator>;
+
+    void eraseEntry(typename Index::iterator it) {
+        if (it == this->index.end()) {
+            return;
+        }
+        this->memoryUsed -= it->second->bytes;
+        this->entries.erase(it->second);
+        this->index.erase(it);
+    }
+
+    /// Drops the least recently used values, keeping at least the most recent one (which is about to be drawn)
+    void evict() {
+        while (this->memoryUsed > this->memoryBudget && this->entries.size() > 1) {
+            const Entry& last = this->entries.back();
+            eraseEntry(this->index.find({last.owner, last.level}));
+        }
+    }
+
+    std::mutex mutex;
+    std::list<Entry> entries;  ///< From the most to the least recently used
+    Index index;
+    size_t memoryUsed = 0;
+    size_t memoryBudget;
+};
+
+}  // namespace xoj::util
@@ -32,7 +32,10 @@ public:
 
 class GzOutputStream: public OutputStream {
 public:
-    GzOutputStream(fs::path file);
+    /**
+     * @param compress If false, the data is written as is (e.g. already compressed gzip members)
+     */
+    GzOutputStream(fs::path file, bool compress = true);
     ~GzOutputStream() override;
 
 public:
@@ -48,3 +51,42 @@ private:
     std::string error;
     fs::path file;
 };
+
+/**
+ * Writes a gzip file made of several members, which gzip readers decompress as a single stream.
+ * The written data is compressed into a new member on flush() or close(); members compressed beforehand (see
+ * GzUtil::compress()) can be inserted in between with writeMember().
+ */
+class GzMemberOutputStream: public OutputStream {
+public:
+    GzMemberOutputStream(fs::path file);
+
+public:
+    void write(const char* data, size_t len) override;
+    void writeMember(const std::string& member);
+    void flush();
+
+    void close() override;
+
+    const std::string& getLastError() const;
+
+private:
+    GzOutputStream out;
+    std::string pending;
+    std::string error;
+};
+
+/**
+ * Keeps the written data in memory
+ */
+class StringOutputStream: public OutputStream {
+public:
+    void write(const char* data, size_t len) override;
+    void close() override;
+
+    const std::string& getString() const;
+    void clear();
+
+private:
+    std::string str;
+};
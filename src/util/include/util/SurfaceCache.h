@@ -0,0 +1,36 @@
+/*
+ * Xournal++
+ *
+ * LRU cache of image surfaces bounded by memory
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstddef>  // for size_t
+
+#include <cairo.h>  // for cairo_image_surface_get_stride
+
+#include "util/LruCache.h"            // for LruCache
+#include "util/raii/CairoWrappers.h"  // for CairoSurfaceSPtr
+
+namespace xoj::util {
+
+struct SurfaceSize {
+    size_t operator()(const CairoSurfaceSPtr& surface) const {
+        return static_cast<size_t>(cairo_image_surface_get_stride(surface.get())) *
+               static_cast<size_t>(cairo_image_surface_get_height(surface.get()));
+    }
+};
+
+/**
+ * Surfaces rendered for several owners at several levels (e.g. the levels of a mipmap pyramid)
+ */
+template <class Owner>
+using SurfaceCache = LruCache<Owner, CairoSurfaceSPtr, SurfaceSize>;
+
+}  // namespace xoj::util
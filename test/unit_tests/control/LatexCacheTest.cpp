@@ -0,0 +1,46 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "control/latex/LatexCache.h"
+
+TEST(LatexCache, testKeys) {
+    const std::string key = LatexCache::computeKey("pdflatex '{}'", "x^2");
+    EXPECT_EQ(key, LatexCache::computeKey("pdflatex '{}'", "x^2"));
+    EXPECT_NE(key, LatexCache::computeKey("pdflatex '{}'", "x^3"));
+    EXPECT_NE(key, LatexCache::computeKey("lualatex '{}'", "x^2"));
+    EXPECT_NE(LatexCache::computeKey("ab", "c"), LatexCache::computeKey("a", "bc"));
+}
+
+TEST(LatexCache, testLeastRecentlyUsedDropped) {
+    LatexCache cache(10);
+    EXPECT_FALSE(cache.get("a"));
+
+    cache.put("a", {"1234", "ok"});
+    cache.put("b", {"1234", "ok"});
+    ASSERT_TRUE(cache.get("a"));
+    EXPECT_EQ("1234", cache.get("a")->pdf);
+    EXPECT_EQ("ok", cache.get("a")->output);
+
+    // "b" is the least recently used one
+    cache.put("c", {"1234", "ok"});
+    EXPECT_TRUE(cache.get("a"));
+    EXPECT_FALSE(cache.get("b"));
+    EXPECT_TRUE(cache.get("c"));
+
+    // The last result is kept, whatever its size
+    cache.put("d", {std::string(100, 'x'), ""});
+    EXPECT_TRUE(cache.get("d"));
+    EXPECT_FALSE(cache.get("a"));
+}
@@ -10,18 +10,28 @@
  */
 
 #include <cmath>
+#include <deque>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <config-test.h>
 #include <gtest/gtest.h>
+#include <zip.h>
 
 #include "control/xojfile/LoadHandler.h"
 #include "control/xojfile/SaveHandler.h"
 #include "model/Image.h"
+#include "model/Layer.h"
 #include "model/Stroke.h"
 #include "model/Text.h"
 #include "model/XojPage.h"
+#include "util/GzUtil.h"
+#include "util/OutputStream.h"
 #include "util/PathUtil.h"
 
 #include "filesystem.h"
@@ -449,7 +459,7 @@ TEST(ControlLoadHandler, testStrokeWidthRecovery) {
 
     Stroke* s1 = (Stroke*)layer->getElements()[0];
     EXPECT_EQ(ELEMENT_STROKE, s1->getType());
-    for (auto& p: s1->getPointVector()) {
+    for (const auto& p: s1->getPointVector()) {
         EXPECT_EQ(p.z, Point::NO_PRESSURE);
     }
 
@@ -516,3 +526,232 @@ TEST(ControlLoadHandler, testLoadStoreCJK) {
     check_element(1, u8"测试");
     check_element(2, u8"テスト");
 }
+
+TEST(ControlLoadHandler, testLoadManyPagesZipped) {
+    // The pages of .xopp files are parsed in parallel: check the elements end up on the right pages, in order
+    constexpr size_t PAGES = 40;
+
+    DocumentHandler dh;
+    Document doc(&dh);
+    for (size_t p = 0; p < PAGES; p++) {
+        auto page = std::make_shared<XojPage>(500.0 + static_cast<double>(p), 800.0);
+        if (p % 3 == 0) {
+            page->addLayer(new Layer());
+        }
+        for (Layer* layer: *page->getLayers()) {
+            for (size_t s = 0; s <= p % 5; s++) {
+                auto* stroke = new Stroke();
+                stroke->setWidth(1.5);
+                stroke->addPoint(Point(static_cast<double>(p), static_cast<double>(s)));
+                stroke->addPoint(Point(static_cast<double>(p) + 10, static_cast<double>(s) + 10));
+                layer->addElement(stroke);
+            }
+        }
+        doc.addPage(page);
+    }
+
+    SaveHandler h;
+    h.prepareSave(&doc);
+    auto tmp = Util::getTmpDirSubfolder() / "many-pages.xopp";
+    h.saveTo(tmp);
+    ASSERT_TRUE(h.getErrorMessage().empty());
+
+    LoadHandler handler;
+    Document* loaded = handler.loadDocument(tmp);
+    ASSERT_NE(loaded, nullptr);
+    ASSERT_EQ(PAGES, loaded->getPageCount());
+
+    for (size_t p = 0; p < PAGES; p++) {
+        PageRef page = loaded->getPage(p);
+        EXPECT_DOUBLE_EQ(500.0 + static_cast<double>(p), page->getWidth());
+        ASSERT_EQ(p % 3 == 0 ? 2U : 1U, page->getLayerCount());
+        for (Layer* layer: *page->getLayers()) {
+            const auto& elements = layer->getElements();
+            ASSERT_EQ(p % 5 + 1, elements.size());
+            for (size_t s = 0; s < elements.size(); s++) {
+                auto* stroke = dynamic_cast<Stroke*>(elements[s]);
+                ASSERT_NE(stroke, nullptr);
+                ASSERT_EQ(2, stroke->getPointCount());
+                EXPECT_DOUBLE_EQ(static_cast<double>(p), stroke->getPoint(0).x);
+                EXPECT_DOUBLE_EQ(static_cast<double>(s), stroke->getPoint(0).y);
+            }
+        }
+    }
+}
+
+TEST(ControlLoadHandler, testLazyLoading) {
+    DocumentHandler dh;
+    Document doc(&dh);
+    for (size_t p = 0; p < 5; p++) {
+        auto page = std::make_shared<XojPage>(500.0, 800.0 + static_cast<double>(p));
+        auto* stroke = new Stroke();
+        stroke->addPoint(Point(static_cast<double>(p), 1));
+        stroke->addPoint(Point(static_cast<double>(p), 2));
+        page->getSelectedLayer()->addElement(stroke);
+        page->getSelectedLayer()->addElement(new Text());
+        doc.addPage(page);
+    }
+
+    SaveHandler h;
+    h.prepareSave(&doc);
+    auto tmp = Util::getTmpDirSubfolder() / "lazy.xopp";
+    h.saveTo(tmp);
+    ASSERT_TRUE(h.getErrorMessage().empty());
+
+    LoadHandler handler;
+    handler.setLazyLoading(true);
+    Document* loaded = handler.loadDocument(tmp);
+    ASSERT_NE(loaded, nullptr);
+    ASSERT_EQ(5U, loaded->getPageCount());
+
+    // The sizes are known without loading the layers
+    for (size_t p = 0; p < 5; p++) {
+        EXPECT_FALSE(loaded->getPage(p)->isLoaded());
+        EXPECT_DOUBLE_EQ(800.0 + static_cast<double>(p), loaded->getPage(p)->getHeight());
+    }
+
+    PageRef page = loaded->getPage(3);
+    ASSERT_EQ(1U, page->getLayerCount());
+    EXPECT_TRUE(page->isLoaded());
+    EXPECT_FALSE(loaded->getPage(2)->isLoaded());
+
+    const auto& elements = (*page->getLayers())[0]->getElements();
+    ASSERT_EQ(2U, elements.size());
+    ASSERT_EQ(ELEMENT_STROKE, elements[0]->getType());
+    EXPECT_DOUBLE_EQ(3.0, dynamic_cast<Stroke*>(elements[0])->getPoint(0).x);
+    EXPECT_EQ(ELEMENT_TEXT, elements[1]->getType());
+
+    // Saving copies the layers of the remaining pages without loading them
+    auto saved = Util::getTmpDirSubfolder() / "lazy-saved.xopp";
+    h.prepareSave(loaded);
+    h.saveTo(saved);
+    ASSERT_TRUE(h.getErrorMessage().empty());
+    for (size_t p = 0; p < 5; p++) { EXPECT_EQ(p == 3, loaded->getPage(p)->isLoaded()); }
+
+    LoadHandler reloadHandler;
+    Document* reloaded = reloadHandler.loadDocument(saved);
+    ASSERT_NE(reloaded, nullptr);
+    ASSERT_EQ(5U, reloaded->getPageCount());
+    for (size_t p = 0; p < 5; p++) {
+        PageRef page = reloaded->getPage(p);
+        ASSERT_EQ(1U, page->getLayerCount());
+        const auto& elements = (*page->getLayers())[0]->getElements();
+        ASSERT_EQ(2U, elements.size());
+        ASSERT_EQ(ELEMENT_STROKE, elements[0]->getType());
+        EXPECT_DOUBLE_EQ(static_cast<double>(p), dynamic_cast<Stroke*>(elements[0])->getPoint(0).x);
+        EXPECT_EQ(ELEMENT_TEXT, elements[1]->getType());
+    }
+}
+
+TEST(ControlLoadHandler, testLazyLoadingBrokenPage) {
+    auto layerWithStroke = [](const std::string& width) {
+        return "<layer>\n<stroke tool=\"pen\" color=\"#000000ff\" width=\"" + width + "\">1 2 3 4</stroke>\n</layer>";
+    };
+    // The width of the stroke cannot be read
+    const std::string brokenLayer = layerWithStroke("abc");
+    std::string content = "<?xml version=\"1.0\" standalone=\"no\"?>\n<xournal creator=\"test\" fileversion=\"4\">\n";
+    for (int p = 0; p < 3; p++) {
+        content += "<page width=\"500\" height=\"800\">\n<background type=\"solid\" color=\"#ffffffff\" "
+                   "style=\"plain\"/>\n";
+        content += p == 1 ? brokenLayer : layerWithStroke("1");
+        content += "\n</page>\n";
+    }
+    content += "</xournal>\n";
+
+    auto tmp = Util::getTmpDirSubfolder() / "lazy-broken.xopp";
+    {
+        GzOutputStream out(tmp);
+        out.write(content.data(), content.size());
+        out.close();
+    }
+
+    std::vector<std::string> errors;
+    LoadHandler handler;
+    handler.setLazyLoading(true, [&errors](const std::string& message) { errors.push_back(message); });
+    Document* loaded = handler.loadDocument(tmp);
+    ASSERT_NE(loaded, nullptr);
+    ASSERT_EQ(3U, loaded->getPageCount());
+
+    PageRef page = loaded->getPage(1);
+    EXPECT_GE(page->getLayerCount(), 1U);
+    EXPECT_TRUE(page->isLoaded());
+    EXPECT_EQ(1U, errors.size());
+
+    // The broken page is saved as it is in the file, not with what could be parsed
+    auto saved = Util::getTmpDirSubfolder() / "lazy-broken-saved.xopp";
+    SaveHandler h;
+    h.prepareSave(loaded);
+    h.saveTo(saved);
+    ASSERT_TRUE(h.getErrorMessage().empty());
+
+    std::ifstream savedFile(saved, std::ios::binary);
+    const std::string compressed{std::istreambuf_iterator<char>(savedFile), std::istreambuf_iterator<char>()};
+    const std::string savedContent = GzUtil::decompress(compressed.data(), compressed.size());
+    EXPECT_NE(std::string::npos, savedContent.find(brokenLayer));
+}
+
+TEST(ControlLoadHandler, testLazyLoadingZipAttachments) {
+    std::ifstream imageFile(GET_TESTFILE("images/r90.jpg"), std::ios::binary);
+    const std::string image{std::istreambuf_iterator<char>(imageFile), std::istreambuf_iterator<char>()};
+    ASSERT_FALSE(image.empty());
+
+    std::string content = "<?xml version=\"1.0\" standalone=\"no\"?>\n<xournal creator=\"test\" fileversion=\"4\">\n";
+    for (int p = 0; p < 3; p++) {
+        content += "<page width=\"500\" height=\"800\">\n<background type=\"solid\" color=\"#ffffffff\" "
+                   "style=\"plain\"/>\n<layer>\n<image left=\"0\" top=\"0\" right=\"10\" bottom=\"10\">\n"
+                   "<attachment path=\"attachments/image.jpg\"/>\n</image>\n</layer>\n</page>\n";
+    }
+    content += "</xournal>\n";
+
+    auto tmp = Util::getTmpDirSubfolder() / "lazy-zip.xopp";
+    {
+        std::deque<std::string> entries;
+        zip_t* zip = zip_open(tmp.u8string().c_str(), ZIP_CREATE | ZIP_TRUNCATE, nullptr);
+        ASSERT_NE(zip, nullptr);
+        auto add = [&](const char* name, std::string data) {
+            const std::string& entry = entries.emplace_back(std::move(data));
+            zip_source_t* source = zip_source_buffer(zip, entry.data(), entry.size(), 0);
+            ASSERT_GE(zip_file_add(zip, name, source, ZIP_FL_OVERWRITE), 0);
+        };
+        add("mimetype", "application/xournal++\n");
+        add("META-INF/version", "current=4\nmin=4\n");
+        add("content.xml", content);
+        add("attachments/image.jpg", image);
+        ASSERT_EQ(0, zip_close(zip));
+    }
+
+    LoadHandler handler;
+    handler.setLazyLoading(true);
+    Document* loaded = handler.loadDocument(tmp);
+    ASSERT_NE(loaded, nullptr);
+    ASSERT_EQ(3U, loaded->getPageCount());
+
+    // The attachments have been read: the archive is not needed anymore
+    fs::remove(tmp);
+
+    auto imageOf = [](const PageRef& page) -> Image* {
+        const auto& elements = (*page->getLayers())[0]->getElements();
+        return elements.size() == 1 ? dynamic_cast<Image*>(elements[0]) : nullptr;
+    };
+    Image* img = imageOf(loaded->getPage(1));
+    ASSERT_NE(img, nullptr);
+    EXPECT_EQ(image, std::string(reinterpret_cast<const char*>(img->getRawData()), img->getRawDataLength()));
+
+    // The unloaded pages are saved with their attachments
+    SaveHandler h;
+    h.prepareSave(loaded);
+    h.saveTo(tmp);
+    ASSERT_TRUE(h.getErrorMessage().empty());
+    EXPECT_FALSE(loaded->getPage(0)->isLoaded());
+    EXPECT_FALSE(loaded->getPage(2)->isLoaded());
+
+    LoadHandler reloadHandler;
+    Document* reloaded = reloadHandler.loadDocument(tmp);
+    ASSERT_NE(reloaded, nullptr);
+    ASSERT_EQ(3U, reloaded->getPageCount());
+    for (size_t p = 0; p < 3; p++) {
+        img = imageOf(reloaded->getPage(p));
+        ASSERT_NE(img, nullptr);
+        EXPECT_EQ(image, std::string(reinterpret_cast<const char*>(img->getRawData()), img->getRawDataLength()));
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "control/xojfile/LoadHandler.h"
+#include "control/xojfile/SaveCache.h"
+#include "control/xojfile/SaveHandler.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Layer.h"
+#include "model/Point.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "util/PathUtil.h"
+
+#include "filesystem.h"
+
+static void addStroke(const PageRef& page, double x) {
+    auto* stroke = new Stroke();
+    stroke->addPoint(Point(x, 1));
+    stroke->addPoint(Point(x, 2));
+    page->getSelectedLayer()->addElement(stroke);
+}
+
+static void save(Document& doc, const fs::path& file, SaveCache* cache) {
+    SaveHandler h;
+    h.prepareSave(&doc);
+    h.setCache(cache);
+    h.saveTo(file);
+    ASSERT_TRUE(h.getErrorMessage().empty());
+}
+
+static void expectStrokeCounts(const fs::path& file, const std::vector<size_t>& counts) {
+    LoadHandler handler;
+    Document* loaded = handler.loadDocument(file);
+    ASSERT_NE(nullptr, loaded);
+    ASSERT_EQ(counts.size(), loaded->getPageCount());
+    for (size_t p = 0; p < counts.size(); p++) {
+        EXPECT_EQ(counts[p], loaded->getPage(p)->getSelectedLayer()->getElements().size());
+    }
+}
+
+TEST(SaveCache, testOnlyChangedPagesAreCompressed) {
+    DocumentHandler dh;
+    Document doc(&dh);
+    for (size_t p = 0; p < 3; p++) {
+        auto page = std::make_shared<XojPage>(500.0, 800.0);
+        addStroke(page, static_cast<double>(p));
+        doc.addPage(page);
+    }
+
+    SaveCache cache;
+    auto file = Util::getTmpDirSubfolder() / "incremental.xopp";
+    save(doc, file, &cache);
+    EXPECT_EQ(3U, cache.getCompressedPageCount());
+    expectStrokeCounts(file, {1, 1, 1});
+
+    save(doc, file, &cache);
+    EXPECT_EQ(3U, cache.getCompressedPageCount());
+    expectStrokeCounts(file, {1, 1, 1});
+
+    // Changes are detected even without any change event
+    addStroke(doc.getPage(1), 10);
+    save(doc, file, &cache);
+    EXPECT_EQ(4U, cache.getCompressedPageCount());
+    expectStrokeCounts(file, {1, 2, 1});
+
+    // A moved page is written at its new position
+    doc.insertPage(doc.getPage(1), 0);
+    doc.deletePage(2);
+    save(doc, file, &cache);
+    expectStrokeCounts(file, {2, 1, 1});
+
+    // The compact save does not need the cache
+    auto compactFile = Util::getTmpDirSubfolder() / "compact.xopp";
+    save(doc, compactFile, nullptr);
+    expectStrokeCounts(compactFile, {2, 1, 1});
+}
@@ -0,0 +1,300 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <config-test.h>
+#include <gtest/gtest.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "control/xml/XmlStreamWriter.h"
+#include "control/xojfile/LoadHandler.h"
+#include "control/xojfile/SaveHandler.h"
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/Image.h"
+#include "model/Layer.h"
+#include "model/Point.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "util/OutputStream.h"
+#include "util/PathUtil.h"
+#include "xml/XmlNode.h"
+#include "xml/XmlPointNode.h"
+#include "xml/XmlTextNode.h"
+
+#include "filesystem.h"
+
+TEST(SaveHandler, testStreamWriterMatchesXmlNode) {
+    std::vector<Point> points = {Point(1.5, 2.25, 0.5), Point(3.125, 4, 0.75), Point(1e-9, 123456789.123, -1)};
+
+    StringOutputStream domOut;
+    {
+        XmlNode root("root");
+        root.setAttrib("text", "a<b>&\"c\"\nd");
+        root.setAttrib("int", 42);
+        root.setAttrib("size", size_t(7));
+        root.setAttrib("double", 0.1);
+
+        root.addChild(new XmlNode("empty"));
+        root.addChild(new XmlTextNode("title", "x < y & \"z\"\n"));
+
+        auto* stroke = new XmlPointNode("stroke");
+        stroke->setAttrib("width", std::vector<double>{1.4, 0.5, 0.75});
+        stroke->setPoints(points);
+        root.addChild(stroke);
+
+        root.writeOut(&domOut, nullptr);
+    }
+
+    StringOutputStream streamOut;
+    {
+        XmlStreamWriter writer(&streamOut);
+        writer.startElement("root");
+        writer.setAttrib("text", "a<b>&\"c\"\nd");
+        writer.setAttrib("int", 42);
+        writer.setAttrib("size", size_t(7));
+        writer.setAttrib("double", 0.1);
+
+        writer.startElement("empty");
+        writer.endElement();
+
+        writer.startElement("title");
+        writer.writeText("x < y & \"z\"\n");
+        writer.endElement();
+
+        writer.startElement("stroke");
+        writer.setDoubleListAttrib("width", points.size(), [&](size_t i) { return i == 0 ? 1.4 : points[i - 1].z; });
+        writer.writePoints(points);
+        writer.endElement();
+
+        writer.endElement();
+    }
+
+    EXPECT_EQ(domOut.getString(), streamOut.getString());
+}
+
+TEST(SaveHandler, testStreamingBase64MatchesGlib) {
+    std::string data;
+    for (size_t length: {0U, 1U, 2U, 3U, 4U, 3071U, 3072U, 3073U, 100000U}) {
+        data.resize(length);
+        for (size_t i = 0; i < length; i++) { data[i] = static_cast<char>((i * 7919) % 251); }
+
+        StringOutputStream out;
+        {
+            XmlStreamWriter writer(&out);
+            writer.startElement("data");
+            writer.writeBase64(data.data(), data.size());
+            writer.endElement();
+        }
+
+        gchar* expected = g_base64_encode(reinterpret_cast<const guchar*>(data.data()), data.size());
+        std::string expectedXml = std::string("<data>") + expected + "</data>\n";
+        g_free(expected);
+        EXPECT_EQ(expectedXml, out.getString()) << "length " << length;
+    }
+}
+
+TEST(SaveHandler, testImagesKeepTheirOriginalData) {
+    std::ifstream imageFile{GET_TESTFILE("images/r90.jpg"), std::ios::binary};
+    std::string jpeg(std::istreambuf_iterator<char>(imageFile), {});
+    ASSERT_FALSE(jpeg.empty());
+
+    DocumentHandler dh;
+    Document doc(&dh);
+    auto page = std::make_shared<XojPage>(500.0, 800.0);
+    auto* image = new Image();
+    image->setImage(std::string(jpeg));
+    image->setWidth(65);
+    image->setHeight(250);
+    page->getSelectedLayer()->addElement(image);
+    doc.addPage(page);
+
+    SaveHandler h;
+    h.prepareSave(&doc);
+    auto tmp = Util::getTmpDirSubfolder() / "image.xopp";
+    h.saveTo(tmp);
+    ASSERT_TRUE(h.getErrorMessage().empty());
+
+    LoadHandler handler;
+    Document* loaded = handler.loadDocument(tmp);
+    ASSERT_NE(nullptr, loaded);
+    const auto& elements = loaded->getPage(0)->getSelectedLayer()->getElements();
+    ASSERT_EQ(1U, elements.size());
+    auto* loadedImage = dynamic_cast<Image*>(elements[0]);
+    ASSERT_NE(nullptr, loadedImage);
+    // Written as is, not re-encoded to PNG
+    EXPECT_EQ(jpeg, std::string(reinterpret_cast<const char*>(loadedImage->getRawData()),
+                                loadedImage->getRawDataLength()));
+}
+
+TEST(SaveHandler, testSavesSnapshotOfThePageList) {
+    DocumentHandler dh;
+    Document doc(&dh);
+    for (size_t p = 0; p < 3; p++) {
+        auto page = std::make_shared<XojPage>(500.0 + static_cast<double>(p), 800.0);
+        auto* stroke = new Stroke();
+        stroke->addPoint(Point(static_cast<double>(p), 1));
+        stroke->addPoint(Point(static_cast<double>(p), 2));
+        page->getSelectedLayer()->addElement(stroke);
+        doc.addPage(page);
+    }
+
+    SaveHandler h;
+    doc.lock();
+    h.prepareSave(&doc);
+    doc.unlock();
+
+    // Changes to the page list after the snapshot are not saved
+    doc.lock();
+    doc.deletePage(0);
+    doc.addPage(std::make_shared<XojPage>(100.0, 100.0));
+    doc.unlock();
+
+    auto tmp = Util::getTmpDirSubfolder() / "snapshot.xopp";
+    h.saveTo(tmp);
+    ASSERT_TRUE(h.getErrorMessage().empty());
+
+    LoadHandler handler;
+    Document* loaded = handler.loadDocument(tmp);
+    ASSERT_NE(nullptr, loaded);
+    ASSERT_EQ(3U, loaded->getPageCount());
+    for (size_t p = 0; p < 3; p++) {
+        EXPECT_DOUBLE_EQ(500.0 + static_cast<double>(p), loaded->getPage(p)->getWidth());
+        EXPECT_EQ(1U, loaded->getPage(p)->getSelectedLayer()->getElements().size());
+    }
+}
+
+TEST(SaveHandler, testSaveWithoutLocking) {
+    DocumentHandler dh;
+    Document doc(&dh);
+    doc.addPage(std::make_shared<XojPage>(500.0, 800.0));
+
+    // As in an emergency save: the document is locked by another thread, which will never release it
+    doc.lock();
+    SaveHandler h;
+    h.prepareSave(&doc, false);
+    h.saveTo(Util::getTmpDirSubfolder() / "unlocked.xopp");
+    EXPECT_TRUE(h.getErrorMessage().empty());
+    doc.unlock();
+}
+
+#ifndef _WIN32
+/**
+ * Peak resident set size of the process, in KiB
+ */
+static long getPeakRss() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+#endif
+
+/**
+ * Compare the wall time and peak memory of the streaming save with the former approach, which built an XmlNode tree
+ * (copying the points of every stroke) before writing it out.
+ *
+ * Disabled by default, run with
+ *      test-units --gtest_also_run_disabled_tests --gtest_filter='SaveHandler.DISABLED_benchmark*'
+ */
+TEST(SaveHandler, DISABLED_benchmarkStreamingVsDom) {
+    constexpr size_t PAGES = 300;
+    constexpr size_t STROKES_PER_PAGE = 200;
+    constexpr size_t POINTS_PER_STROKE = 200;
+
+    DocumentHandler dh;
+    Document doc(&dh);
+    for (size_t p = 0; p < PAGES; p++) {
+        auto page = std::make_shared<XojPage>(595.0, 842.0);
+        Layer* layer = page->getSelectedLayer();
+        for (size_t s = 0; s < STROKES_PER_PAGE; s++) {
+            auto* stroke = new Stroke();
+            stroke->setWidth(1.41);
+            for (size_t i = 0; i < POINTS_PER_STROKE; i++) {
+                stroke->addPoint(Point(0.37 * static_cast<double>(i + s), 0.53 * static_cast<double>(i + p), 0.8));
+            }
+            layer->addElement(stroke);
+        }
+        doc.addPage(page);
+    }
+
+    auto tmp = Util::getTmpDirSubfolder();
+    auto report = [](const std::string& name, std::chrono::steady_clock::duration time, long rssBefore,
+                         long rssAfter) {
+        RecordProperty(name + "Ms",
+                       static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(time).count()));
+        RecordProperty(name + "PeakRssKiB", static_cast<int>(rssAfter - rssBefore));
+    };
+
+    // Streaming first: the peak RSS only grows, so the DOM path measured afterwards is not hidden
+    long rssBefore = 0;
+#ifndef _WIN32
+    rssBefore = getPeakRss();
+#endif
+    auto start = std::chrono::steady_clock::now();
+    {
+        SaveHandler h;
+        h.prepareSave(&doc);
+        h.saveTo(tmp / "benchmark-stream.xopp");
+        EXPECT_TRUE(h.getErrorMessage().empty());
+    }
+    auto streamTime = std::chrono::steady_clock::now() - start;
+    long rssAfter = rssBefore;
+#ifndef _WIN32
+    rssAfter = getPeakRss();
+#endif
+    report("streaming", streamTime, rssBefore, rssAfter);
+
+    rssBefore = rssAfter;
+    start = std::chrono::steady_clock::now();
+    {
+        XmlNode root("xournal");
+        for (size_t p = 0; p < doc.getPageCount(); p++) {
+            auto* page = new XmlNode("page");
+            root.addChild(page);
+            for (Layer* l: *doc.getPage(p)->getLayers()) {
+                auto* layer = new XmlNode("layer");
+                page->addChild(layer);
+                for (Element* e: l->getElements()) {
+                    auto* s = dynamic_cast<Stroke*>(e);
+                    auto* stroke = new XmlPointNode("stroke");
+                    layer->addChild(stroke);
+                    const auto& pts = s->getPointVector();
+                    std::vector<double> values;
+                    values.reserve(pts.size());
+                    values.emplace_back(s->getWidth());
+                    for (auto it = pts.begin(); it != pts.end() - 1; ++it) { values.emplace_back(it->z); }
+                    stroke->setAttrib("width", std::move(values));
+                    stroke->setPoints(pts.toVector());
+                }
+            }
+        }
+
+        GzOutputStream out(tmp / "benchmark-dom.xopp");
+        // As SaveHandler::saveTo(), through the OutputStream interface
+        OutputStream* stream = &out;
+        stream->write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
+        root.writeOut(stream, nullptr);
+        out.close();
+    }
+    auto domTime = std::chrono::steady_clock::now() - start;
+#ifndef _WIN32
+    rssAfter = getPeakRss();
+#endif
+    report("dom", domTime, rssBefore, rssAfter);
+}
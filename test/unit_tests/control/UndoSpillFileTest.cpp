@@ -0,0 +1,83 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Layer.h"
+#include "model/Point.h"
+#include "model/Stroke.h"
+#include "undo/DeleteUndoAction.h"
+#include "undo/UndoSpillFile.h"
+#include "util/GzUtil.h"
+
+TEST(UndoSpillFile, testGzRoundTrip) {
+    std::string data;
+    for (int i = 0; i < 10000; i++) {
+        data += std::to_string(i);
+    }
+    std::string member = GzUtil::compress(data.data(), data.size());
+    ASSERT_FALSE(member.empty());
+    EXPECT_EQ(data, GzUtil::decompress(member.data(), member.size()));
+    EXPECT_TRUE(GzUtil::decompress(member.data(), member.size() / 2).empty());
+}
+
+TEST(UndoSpillFile, testSpillAndRestore) {
+    Layer layer;
+    std::vector<std::unique_ptr<Stroke>> strokes;
+    for (int n = 0; n < 3; n++) {
+        auto s = std::make_unique<Stroke>();
+        s->setWidth(1 + n);
+        s->setColor(Color(0xff0000U + static_cast<uint32_t>(n)));
+        for (int i = 0; i < 100; i++) {
+            s->addPoint(Point(i, n * i, n == 1 ? Point::NO_PRESSURE : 0.01 * i));
+        }
+        layer.addElement(s.get());
+        strokes.push_back(std::move(s));
+    }
+
+    DeleteUndoAction action(PageRef(), false);
+    std::vector<std::vector<Point>> expected;
+    for (auto& s: strokes) {
+        expected.push_back(s->getPointVector().toVector());
+        action.addElement(&layer, s.get(), layer.removeElement(s.get(), false));
+    }
+    ASSERT_EQ(3U, action.getDetachedElements().size());
+    size_t usage = action.getMemoryUsage();
+
+    UndoSpillFile file;
+    ASSERT_TRUE(file.spill(&action, action.getDetachedElements()));
+    EXPECT_TRUE(file.isSpilled(&action));
+    EXPECT_GT(file.getFileSize(), 0U);
+    for (auto& s: strokes) {
+        EXPECT_EQ(0, s->getPointCount());
+    }
+    EXPECT_LT(action.getMemoryUsage(), usage);
+
+    ASSERT_TRUE(file.restore(&action));
+    EXPECT_FALSE(file.isSpilled(&action));
+    EXPECT_EQ(0U, file.getFileSize());
+    for (size_t n = 0; n < strokes.size(); n++) {
+        EXPECT_EQ(static_cast<double>(n + 1), strokes[n]->getWidth());
+        EXPECT_EQ(Color(0xff0000U + static_cast<uint32_t>(n)), strokes[n]->getColor());
+        auto points = strokes[n]->getPointVector().toVector();
+        ASSERT_EQ(expected[n].size(), points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            EXPECT_EQ(expected[n][i].x, points[i].x);
+            EXPECT_EQ(expected[n][i].y, points[i].y);
+            EXPECT_EQ(expected[n][i].z, points[i].z);
+        }
+    }
+    EXPECT_EQ(usage, action.getMemoryUsage());
+}
@@ -0,0 +1,27 @@
+#include "DoubleArrayAttribute.h"
+
+#include <algorithm>  // for for_each
+#include <iterator>   // for begin, end
+#include <string>     // for allocator, string
+#include <utility>    // for move
+
+#include "util/FloatCodec.h"    // for formatDouble, FORMAT_DOUBLE_BUF_SIZE
+#include "util/OutputStream.h"  // for OutputStream
+
+DoubleArrayAttribute::DoubleArrayAttribute(const char* name, std::vector<double>&& values):
+        XMLAttribute(name), values(std::move(values)) {}
+
+DoubleArrayAttribute::~DoubleArrayAttribute() = default;
+
+void DoubleArrayAttribute::writeOut(OutputStream* out) {
+    if (!this->values.empty()) {
+        char str[Util::FORMAT_DOUBLE_BUF_SIZE + 1];
+        // formatDouble always uses the C locale
+        out->write(str, Util::formatDouble(str, this->values[0]));
+
+        std::for_each(std::begin(this->values) + 1, std::end(this->values), [&](auto& x) {
+            str[0] = ' ';
+            out->write(str, Util::formatDouble(str + 1, x) + 1);
+        });
+    }
+}
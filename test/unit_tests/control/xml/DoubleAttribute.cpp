@@ -0,0 +1,16 @@
+#include "DoubleAttribute.h"
+
+#include <string>  // for allocator, string
+
+#include "util/FloatCodec.h"    // for formatDouble, FORMAT_DOUBLE_BUF_SIZE
+#include "util/OutputStream.h"  // for OutputStream
+
+DoubleAttribute::DoubleAttribute(const char* name, double value): XMLAttribute(name) { this->value = value; }
+
+DoubleAttribute::~DoubleAttribute() = default;
+
+void DoubleAttribute::writeOut(OutputStream* out) {
+    char str[Util::FORMAT_DOUBLE_BUF_SIZE];
+    // formatDouble always uses the C locale
+    out->write(str, Util::formatDouble(str, value));
+}
@@ -4,8 +4,7 @@
 
 #include <glib.h>  // for g_free, g_strdup_printf
 
-#include "control/xml/Attribute.h"  // for XMLAttribute
-#include "util/OutputStream.h"      // for OutputStream
+#include "util/OutputStream.h"  // for OutputStream
 
 SizeTAttribute::SizeTAttribute(const char* name, size_t value): XMLAttribute(name) { this->value = value; }
 
@@ -2,9 +2,8 @@
 
 #include <utility>  // for move
 
-#include "control/xml/Attribute.h"  // for XMLAttribute
-#include "util/OutputStream.h"      // for OutputStream
-#include "util/StringUtils.h"       // for replace_pair, StringUtils
+#include "util/OutputStream.h"  // for OutputStream
+#include "util/StringUtils.h"   // for replace_pair, StringUtils
 
 TextAttribute::TextAttribute(std::string name, std::string value):
         XMLAttribute(std::move(name)), value(std::move(value)) {}
@@ -2,8 +2,6 @@
 
 #include <utility>  // for move
 
-#include "control/xml/XmlNode.h"  // for XmlNode
-
 XmlAudioNode::XmlAudioNode(const char* tag): XmlNode(tag), audioFilepath{} {}
 
 XmlAudioNode::~XmlAudioNode() = default;
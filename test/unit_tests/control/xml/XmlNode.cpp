@@ -5,7 +5,6 @@
 #include <glib.h>  // for g_free
 
 #include "control/jobs/ProgressListener.h"  // for ProgressListener
-#include "control/xml/Attribute.h"          // for XMLAttribute
 #include "util/OutputStream.h"              // for OutputStream
 
 #include "DoubleArrayAttribute.h"  // for DoubleArrayAttribute
@@ -1,7 +1,8 @@
 /*
  * Xournal++
  *
- * XML Writer helper class
+ * XML Writer helper class, which builds a tree before writing it out. SaveHandler now uses XmlStreamWriter: these
+ * classes are only kept as reference for its tests.
  *
  * @author Xournal++ Team
  * https://github.com/xournalpp/xournalpp
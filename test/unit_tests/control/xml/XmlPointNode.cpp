@@ -3,9 +3,8 @@
 #include <algorithm>  // for max
 #include <utility>    // for move
 
-#include "control/xml/XmlAudioNode.h"  // for XmlAudioNode
-#include "util/OutputStream.h"         // for OutputStream
-#include "util/Util.h"                 // for writeCoordinateString
+#include "util/OutputStream.h"  // for OutputStream
+#include "util/Util.h"          // for writeCoordinateString
 
 XmlPointNode::XmlPointNode(const char* tag): XmlAudioNode(tag) {}
 
@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <atomic>
+#include <chrono>
+#include <shared_mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+
+TEST(DocumentLock, testReadersShareTheLock) {
+    DocumentHandler dh;
+    Document doc(&dh);
+
+    std::shared_lock<Document> reader(doc);
+    std::thread([&]() {
+        EXPECT_TRUE(doc.try_lock_shared());
+        EXPECT_FALSE(doc.tryLock());
+        doc.unlock_shared();
+    }).join();
+    reader.unlock();
+
+    doc.lock();
+    std::thread([&]() { EXPECT_FALSE(doc.try_lock_shared()); }).join();
+    doc.unlock();
+}
+
+TEST(DocumentLock, testWaitingWriterGoesFirst) {
+    DocumentHandler dh;
+    Document doc(&dh);
+
+    doc.lock_shared();
+    std::atomic<bool> written = false;
+    std::thread writer([&]() {
+        doc.lock();
+        written = true;
+        doc.unlock();
+    });
+
+    // Once the writer waits, new readers are held back
+    bool readerHeldBack = false;
+    for (int i = 0; i < 1000 && !readerHeldBack; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::thread([&]() {
+            if (doc.try_lock_shared()) {
+                doc.unlock_shared();
+            } else {
+                readerHeldBack = true;
+            }
+        }).join();
+    }
+    EXPECT_TRUE(readerHeldBack);
+    EXPECT_FALSE(written);
+
+    doc.unlock_shared();
+    writer.join();
+    EXPECT_TRUE(written);
+}
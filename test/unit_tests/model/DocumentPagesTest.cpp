@@ -0,0 +1,79 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Document.h"
+#include "model/DocumentHandler.h"
+#include "model/XojPage.h"
+#include "util/Util.h"
+
+static std::vector<PageRef> makePages(size_t count) {
+    std::vector<PageRef> pages;
+    for (size_t i = 0; i < count; i++) {
+        pages.emplace_back(std::make_shared<XojPage>(100, 100));
+    }
+    return pages;
+}
+
+static void expectConsistentIndices(const Document& doc) {
+    for (size_t i = 0; i < doc.getPageCount(); i++) {
+        EXPECT_EQ(i, doc.indexOf(doc.getPage(i)));
+    }
+}
+
+TEST(DocumentPages, testIndexOf) {
+    DocumentHandler dh;
+    Document doc(&dh);
+
+    auto pages = makePages(3);
+    doc.addPage(pages[0]);
+    doc.addPage(pages[2]);
+    doc.insertPage(pages[1], 1);
+    expectConsistentIndices(doc);
+    EXPECT_EQ(1U, doc.indexOf(pages[1]));
+
+    doc.deletePage(0);
+    expectConsistentIndices(doc);
+    EXPECT_EQ(npos, doc.indexOf(pages[0]));
+    EXPECT_EQ(0U, doc.indexOf(pages[1]));
+    EXPECT_EQ(npos, doc.indexOf(nullptr));
+}
+
+TEST(DocumentPages, testBatchInsertAndDelete) {
+    DocumentHandler dh;
+    Document doc(&dh);
+
+    auto pages = makePages(4);
+    doc.addPages(pages.begin(), pages.end());
+
+    auto inserted = makePages(3);
+    doc.insertPages(inserted.begin(), inserted.end(), 1);
+    ASSERT_EQ(7U, doc.getPageCount());
+    expectConsistentIndices(doc);
+    EXPECT_EQ(0U, doc.indexOf(pages[0]));
+    EXPECT_EQ(2U, doc.indexOf(inserted[1]));
+    EXPECT_EQ(4U, doc.indexOf(pages[1]));
+
+    doc.deletePages(2, 4);
+    ASSERT_EQ(3U, doc.getPageCount());
+    expectConsistentIndices(doc);
+    EXPECT_EQ(npos, doc.indexOf(inserted[1]));
+    EXPECT_EQ(npos, doc.indexOf(pages[2]));
+    EXPECT_EQ(1U, doc.indexOf(inserted[0]));
+    EXPECT_EQ(2U, doc.indexOf(pages[3]));
+
+    doc.clearDocument();
+    EXPECT_EQ(npos, doc.indexOf(pages[0]));
+}
@@ -27,8 +27,7 @@ TEST(ErasableStroke, testOverlapTree) {
     // clang format on
 
     Stroke stroke;
-    std::vector<Point>& strokePoints = const_cast<std::vector<Point>&>(stroke.getPointVector());
-    strokePoints.swap(testPath);
+    stroke.setPointVector(testPath);
 
     stroke.setWidth(2);
     stroke.setFill(-1);
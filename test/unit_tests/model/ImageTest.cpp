@@ -47,6 +47,51 @@ TEST(Image, testGetImageApplyOrientation) {
     // Test image now have the correct size - which is the image has been rotated.
     EXPECT_EQ(image.getImageSize(), rotatedImageSize);
     EXPECT_EQ(image.getImageSize(), std::make_pair(130, 500));
-    EXPECT_EQ(std::make_pair(cairo_image_surface_get_width(surface), cairo_image_surface_get_height(surface)),
+    EXPECT_EQ(std::make_pair(cairo_image_surface_get_width(surface.get()),
+                             cairo_image_surface_get_height(surface.get())),
               rotatedImageSize);
 }
+
+static std::pair<int, int> getSurfaceSize(const xoj::util::CairoSurfaceSPtr& surface) {
+    return std::make_pair(cairo_image_surface_get_width(surface.get()), cairo_image_surface_get_height(surface.get()));
+}
+
+TEST(Image, testMipmapLevels) {
+    auto image = Image();
+    std::ifstream imageFile{GET_TESTFILE("images/r90.jpg"), std::ios::binary};
+    image.setImage(std::string(std::istreambuf_iterator<char>(imageFile), {}));
+
+    // The smallest level which is not smaller than the requested size, with the orientation applied
+    EXPECT_EQ(getSurfaceSize(image.getImage(60, 200)), std::make_pair(65, 250));
+    EXPECT_EQ(image.getImageSize(), std::make_pair(130, 500));
+    EXPECT_EQ(getSurfaceSize(image.getImage(60, 250)), std::make_pair(65, 250));
+    EXPECT_EQ(getSurfaceSize(image.getImage(60, 251)), std::make_pair(130, 500));
+    EXPECT_EQ(getSurfaceSize(image.getImage(1000, 1000)), std::make_pair(130, 500));
+    EXPECT_EQ(getSurfaceSize(image.getImage(0, 0)), std::make_pair(1, 1));
+}
+
+/// Sets the budget of the decoded images for the scope, then restores the previous one
+class DecodedMemoryBudget {
+public:
+    explicit DecodedMemoryBudget(size_t bytes): previous(Image::getDecodedMemoryBudget()) {
+        Image::setDecodedMemoryBudget(bytes);
+    }
+    ~DecodedMemoryBudget() { Image::setDecodedMemoryBudget(previous); }
+
+private:
+    size_t previous;
+};
+
+TEST(Image, testDecodedAgainAfterEviction) {
+    auto image = Image();
+    std::ifstream imageFile{GET_TESTFILE("images/r90.jpg"), std::ios::binary};
+    image.setImage(std::string(std::istreambuf_iterator<char>(imageFile), {}));
+
+    DecodedMemoryBudget budget(0);
+    auto full = image.getImage();
+    auto small = image.getImage(30, 100);
+    ASSERT_TRUE(full && small);
+    // The full resolution level has been evicted, but the surface handed out stays valid
+    EXPECT_EQ(getSurfaceSize(full), std::make_pair(130, 500));
+    EXPECT_EQ(getSurfaceSize(image.getImage()), std::make_pair(130, 500));
+}
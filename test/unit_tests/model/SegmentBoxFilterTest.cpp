@@ -0,0 +1,327 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/PathParameter.h"
+#include "model/Point.h"
+#include "model/Stroke.h"
+#include "model/StrokePoints.h"
+#include "model/eraser/PaddedBox.h"
+#include "model/eraser/SegmentBoxFilter.h"
+#include "util/Interval.h"
+#include "util/Rectangle.h"
+#include "util/SmallVector.h"
+#include "util/TinyVector.h"
+
+using xoj::util::Rectangle;
+
+/*
+ * The segment by segment implementations of Stroke::intersects() and Stroke::intersectWithPaddedBox(), as they were
+ * before the segments far from the box got skipped. The results must stay bit-identical.
+ */
+namespace reference {
+
+bool intersects(const Stroke& s, double x, double y, double halfEraserSize, double* gap) {
+    const auto& points = s.getPointVector();
+    if (points.empty()) {
+        return false;
+    }
+
+    double x1 = x - halfEraserSize;
+    double x2 = x + halfEraserSize;
+    double y1 = y - halfEraserSize;
+    double y2 = y + halfEraserSize;
+
+    double lastX = points[0].x;
+    double lastY = points[0].y;
+    for (auto&& point: points) {
+        double px = point.x;
+        double py = point.y;
+
+        if (px >= x1 && py >= y1 && px <= x2 && py <= y2) {
+            *gap = 0;
+            return true;
+        }
+
+        double len = hypot(px - lastX, py - lastY);
+        if (len >= halfEraserSize) {
+            double p = std::abs((x - lastX) * (lastY - py) + (y - lastY) * (px - lastX)) / len;
+            if (p <= halfEraserSize) {
+                double centerX = (lastX + px) / 2;
+                double centerY = (lastY + py) / 2;
+                double distance = hypot(x - centerX, y - centerY);
+                distance -= halfEraserSize * std::sqrt(2);
+                constexpr double PADDING = 0.1;
+                if (distance <= len / 2 + PADDING) {
+                    *gap = distance;
+                    return true;
+                }
+            }
+        }
+
+        lastX = px;
+        lastY = py;
+    }
+
+    return false;
+}
+
+std::optional<Interval<double>> intersectLineWithRectangle(const Point& p, const Point& q,
+                                                           const Rectangle<double>& rectangle) {
+    auto intersectLineWithStrip = [](double a1, double a2, double stripAMin, double stripWidth) {
+        double norm = 1.0 / (a2 - a1);
+        double t1 = (stripAMin - a1) * norm;
+        double t2 = t1 + stripWidth * norm;
+        return Interval<double>::getInterval(t1, t2);
+    };
+
+    if (p.x == q.x) {
+        if (p.y == q.y) {
+            return std::nullopt;
+        }
+        if (rectangle.x < p.x && p.x < rectangle.x + rectangle.width) {
+            return intersectLineWithStrip(p.y, q.y, rectangle.y, rectangle.height);
+        }
+        return std::nullopt;
+    }
+
+    if (p.y == q.y) {
+        if (rectangle.y < p.y && p.y < rectangle.y + rectangle.height) {
+            return intersectLineWithStrip(p.x, q.x, rectangle.x, rectangle.width);
+        }
+        return std::nullopt;
+    }
+
+    Interval<double> verticalIntersections = intersectLineWithStrip(p.y, q.y, rectangle.y, rectangle.height);
+    Interval<double> horizontalIntersections = intersectLineWithStrip(p.x, q.x, rectangle.x, rectangle.width);
+    return verticalIntersections.intersect(horizontalIntersections);
+}
+
+TinyVector<double, 2> intersectLineSegmentWithRectangle(const Point& p, const Point& q,
+                                                        const Rectangle<double>& rectangle) {
+    std::optional<Interval<double>> intersections = intersectLineWithRectangle(p, q, rectangle);
+    if (intersections) {
+        TinyVector<double, 2> result;
+        if (intersections->min > 0.0 && intersections->min <= 1.0) {
+            result.emplace_back(intersections->min);
+        }
+        if (intersections->max > 0.0 && intersections->max <= 1.0) {
+            result.emplace_back(intersections->max);
+        }
+        return result;
+    }
+    return {};
+}
+
+IntersectionParametersContainer intersectWithPaddedBox(const Stroke& s, const PaddedBox& box) {
+    const auto& points = s.getPointVector();
+    if (points.size() < 2) {
+        if (points.size() == 1 && points.back().isInside(box.getInnerRectangle())) {
+            return {{0U, 0.0}, {0U, 0.0}};
+        }
+        return {};
+    }
+    const size_t lastIndex = points.size() - 2;
+
+    const auto innerBox = box.getInnerRectangle();
+    const auto outerBox = box.getOuterRectangle();
+
+    bool isInsideOuter = false;
+    bool wentInsideInner = false;
+    bool lastSegmentEndedOnBoundary = false;
+    if (points[0].isInside(innerBox)) {
+        isInsideOuter = true;
+        wentInsideInner = true;
+    } else if (points[0].isInside(outerBox)) {
+        auto inner = intersectLineWithRectangle(points[0], points[1], innerBox);
+        isInsideOuter = true;
+        wentInsideInner = inner && inner.value().max <= 0.0;
+    }
+
+    IntersectionParametersContainer result;
+    if (isInsideOuter) {
+        result.emplace_back(0U, 0.0);
+    }
+
+    size_t index = 0;
+    for (; index <= lastIndex; index++) {
+        const Point firstKnot = points[index];
+        const Point secondKnot = points[index + 1];
+        auto outerIntersections = intersectLineSegmentWithRectangle(firstKnot, secondKnot, outerBox);
+        if (outerIntersections.empty() && !firstKnot.isInside(outerBox) && !secondKnot.isInside(outerBox)) {
+            continue;
+        }
+        auto innerIntersections = intersectLineSegmentWithRectangle(firstKnot, secondKnot, innerBox);
+        auto itInner = innerIntersections.begin();
+        auto itInnerEnd = innerIntersections.end();
+
+        if (lastSegmentEndedOnBoundary) {
+            lastSegmentEndedOnBoundary = false;
+            Point p = secondKnot;
+            if (!outerIntersections.empty()) {
+                p = firstKnot.relativeLineTo(secondKnot, 0.5 * outerIntersections.front());
+            }
+            if (p.isInside(outerBox) != (result.size() % 2 != 0)) {
+                result.pop_back();
+            }
+        }
+
+        for (auto outerIntersection: outerIntersections) {
+            while (itInner != itInnerEnd && *itInner < outerIntersection) {
+                wentInsideInner = true;
+                ++itInner;
+            }
+            if (!isInsideOuter || wentInsideInner) {
+                result.emplace_back(index, outerIntersection);
+                if (outerIntersection == 1.0) {
+                    lastSegmentEndedOnBoundary = true;
+                }
+            } else {
+                result.pop_back();
+            }
+            wentInsideInner = false;
+            isInsideOuter = !isInsideOuter;
+        }
+        if (itInner != itInnerEnd) {
+            wentInsideInner = true;
+        }
+    }
+
+    if (result.size() % 2) {
+        const Point lastPoint = points[index];
+        if (!lastPoint.isInside(outerBox)) {
+            return {};
+        }
+        auto inner = intersectLineWithRectangle(lastPoint, points[index - 1], innerBox);
+        if (wentInsideInner || (inner && inner.value().max < 0.0)) {
+            result.emplace_back(index - 1, 1.0);
+        } else {
+            result.pop_back();
+        }
+    }
+
+    for (auto it1 = result.begin(), it2 = std::next(it1), end = result.end(); it1 != end; it1 += 2, it2 += 2) {
+        Point testPoint = it1->index == it2->index ? s.getPoint(PathParameter(it1->index, 0.5 * (it1->t + it2->t))) :
+                                                     s.getPoint(static_cast<int>((it1->index + it2->index + 1) / 2));
+        if (!testPoint.isInside(outerBox)) {
+            return {};
+        }
+    }
+    return result;
+}
+
+}  // namespace reference
+
+/**
+ * Random walks, partly on a grid so that some points lie exactly on the borders of the boxes
+ */
+static Stroke makeStroke(std::mt19937& gen, size_t pointCount) {
+    std::uniform_real_distribution<double> step(-4, 4);
+    std::bernoulli_distribution onGrid(0.3);
+    Stroke s;
+    s.setWidth(1);
+    double x = 50;
+    double y = 50;
+    for (size_t i = 0; i < pointCount; i++) {
+        x += step(gen);
+        y += step(gen);
+        if (onGrid(gen)) {
+            s.addPoint(Point(std::round(x), std::round(y)));
+        } else {
+            s.addPoint(Point(x, y));
+        }
+    }
+    return s;
+}
+
+TEST(SegmentBoxFilter, testSameAsScalar) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(0, 100);
+    std::uniform_real_distribution<double> size(0, 20);
+
+    for (int n = 0; n < 100; n++) {
+        Stroke s = makeStroke(gen, 1 + static_cast<size_t>(n) * 7);
+        const auto& coords = s.getPointVector().getCoordinates();
+        if (coords.size() < 2) {
+            continue;
+        }
+        const size_t last = coords.size() - 2;
+        for (int b = 0; b < 20; b++) {
+            Rectangle<double> box(std::round(coord(gen)), coord(gen), size(gen), std::round(size(gen)));
+            for (size_t first = 0; first <= last; first += 1 + first / 2) {
+                EXPECT_EQ(SegmentBoxFilter::findSegmentNearBoxScalar(coords.data(), first, last, box),
+                          SegmentBoxFilter::findSegmentNearBox(coords.data(), first, last, box));
+            }
+            EXPECT_EQ(last + 1, SegmentBoxFilter::findSegmentNearBox(coords.data(), last + 1, last, box));
+        }
+    }
+}
+
+TEST(SegmentBoxFilter, testIntersectWithPaddedBoxUnchanged) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> coord(20, 80);
+    std::uniform_int_distribution<int> halfSize(0, 8);
+    size_t nonEmptyResults = 0;
+
+    for (int n = 0; n < 50; n++) {
+        Stroke s = makeStroke(gen, 1 + static_cast<size_t>(n) * 13);
+        for (int b = 0; b < 200; b++) {
+            double h = 0.5 * halfSize(gen) + 0.25;
+            // Every other box has integer borders, as the points on the grid
+            Point center = b % 2 ? Point(coord(gen), coord(gen)) : Point(std::round(coord(gen)) + 0.5,
+                                                                         std::round(coord(gen)) + 0.5);
+            PaddedBox box{center, h, h + 0.5 * halfSize(gen)};
+
+            auto expected = reference::intersectWithPaddedBox(s, box);
+            auto res = s.intersectWithPaddedBox(box);
+            ASSERT_EQ(expected.size(), res.size());
+            for (size_t i = 0; i < res.size(); i++) {
+                EXPECT_EQ(expected[i].index, res[i].index);
+                EXPECT_EQ(expected[i].t, res[i].t);
+            }
+            nonEmptyResults += res.empty() ? 0 : 1;
+        }
+    }
+    // Make sure the test is not trivial
+    EXPECT_GT(nonEmptyResults, 100U);
+}
+
+TEST(SegmentBoxFilter, testIntersectsUnchanged) {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> coord(20, 80);
+    std::uniform_real_distribution<double> halfSize(0, 6);
+    size_t hits = 0;
+
+    for (int n = 0; n < 50; n++) {
+        Stroke s = makeStroke(gen, 1 + static_cast<size_t>(n) * 13);
+        for (int b = 0; b < 200; b++) {
+            double x = coord(gen);
+            double y = coord(gen);
+            double h = halfSize(gen);
+
+            double expectedGap = -1;
+            double gap = -1;
+            bool expected = reference::intersects(s, x, y, h, &expectedGap);
+            EXPECT_EQ(expected, s.intersects(x, y, h, &gap));
+            EXPECT_EQ(expectedGap, gap);
+            hits += expected ? 1 : 0;
+        }
+    }
+    EXPECT_GT(hits, 100U);
+}
@@ -0,0 +1,69 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Layer.h"
+#include "model/Point.h"
+#include "model/Stroke.h"
+#include "util/Range.h"
+
+static Stroke* makeStroke(double x1, double y1, double x2, double y2) {
+    auto* s = new Stroke();
+    s->setWidth(1.0);
+    s->addPoint(Point(x1, y1));
+    s->addPoint(Point(x2, y2));
+    return s;
+}
+
+TEST(SpatialIndex, testQuery) {
+    Layer layer;
+    Stroke* a = makeStroke(10, 10, 20, 20);
+    Stroke* b = makeStroke(500, 500, 510, 510);
+    Stroke* c = makeStroke(0, 0, 2000, 2000);  // Spans many cells
+    layer.addElement(a);
+    layer.addElement(b);
+    layer.addElement(c);
+
+    EXPECT_EQ(layer.getElementsInRange(Range(0, 0, 30, 30)), (std::vector<Element*>{a, c}));
+    EXPECT_EQ(layer.getElementsInRange(Range(490, 490, 520, 520)), (std::vector<Element*>{b, c}));
+    EXPECT_EQ(layer.getElementsInRange(Range(0, 0, 3000, 3000)), (std::vector<Element*>{a, b, c}));
+    EXPECT_TRUE(layer.getElementsInRange(Range(-100, -100, -50, -50)).empty());
+}
+
+TEST(SpatialIndex, testZOrderAfterInsert) {
+    Layer layer;
+    Stroke* a = makeStroke(10, 10, 20, 20);
+    Stroke* b = makeStroke(10, 10, 20, 20);
+    Stroke* c = makeStroke(10, 10, 20, 20);
+    layer.addElement(a);
+    layer.addElement(b);
+    layer.insertElement(c, 1);
+
+    EXPECT_EQ(layer.getElementsInRange(Range(0, 0, 30, 30)), layer.getElements());
+
+    layer.removeElement(a, false);
+    EXPECT_EQ(layer.getElementsInRange(Range(0, 0, 30, 30)), (std::vector<Element*>{c, b}));
+    delete a;
+}
+
+TEST(SpatialIndex, testMovedElement) {
+    Layer layer;
+    Stroke* a = makeStroke(10, 10, 20, 20);
+    layer.addElement(a);
+    ASSERT_EQ(layer.getElementsInRange(Range(0, 0, 30, 30)).size(), 1U);
+
+    a->move(1000, 1000);
+    EXPECT_TRUE(layer.getElementsInRange(Range(0, 0, 30, 30)).empty());
+    EXPECT_EQ(layer.getElementsInRange(Range(1000, 1000, 1030, 1030)), (std::vector<Element*>{a}));
+}
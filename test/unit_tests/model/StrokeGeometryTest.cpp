@@ -0,0 +1,129 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "model/CachedPath.h"
+#include "model/Stroke.h"
+
+static Stroke makeStroke() {
+    Stroke s;
+    s.setWidth(2);
+    s.setPointVector({{0, 0, 1}, {10, 5, 2}, {20, 0, Point::NO_PRESSURE}});
+    return s;
+}
+
+TEST(StrokeGeometry, testInvalidation) {
+    std::vector<std::function<void(Stroke&)>> changes = {
+            [](Stroke& s) { s.move(1, 2); },
+            [](Stroke& s) { s.scale(0, 0, 2, 2, 0, false); },
+            [](Stroke& s) { s.rotate(0, 0, 1); },
+            [](Stroke& s) { s.setPointVector({{1, 1, 1}, {2, 2, Point::NO_PRESSURE}}); },
+            [](Stroke& s) { s.addPoint(Point(30, 30)); },
+            [](Stroke& s) { s.deletePointsFrom(1); },
+            [](Stroke& s) { s.scalePressure(2); },
+            [](Stroke& s) { s.setPressure({3, 4}); },
+            [](Stroke& s) { s.setStrokeCapStyle(StrokeCapStyle::BUTT); },
+    };
+
+    for (auto& change: changes) {
+        Stroke s = makeStroke();
+        s.setCachedGeometry(std::make_shared<const StrokeGeometry>());
+        ASSERT_NE(nullptr, s.getCachedGeometry());
+
+        change(s);
+        EXPECT_EQ(nullptr, s.getCachedGeometry());
+    }
+}
+
+TEST(StrokeGeometry, testKeptByUnrelatedChangesAndCopies) {
+    Stroke s = makeStroke();
+    auto geometry = std::make_shared<const StrokeGeometry>();
+    s.setCachedGeometry(geometry);
+
+    s.setWidth(3);
+    s.setFill(128);
+    EXPECT_EQ(geometry, s.getCachedGeometry());
+
+    std::unique_ptr<Stroke> clone(s.cloneStroke());
+    EXPECT_EQ(geometry, clone->getCachedGeometry());
+
+    clone->move(1, 1);
+    EXPECT_EQ(nullptr, clone->getCachedGeometry());
+    EXPECT_EQ(geometry, s.getCachedGeometry());
+}
+
+/**
+ * A path through the given number of points: 32 bytes of data per point
+ */
+static std::shared_ptr<const cairo_path_t> makePath(int pointCount) {
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+    cairo_t* cr = cairo_create(surface);
+    cairo_move_to(cr, 0, 0);
+    for (int i = 1; i < pointCount; i++) {
+        cairo_line_to(cr, i, i % 2);
+    }
+    cairo_path_t* path = cairo_copy_path(cr);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    return std::shared_ptr<const cairo_path_t>(
+            path, [](const cairo_path_t* p) { cairo_path_destroy(const_cast<cairo_path_t*>(p)); });
+}
+
+/// Sets the budget of the path cache for the scope, then restores the previous one
+class PathCacheBudget {
+public:
+    explicit PathCacheBudget(size_t bytes): previous(CachedPath::getMemoryBudget()) {
+        CachedPath::setMemoryBudget(bytes);
+    }
+    ~PathCacheBudget() { CachedPath::setMemoryBudget(previous); }
+
+private:
+    size_t previous;
+};
+
+TEST(StrokeGeometry, testPathCacheBoundedByMemory) {
+    // Room for 3 paths of 100 points
+    PathCacheBudget budget(10000);
+
+    std::vector<std::unique_ptr<CachedPath>> handles;
+    for (int n = 0; n < 5; n++) {
+        handles.push_back(std::make_unique<CachedPath>(makePath(100)));
+    }
+    EXPECT_EQ(nullptr, handles[0]->get());
+    EXPECT_EQ(nullptr, handles[1]->get());
+    ASSERT_NE(nullptr, handles[2]->get());
+    EXPECT_EQ(200, handles[2]->get()->num_data);
+    EXPECT_NE(nullptr, handles[3]->get());
+    EXPECT_NE(nullptr, handles[4]->get());
+
+    // handles[2] was used last: handles[3] is dropped first
+    handles.push_back(std::make_unique<CachedPath>(makePath(100)));
+    EXPECT_NE(nullptr, handles[2]->get());
+    EXPECT_EQ(nullptr, handles[3]->get());
+
+    // A dropped handle frees its room in the cache
+    handles[4].reset();
+    handles.push_back(std::make_unique<CachedPath>(makePath(100)));
+    EXPECT_NE(nullptr, handles[2]->get());
+    EXPECT_NE(nullptr, handles[5]->get());
+    EXPECT_NE(nullptr, handles[6]->get());
+
+    // A path larger than the budget is kept until the next one
+    auto large = std::make_unique<CachedPath>(makePath(1000));
+    EXPECT_NE(nullptr, large->get());
+    EXPECT_EQ(nullptr, handles[2]->get());
+}
@@ -0,0 +1,101 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "model/Stroke.h"
+#include "model/StrokePoints.h"
+
+static void expectSamePoints(const std::vector<Point>& expected, const StrokePoints& pts) {
+    ASSERT_EQ(expected.size(), pts.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i].x, pts[i].x);
+        EXPECT_EQ(expected[i].y, pts[i].y);
+        EXPECT_EQ(expected[i].z, pts[i].z);
+    }
+}
+
+TEST(StrokePoints, testNoPressureChannelWithoutPressure) {
+    StrokePoints pts;
+    pts.push_back(Point(1, 2));
+    pts.push_back(Point(3, 4));
+    EXPECT_FALSE(pts.hasPressureChannel());
+    expectSamePoints({{1, 2}, {3, 4}}, pts);
+
+    pts.setPressure(1, Point::NO_PRESSURE);
+    EXPECT_FALSE(pts.hasPressureChannel());
+
+    pts.assign({{5, 6}, {7, 8}, {9, 10}});
+    EXPECT_FALSE(pts.hasPressureChannel());
+    expectSamePoints({{5, 6}, {7, 8}, {9, 10}}, pts);
+}
+
+TEST(StrokePoints, testPressureChannel) {
+    StrokePoints pts;
+    pts.push_back(Point(1, 2));
+    pts.push_back(Point(3, 4, 0.16));
+    pts.push_back(Point(5, 6));
+    EXPECT_TRUE(pts.hasPressureChannel());
+    expectSamePoints({{1, 2}, {3, 4, 0.16}, {5, 6}}, pts);
+
+    pts.scalePressures(2);
+    expectSamePoints({{1, 2}, {3, 4, 0.32}, {5, 6}}, pts);
+
+    pts.truncate(2);
+    expectSamePoints({{1, 2}, {3, 4, 0.32}}, pts);
+
+    pts.clearPressure();
+    EXPECT_FALSE(pts.hasPressureChannel());
+    expectSamePoints({{1, 2}, {3, 4}}, pts);
+
+    pts.setPressure(0, 1.5);
+    expectSamePoints({{1, 2, 1.5}, {3, 4}}, pts);
+}
+
+TEST(StrokePoints, testIterators) {
+    const std::vector<Point> points = {{0, 0, 1}, {1, 2, 3}, {4, 5, 6}, {7, 8, Point::NO_PRESSURE}};
+    StrokePoints pts(points);
+
+    EXPECT_EQ(static_cast<std::ptrdiff_t>(points.size()), std::distance(pts.begin(), pts.end()));
+    EXPECT_EQ(7, std::prev(pts.cend())->x);
+    EXPECT_EQ(5, (pts.begin() + 2)->y);
+
+    std::vector<Point> copy;
+    std::copy(std::next(pts.cbegin()), pts.cend(), std::back_inserter(copy));
+    ASSERT_EQ(3U, copy.size());
+    EXPECT_EQ(3, copy.front().z);
+
+    StrokePoints other;
+    std::copy(pts.cbegin(), pts.cend(), std::back_inserter(other));
+    expectSamePoints(points, other);
+    expectSamePoints(points, StrokePoints(pts.toVector()));
+}
+
+TEST(StrokePoints, testStrokeKeepsPointSemantics) {
+    Stroke s;
+    s.setWidth(2);
+    s.setPointVector({{0, 0}, {10, 0}, {10, 10}});
+    EXPECT_FALSE(s.hasPressure());
+    EXPECT_FALSE(s.getPointVector().hasPressureChannel());
+
+    s.move(1, 1);
+    s.scale(0, 0, 2, 2, 0, false);
+    expectSamePoints({{2, 2}, {22, 2}, {22, 22}}, s.getPointVector());
+    EXPECT_FALSE(s.getPointVector().hasPressureChannel());
+
+    s.setPressure({1, 2});
+    EXPECT_TRUE(s.hasPressure());
+    expectSamePoints({{2, 2, 1}, {22, 2, 2}, {22, 22}}, s.getPointVector());
+}
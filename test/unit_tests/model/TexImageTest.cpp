@@ -0,0 +1,84 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <string>
+#include <utility>
+
+#include <cairo-pdf.h>
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "model/TexImage.h"
+
+/**
+ * A one page PDF of 40x20 points with a black rectangle in it, like a small formula
+ */
+static std::string createPdf() {
+    std::string pdf;
+    cairo_surface_t* surface = cairo_pdf_surface_create_for_stream(
+            +[](void* closure, const unsigned char* data, unsigned int length) {
+                static_cast<std::string*>(closure)->append(reinterpret_cast<const char*>(data), length);
+                return CAIRO_STATUS_SUCCESS;
+            },
+            &pdf, 40, 20);
+    cairo_t* cr = cairo_create(surface);
+    cairo_rectangle(cr, 5, 5, 30, 10);
+    cairo_fill(cr);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    return pdf;
+}
+
+static std::pair<int, int> getSurfaceSize(const xoj::util::CairoSurfaceSPtr& surface) {
+    return std::make_pair(cairo_image_surface_get_width(surface.get()), cairo_image_surface_get_height(surface.get()));
+}
+
+TEST(TexImage, testRasterBuckets) {
+    TexImage img;
+    ASSERT_TRUE(img.loadData(createPdf()));
+    ASSERT_NE(nullptr, img.getPdf());
+    EXPECT_DOUBLE_EQ(40, img.getElementWidth());
+    EXPECT_DOUBLE_EQ(20, img.getElementHeight());
+
+    auto raster = img.getRaster(40, 20);
+    ASSERT_NE(nullptr, raster);
+    EXPECT_EQ(std::make_pair(40, 20), getSurfaceSize(raster));
+
+    // The zoom buckets are powers of two: close sizes share the same raster
+    EXPECT_EQ(raster, img.getRaster(25, 12));
+    EXPECT_EQ(std::make_pair(20, 10), getSurfaceSize(img.getRaster(19, 5)));
+    EXPECT_EQ(std::make_pair(160, 80), getSurfaceSize(img.getRaster(130, 20)));
+
+    // The raster contains the formula
+    cairo_surface_flush(raster.get());
+    const unsigned char* data = cairo_image_surface_get_data(raster.get());
+    const int stride = cairo_image_surface_get_stride(raster.get());
+    EXPECT_EQ(0xff, data[10 * stride + 20 * 4 + 3]);
+    EXPECT_EQ(0x00, data[2 * stride + 2 * 4 + 3]);
+
+    // Huge zooms are not worth caching
+    EXPECT_EQ(nullptr, img.getRaster(40000, 20000));
+}
+
+TEST(TexImage, testRasterDroppedWithData) {
+    TexImage img;
+    ASSERT_TRUE(img.loadData(createPdf()));
+    auto raster = img.getRaster(40, 20);
+    ASSERT_NE(nullptr, raster);
+
+    ASSERT_TRUE(img.loadData(createPdf()));
+    auto newRaster = img.getRaster(40, 20);
+    ASSERT_NE(nullptr, newRaster);
+    EXPECT_NE(raster, newRaster);
+
+    TexImage png;
+    EXPECT_EQ(nullptr, png.getRaster(40, 20));
+}
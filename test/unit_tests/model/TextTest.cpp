@@ -0,0 +1,55 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <gtest/gtest.h>
+
+#include "model/Text.h"
+#include "pdf/base/XojPdfPage.h"
+
+TEST(Text, testCachedLayoutFollowsChanges) {
+    Text t;
+    t.setText("Hello");
+    const double width = t.getElementWidth();
+    EXPECT_GT(width, 0);
+
+    t.setText("Hello, world");
+    const double longerWidth = t.getElementWidth();
+    EXPECT_GT(longerWidth, width);
+
+    // The font may also be changed in place
+    t.getFont().setSize(2 * t.getFontSize());
+    t.setText("Hello, world");
+    EXPECT_GT(t.getElementWidth(), 1.5 * longerWidth);
+
+    XojFont font("Sans", 12);
+    t.setFont(font);
+    t.setText("Hello, world");
+    EXPECT_DOUBLE_EQ(longerWidth, t.getElementWidth());
+}
+
+TEST(Text, testFindText) {
+    Text t;
+    t.setX(10);
+    t.setY(20);
+    t.setText("abc ABC abc");
+
+    auto found = t.findText("abc");
+    ASSERT_EQ(3U, found.size());
+    for (auto& r: found) {
+        EXPECT_GE(r.x1, 10);
+        EXPECT_GE(r.y1, 20);
+        EXPECT_GT(r.x2, r.x1);
+        EXPECT_GT(r.y2, r.y1);
+    }
+    EXPECT_LT(found[0].x2, found[1].x1 + 1e-6);
+
+    EXPECT_TRUE(t.findText("xyz").empty());
+}
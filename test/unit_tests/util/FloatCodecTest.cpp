@@ -0,0 +1,95 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+
+#include "util/FloatCodec.h"
+#include "util/Util.h"
+
+static std::string referenceFormat(double value) {
+    char str[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_formatd(str, G_ASCII_DTOSTR_BUF_SIZE, Util::PRECISION_FORMAT_STRING, value);
+    return str;
+}
+
+static std::string fastFormat(double value) {
+    char str[Util::FORMAT_DOUBLE_BUF_SIZE];
+    size_t len = Util::formatDouble(str, value);
+    EXPECT_EQ(len, std::strlen(str));
+    return str;
+}
+
+static void checkParse(const char* str) {
+    char* endRef = nullptr;
+    char* endFast = nullptr;
+    double ref = g_ascii_strtod(str, &endRef);
+    double fast = Util::parseDouble(str, &endFast);
+    EXPECT_EQ(0, std::memcmp(&ref, &fast, sizeof(double))) << "\"" << str << "\": " << ref << " vs " << fast;
+    EXPECT_EQ(endRef, endFast) << "\"" << str << "\"";
+}
+
+TEST(UtilFloatCodec, testFormatSpecialValues) {
+    for (double v: {0.0, -0.0, 1.0, -1.0, 0.1, 0.5, 1.5, 2.5, 0.125, 100.0, 1200.0, 1e7, 1e8, 99999999.5, 9999999.95,
+                    12345678.5, 123456785.0, 0.000123456785, 1e-4, 1e-5, 9.99999999e-6, 1e15, 9.9999999e14, 1e300,
+                    5e-324, -3.25, INFINITY, -INFINITY, NAN}) {
+        EXPECT_EQ(referenceFormat(v), fastFormat(v)) << v;
+    }
+}
+
+TEST(UtilFloatCodec, testFormatRandom) {
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    for (int i = 0; i < 200000; i++) {
+        // Values spread over many magnitudes
+        double v = std::pow(10.0, unit(gen) * 40 - 20) * (unit(gen) < 0.5 ? -1 : 1);
+        EXPECT_EQ(referenceFormat(v), fastFormat(v));
+
+        // Typical coordinates
+        double c = std::round(unit(gen) * 1e6) / 1e3;
+        EXPECT_EQ(referenceFormat(c), fastFormat(c));
+
+        // Arbitrary bit patterns
+        uint64_t bits = gen();
+        double d = 0;
+        std::memcpy(&d, &bits, sizeof(d));
+        EXPECT_EQ(referenceFormat(d), fastFormat(d));
+    }
+}
+
+TEST(UtilFloatCodec, testParseSpecialValues) {
+    for (const char* s: {"0", "-0", "  12.5 3", "1e5", "1.e5", ".5", "+.5", "-.e1", "inf", "nan", "0x1p3", "1e", "1e+",
+                         "12abc", "1.5.3", "000.000", "0.0001234", "99999999999999999999", "1e400", "1e-400",
+                         "123456789012345678", "9007199254740993", "5e-324", "   ", "", "1E-3z", " \n7"}) {
+        checkParse(s);
+    }
+}
+
+TEST(UtilFloatCodec, testParseRandom) {
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    for (int i = 0; i < 200000; i++) {
+        double v = std::pow(10.0, unit(gen) * 40 - 20) * (unit(gen) < 0.5 ? -1 : 1);
+        checkParse(referenceFormat(v).c_str());
+
+        char str[64];
+        g_snprintf(str, sizeof(str), "%.17g", v);
+        checkParse(str);
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <array>
+#include <cstdint>
+
+#include <cairo.h>
+#include <gtest/gtest.h>
+
+#include "model/PageType.h"
+#include "util/Color.h"
+#include "view/background/BackgroundView.h"
+
+using namespace xoj::view;
+
+constexpr double PAGE_WIDTH = 595.0;
+constexpr double PAGE_HEIGHT = 842.0;
+constexpr double ZOOM = 1.5;
+constexpr int WIDTH = static_cast<int>(PAGE_WIDTH * ZOOM);
+constexpr int HEIGHT = static_cast<int>(PAGE_HEIGHT * ZOOM);
+
+/**
+ * Draws the background on an image surface, where it is tiled, or replays it from a recording surface, where every
+ * dot is drawn.
+ */
+static cairo_surface_t* render(const BackgroundView& view, bool tiled) {
+    cairo_surface_t* image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+    cairo_surface_t* target = tiled ? cairo_surface_reference(image) : cairo_recording_surface_create(
+                                                                               CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    cairo_t* cr = cairo_create(target);
+    cairo_scale(cr, ZOOM, ZOOM);
+    // Only part of the page is visible
+    cairo_rectangle(cr, 0, 30.5, PAGE_WIDTH, PAGE_HEIGHT - 100);
+    cairo_clip(cr);
+    view.draw(cr);
+    cairo_destroy(cr);
+
+    if (!tiled) {
+        cr = cairo_create(image);
+        cairo_set_source_surface(cr, target, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+    }
+    cairo_surface_destroy(target);
+    cairo_surface_flush(image);
+    return image;
+}
+
+/// Amount of ink (darkness of the green channel) in each quarter of the painted part of the surface
+static std::array<uint64_t, 4> getInk(cairo_surface_t* surface) {
+    std::array<uint64_t, 4> ink{};
+    const int stride = cairo_image_surface_get_stride(surface);
+    const unsigned char* data = cairo_image_surface_get_data(surface);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            auto pixel = *reinterpret_cast<const uint32_t*>(data + y * stride + 4 * x);
+            if ((pixel >> 24) == 0) {
+                continue;
+            }
+            ink[2 * (2 * y / HEIGHT) + 2 * x / WIDTH] += 255 - ((pixel >> 8) & 0xff);
+        }
+    }
+    return ink;
+}
+
+TEST(ViewBackgroundTileCache, testTiledDotsMatchDrawnDots) {
+    for (auto format: {PageTypeFormat::Dotted, PageTypeFormat::IsoDotted}) {
+        auto view = BackgroundView::createRuled(PAGE_WIDTH, PAGE_HEIGHT, Colors::white, PageType(format));
+        ASSERT_TRUE(view);
+
+        cairo_surface_t* tiled = render(*view, true);
+        cairo_surface_t* drawn = render(*view, false);
+
+        // The tiles are resampled, so only the amount of ink is compared. It would differ at the borders of the
+        // page if the dots beyond the margins were painted or missing.
+        auto tiledInk = getInk(tiled);
+        auto drawnInk = getInk(drawn);
+        for (size_t i = 0; i < tiledInk.size(); i++) {
+            EXPECT_GT(drawnInk[i], 0U);
+            EXPECT_NEAR(static_cast<double>(tiledInk[i]), static_cast<double>(drawnInk[i]), 0.05 * drawnInk[i])
+                    << "format " << static_cast<int>(format) << ", quarter " << i;
+        }
+
+        // Nothing is painted outside the clip
+        const unsigned char* data = cairo_image_surface_get_data(tiled);
+        EXPECT_EQ(0U, *reinterpret_cast<const uint32_t*>(data));
+
+        cairo_surface_destroy(tiled);
+        cairo_surface_destroy(drawn);
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include <cairo.h>
+#include <config-test.h>
+#include <gtest/gtest.h>
+
+#include "control/xojfile/LoadHandler.h"
+#include "model/Document.h"
+#include "model/Layer.h"
+#include "model/LineStyle.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "view/StrokeViewHelper.h"
+
+using namespace xoj::view;
+
+/**
+ * The pressure strokes of the test files
+ */
+static std::vector<std::vector<Point>> loadPressureStrokes() {
+    LoadHandler handler;
+    Document* doc = handler.loadDocument(GET_TESTFILE("packaged_xopp/suite.xopp"));
+    EXPECT_NE(nullptr, doc);
+
+    std::vector<std::vector<Point>> strokes;
+    if (doc == nullptr) {
+        return strokes;
+    }
+    for (size_t i = 0; i < doc->getPageCount(); i++) {
+        for (Layer* layer: *doc->getPage(i)->getLayers()) {
+            for (Element* e: layer->getElements()) {
+                if (auto* s = dynamic_cast<Stroke*>(e); s && s->hasPressure()) {
+                    strokes.emplace_back(s->getPointVector().toVector());
+                }
+            }
+        }
+    }
+    EXPECT_FALSE(strokes.empty());
+    return strokes;
+}
+
+static cairo_surface_t* createSurface(cairo_line_cap_t cap, const std::function<void(cairo_t*)>& draw) {
+    // The test strokes are on an A4 page
+    constexpr double ZOOM = 4.0;
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_A8, static_cast<int>(ZOOM * 600),
+                                                          static_cast<int>(ZOOM * 850));
+    cairo_t* cr = cairo_create(surface);
+    cairo_scale(cr, ZOOM, ZOOM);
+    cairo_set_line_cap(cr, cap);
+    cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+    draw(cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+    return surface;
+}
+
+TEST(ViewStrokeViewHelper, testFillPressureOutlineCoversSameArea) {
+    auto strokes = loadPressureStrokes();
+    LineStyle solid;
+
+    // Square caps are left out: cairo_stroke() draws them at every point, beyond the round joins of the outline
+    for (cairo_line_cap_t cap: {CAIRO_LINE_CAP_ROUND, CAIRO_LINE_CAP_BUTT}) {
+        cairo_surface_t* filled = createSurface(cap, [&](cairo_t* cr) {
+            for (auto& pts: strokes) { StrokeViewHelper::fillPressureOutline(cr, pts); }
+        });
+        cairo_surface_t* stroked = createSurface(cap, [&](cairo_t* cr) {
+            for (auto& pts: strokes) { StrokeViewHelper::strokeSegmentsWithPressure(cr, pts, solid); }
+        });
+
+        const int stride = cairo_image_surface_get_stride(filled);
+        const unsigned char* f = cairo_image_surface_get_data(filled);
+        const unsigned char* s = cairo_image_surface_get_data(stroked);
+
+        // The areas only differ by antialiasing and round joins (which cairo_stroke() does not draw between segments)
+        size_t painted = 0;
+        size_t fullyStrokedNotFilled = 0;
+        for (int y = 0; y < cairo_image_surface_get_height(filled); y++) {
+            for (int x = 0; x < cairo_image_surface_get_width(filled); x++) {
+                unsigned char a = f[y * stride + x];
+                unsigned char b = s[y * stride + x];
+                painted += b != 0;
+                fullyStrokedNotFilled += b == 255 && a == 0;
+            }
+        }
+        EXPECT_GT(painted, 0U);
+        EXPECT_EQ(0U, fullyStrokedNotFilled) << "cap style " << cap;
+
+        cairo_surface_destroy(filled);
+        cairo_surface_destroy(stroked);
+    }
+}
+
+/**
+ * Compares the time taken by both ways of drawing pressure strokes. Only reports the timings, as test properties.
+ *
+ * Disabled by default, run with
+ *      test-units --gtest_also_run_disabled_tests --gtest_filter='ViewStrokeViewHelper.DISABLED_benchmark*'
+ */
+TEST(ViewStrokeViewHelper, DISABLED_benchmarkPressureStrokes) {
+    auto strokes = loadPressureStrokes();
+    LineStyle solid;
+    constexpr int ITERATIONS = 200;
+
+    auto measure = [&](const std::function<void(cairo_t*, const std::vector<Point>&)>& draw) {
+        auto start = std::chrono::steady_clock::now();
+        cairo_surface_t* surface = createSurface(CAIRO_LINE_CAP_ROUND, [&](cairo_t* cr) {
+            for (int i = 0; i < ITERATIONS; i++) {
+                for (auto& pts: strokes) { draw(cr, pts); }
+            }
+        });
+        cairo_surface_destroy(surface);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    double segmentsTime = measure([&](cairo_t* cr, const std::vector<Point>& pts) {
+        StrokeViewHelper::strokeSegmentsWithPressure(cr, pts, solid);
+    });
+    double outlineTime =
+            measure([](cairo_t* cr, const std::vector<Point>& pts) { StrokeViewHelper::fillPressureOutline(cr, pts); });
+
+    RecordProperty("segmentsMs", static_cast<int>(std::round(segmentsTime)));
+    RecordProperty("outlineMs", static_cast<int>(std::round(outlineTime)));
+}